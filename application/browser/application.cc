@@ -10,6 +10,7 @@
 #include "base/json/json_reader.h"
 #include "base/macros.h"
 #include "base/message_loop/message_loop.h"
+#include "base/metrics/histogram.h"
 #include "base/stl_util.h"
 #include "base/strings/string_split.h"
 #include "base/threading/thread_restrictions.h"
@@ -93,6 +94,7 @@ Application::Application(
       security_mode_enabled_(false),
       browser_context_(browser_context),
       observer_(NULL),
+      launched_in_spare_renderer_(false),
       remote_debugging_enabled_(false),
       weak_factory_(this) {
   DCHECK(browser_context_);
@@ -220,14 +222,25 @@ bool Application::Launch(const LaunchParams& launch_params) {
   if (!url.is_valid())
     return false;
 
+  launch_time_ = base::TimeTicks::Now();
   remote_debugging_enabled_ = launch_params.remote_debugging;
-  auto site = content::SiteInstance::CreateForURL(browser_context_, url);
-  Runtime* runtime = Runtime::Create(browser_context_, site);
+  Runtime* runtime = NULL;
+  if (!runtime_provider_.is_null())
+    runtime = runtime_provider_.Run(url).release();
+  launched_in_spare_renderer_ = runtime != NULL;
+  if (!runtime) {
+    auto site = content::SiteInstance::CreateForURL(browser_context_, url);
+    runtime = Runtime::Create(browser_context_, site);
+  }
   runtime->set_observer(this);
   runtime->set_remote_debugging_enabled(remote_debugging_enabled_);
   runtimes_.push_back(runtime);
   render_process_host_ = runtime->GetRenderProcessHost();
   render_process_host_->AddObserver(this);
+  if (launched_in_spare_renderer_) {
+    XWalkRunner::GetInstance()->OnSpareRenderProcessClaimed(
+        render_process_host_);
+  }
   web_contents_ = runtime->web_contents();
   InitSecurityPolicy();
   runtime->LoadURL(url);
@@ -313,6 +326,17 @@ void Application::NotifyTermination() {
 void Application::RenderChannelCreated() {
   CHECK(!runtimes_.empty());
   runtimes_.front()->Show();
+
+  if (launch_time_.is_null())
+    return;
+  base::TimeDelta launch_duration = base::TimeTicks::Now() - launch_time_;
+  if (launched_in_spare_renderer_)
+    UMA_HISTOGRAM_TIMES("XWalk.Application.LaunchTime.SpareRenderer",
+                        launch_duration);
+  else
+    UMA_HISTOGRAM_TIMES("XWalk.Application.LaunchTime.NewRenderer",
+                        launch_duration);
+  launch_time_ = base::TimeTicks();
 }
 
 bool Application::UseExtension(const std::string& extension_name) const {
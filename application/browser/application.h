@@ -17,6 +17,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_vector.h"
 #include "base/observer_list.h"
+#include "base/time/time.h"
 #include "content/public/browser/render_process_host_observer.h"
 #include "ui/base/ui_base_types.h"
 #include "xwalk/application/browser/application_security_policy.h"
@@ -114,6 +115,13 @@ class Application : public Runtime::Observer,
 
   void set_observer(Observer* observer) { observer_ = observer; }
 
+  // Provides an already initialized Runtime able to load the given URL, or
+  // NULL if there is none.
+  typedef base::Callback<scoped_ptr<Runtime>(const GURL&)> RuntimeProvider;
+  void set_runtime_provider(const RuntimeProvider& provider) {
+    runtime_provider_ = provider;
+  }
+
   base::WeakPtr<Application> GetWeakPtr() {
     return weak_factory_.GetWeakPtr();
   }
@@ -171,6 +179,11 @@ class Application : public Runtime::Observer,
   void RenderChannelCreated();
 
   Observer* observer_;
+  RuntimeProvider runtime_provider_;
+
+  // Used to record the time it takes to show the application.
+  base::TimeTicks launch_time_;
+  bool launched_in_spare_renderer_;
 
   std::map<std::string, std::string> name_perm_map_;
   // Application's session permissions.
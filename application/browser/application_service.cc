@@ -13,19 +13,26 @@
 #include <string>
 #include <vector>
 
+#include "base/command_line.h"
 #include "base/files/file_util.h"
+#include "base/metrics/histogram.h"
 #include "base/strings/utf_string_conversions.h"
 #include "content/public/browser/browser_thread.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/site_instance.h"
+#include "content/public/browser/storage_partition.h"
 #include "content/public/browser/web_contents.h"
 #include "content/public/browser/web_contents_observer.h"
 #include "xwalk/application/browser/application.h"
 #include "xwalk/application/common/application_manifest_constants.h"
 #include "xwalk/application/common/application_file_util.h"
 #include "xwalk/application/common/id_util.h"
+#include "xwalk/extensions/common/xwalk_extension_switches.h"
 #include "xwalk/runtime/browser/runtime.h"
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
 #include "xwalk/runtime/browser/xwalk_runner.h"
 #include "xwalk/runtime/common/xwalk_paths.h"
+#include "xwalk/runtime/common/xwalk_switches.h"
 
 #if defined(OS_TIZEN)
 #include "xwalk/application/browser/application_service_tizen.h"
@@ -35,8 +42,21 @@ namespace xwalk {
 
 namespace application {
 
+namespace {
+
+// Delay before provisioning a new spare renderer, so that starting it does
+// not compete with the application which has just been launched.
+const int kSpareRendererProvisioningDelayMs = 3000;
+
+}  // namespace
+
 ApplicationService::ApplicationService(XWalkBrowserContext* browser_context)
-  : browser_context_(browser_context) {
+  : browser_context_(browser_context),
+    spare_render_process_host_(NULL),
+    spare_provisioning_scheduled_(false),
+    weak_factory_(this) {
+  if (IsSpareRendererEnabled())
+    ScheduleSpareRendererProvisioning();
 }
 
 scoped_ptr<ApplicationService> ApplicationService::Create(
@@ -50,6 +70,7 @@ scoped_ptr<ApplicationService> ApplicationService::Create(
 }
 
 ApplicationService::~ApplicationService() {
+  DiscardSpareRenderer();
 }
 
 Application* ApplicationService::Launch(
@@ -68,6 +89,12 @@ Application* ApplicationService::Launch(
   ScopedVector<Application>::iterator app_iter =
       applications_.insert(applications_.end(), application);
 
+  if (IsSpareRendererEnabled()) {
+    application->set_runtime_provider(
+        base::Bind(&ApplicationService::ClaimSpareRuntime,
+                   base::Unretained(this)));
+  }
+
   if (!application->Launch(launch_params)) {
     applications_.erase(app_iter);
     return NULL;
@@ -199,6 +226,11 @@ struct ApplicationIDComparator {
 
 }  // namespace
 
+bool ApplicationService::IsSpareRenderProcess(int render_process_id) const {
+  return spare_render_process_host_ &&
+      spare_render_process_host_->GetID() == render_process_id;
+}
+
 Application* ApplicationService::GetApplicationByRenderHostID(int id) const {
   ApplicationRenderHostIDComparator comparator(id);
   ScopedVector<Application>::const_iterator found = std::find_if(
@@ -235,6 +267,7 @@ void ApplicationService::OnApplicationTerminated(
                     WillDestroyApplication(application));
   scoped_refptr<ApplicationData> app_data = application->data();
   applications_.erase(found);
+  browser_context_->ReleaseNetworkResourcesById(app_data->ID());
 
   if (app_data->source_type() == ApplicationData::TEMP_DIRECTORY) {
       LOG(INFO) << "Deleting the app temporary directory "
@@ -258,6 +291,92 @@ void ApplicationService::OnApplicationTerminated(
   }
 }
 
+void ApplicationService::RenderProcessExited(
+    content::RenderProcessHost* host,
+    base::TerminationStatus status,
+    int exit_code) {
+  DCHECK_EQ(spare_render_process_host_, host);
+  LOG(WARNING) << "Spare render process exited with code " << exit_code;
+  // Do not delete the Runtime from within the notification.
+  base::MessageLoop::current()->PostTask(FROM_HERE,
+      base::Bind(&ApplicationService::DiscardSpareRenderer,
+                 weak_factory_.GetWeakPtr()));
+  ScheduleSpareRendererProvisioning();
+}
+
+void ApplicationService::RenderProcessHostDestroyed(
+    content::RenderProcessHost* host) {
+  DCHECK_EQ(spare_render_process_host_, host);
+  spare_render_process_host_ = NULL;
+}
+
+bool ApplicationService::IsSpareRendererEnabled() const {
+  const CommandLine& cmd_line = *CommandLine::ForCurrentProcess();
+  // The render process has to be told which application it hosts before
+  // its external extensions are loaded, which can only be deferred when they
+  // live in the extension process.
+  return XWalkRunner::GetInstance()->shared_process_mode_enabled() &&
+      cmd_line.HasSwitch(switches::kXWalkEnableSpareRenderer) &&
+      !cmd_line.HasSwitch(switches::kXWalkDisableExtensionProcess);
+}
+
+void ApplicationService::ScheduleSpareRendererProvisioning() {
+  if (spare_provisioning_scheduled_)
+    return;
+  spare_provisioning_scheduled_ = true;
+  base::MessageLoop::current()->PostDelayedTask(FROM_HERE,
+      base::Bind(&ApplicationService::ProvisionSpareRenderer,
+                 weak_factory_.GetWeakPtr()),
+      base::TimeDelta::FromMilliseconds(kSpareRendererProvisioningDelayMs));
+}
+
+void ApplicationService::ProvisionSpareRenderer() {
+  spare_provisioning_scheduled_ = false;
+  if (spare_runtime_)
+    return;
+
+  // The site of this SiteInstance is only assigned on its first navigation,
+  // so the spare can load any URL that maps to its storage partition.
+  spare_runtime_.reset(Runtime::Create(
+      browser_context_, content::SiteInstance::Create(browser_context_)));
+  spare_render_process_host_ = spare_runtime_->GetRenderProcessHost();
+  spare_render_process_host_->AddObserver(this);
+
+  // This launches the render process and binds the extensions to it, see
+  // XWalkRunner::OnRenderProcessWillLaunch().
+  if (!spare_render_process_host_->Init()) {
+    LOG(ERROR) << "Failed to launch the spare render process.";
+    DiscardSpareRenderer();
+  }
+}
+
+void ApplicationService::DiscardSpareRenderer() {
+  if (spare_render_process_host_)
+    spare_render_process_host_->RemoveObserver(this);
+  spare_render_process_host_ = NULL;
+  spare_runtime_.reset();
+}
+
+scoped_ptr<Runtime> ApplicationService::ClaimSpareRuntime(const GURL& url) {
+  bool claimed = false;
+  if (spare_runtime_ && spare_render_process_host_) {
+    const GURL site =
+        content::SiteInstance::GetSiteForURL(browser_context_, url);
+    content::StoragePartition* partition =
+        content::BrowserContext::GetStoragePartitionForSite(
+            browser_context_, site);
+    claimed = partition == spare_render_process_host_->GetStoragePartition();
+  }
+  UMA_HISTOGRAM_BOOLEAN("XWalk.Application.SpareRendererClaimed", claimed);
+  if (!claimed)
+    return scoped_ptr<Runtime>();
+
+  spare_render_process_host_->RemoveObserver(this);
+  spare_render_process_host_ = NULL;
+  ScheduleSpareRendererProvisioning();
+  return spare_runtime_.Pass();
+}
+
 void ApplicationService::CheckAPIAccessControl(const std::string& app_id,
     const std::string& extension_name,
     const std::string& api_name, const PermissionCallback& callback) {
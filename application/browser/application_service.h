@@ -10,7 +10,9 @@
 #include "base/files/file_path.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
+#include "base/memory/weak_ptr.h"
 #include "base/observer_list.h"
+#include "content/public/browser/render_process_host_observer.h"
 #include "xwalk/application/browser/application.h"
 #include "xwalk/application/common/permission_policy_manager.h"
 #include "xwalk/application/common/application_data.h"
@@ -22,7 +24,14 @@ class XWalkBrowserContext;
 namespace application {
 
 // The application service manages launch and termination of the applications.
-class ApplicationService : public Application::Observer {
+//
+// In shared process mode it can also keep a "spare" Runtime whose render
+// process is already launched and bound to the extension system, so that a
+// launch does not have to wait for a new render process. The spare is claimed
+// by the next application which can be hosted in it and then re-provisioned
+// in the background.
+class ApplicationService : public Application::Observer,
+                           public content::RenderProcessHostObserver {
  public:
   // Client code may use this class (and register with AddObserver below) to
   // keep track of applications life cycle.
@@ -58,6 +67,10 @@ class ApplicationService : public Application::Observer {
       const GURL& url,
       const Application::LaunchParams& params = Application::LaunchParams());
 
+  // Whether |render_process_id| is the process of the spare Runtime, which
+  // is not claimed by any application yet.
+  bool IsSpareRenderProcess(int render_process_id) const;
+
   Application* GetApplicationByRenderHostID(int id) const;
   Application* GetApplicationByID(const std::string& app_id) const;
 
@@ -90,10 +103,31 @@ class ApplicationService : public Application::Observer {
   // Implementation of Application::Observer.
   void OnApplicationTerminated(Application* app) override;
 
+  // Implementation of content::RenderProcessHostObserver.
+  void RenderProcessExited(content::RenderProcessHost* host,
+                           base::TerminationStatus status,
+                           int exit_code) override;
+  void RenderProcessHostDestroyed(content::RenderProcessHost* host) override;
+
+  bool IsSpareRendererEnabled() const;
+  void ScheduleSpareRendererProvisioning();
+  void ProvisionSpareRenderer();
+  void DiscardSpareRenderer();
+
+  // Hands over the spare Runtime if its render process can load |url|,
+  // returns NULL otherwise.
+  scoped_ptr<Runtime> ClaimSpareRuntime(const GURL& url);
+
   XWalkBrowserContext* browser_context_;
   ScopedVector<Application> applications_;
   ObserverList<Observer> observers_;
 
+  scoped_ptr<Runtime> spare_runtime_;
+  content::RenderProcessHost* spare_render_process_host_;
+  bool spare_provisioning_scheduled_;
+
+  base::WeakPtrFactory<ApplicationService> weak_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(ApplicationService);
 };
 
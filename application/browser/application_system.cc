@@ -7,16 +7,21 @@
 #include <string>
 #include "base/command_line.h"
 #include "base/files/file_util.h"
+#include "base/path_service.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_process_host.h"
 #include "content/public/common/content_switches.h"
 #include "net/base/filename_util.h"
 #include "xwalk/application/browser/application.h"
 #include "xwalk/application/browser/application_service.h"
+#include "xwalk/application/common/application_file_util.h"
 #include "xwalk/application/common/application_manifest_constants.h"
 #include "xwalk/application/common/id_util.h"
+#include "xwalk/application/common/manifest_cache.h"
 #include "xwalk/application/extension/application_runtime_extension.h"
 #include "xwalk/application/extension/application_widget_extension.h"
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/runtime/common/xwalk_paths.h"
 #include "xwalk/runtime/common/xwalk_switches.h"
 
 #if defined(OS_LINUX)
@@ -30,12 +35,37 @@
 namespace xwalk {
 namespace application {
 
+namespace {
+
+const base::FilePath::CharType kManifestCacheDirName[] =
+    FILE_PATH_LITERAL("Manifest Cache");
+
+scoped_ptr<ManifestCache> CreateManifestCache() {
+  base::FilePath data_path;
+  if (!PathService::Get(xwalk::DIR_DATA_PATH, &data_path))
+    return scoped_ptr<ManifestCache>();
+  // The entries are written atomically, so a write interrupted by shutdown
+  // leaves no broken entry.
+  base::SequencedWorkerPool* pool = content::BrowserThread::GetBlockingPool();
+  return make_scoped_ptr(new ManifestCache(
+      data_path.Append(kManifestCacheDirName),
+      pool->GetSequencedTaskRunnerWithShutdownBehavior(
+          pool->GetSequenceToken(),
+          base::SequencedWorkerPool::SKIP_ON_SHUTDOWN)));
+}
+
+}  // namespace
+
 ApplicationSystem::ApplicationSystem(XWalkBrowserContext* browser_context)
   : browser_context_(browser_context),
+    manifest_cache_(CreateManifestCache()),
     application_service_(ApplicationService::Create(
-        browser_context)) {}
+        browser_context)) {
+  SetManifestCache(manifest_cache_.get());
+}
 
 ApplicationSystem::~ApplicationSystem() {
+  SetManifestCache(NULL);
 }
 
 // static
@@ -120,13 +150,17 @@ bool ApplicationSystem::LaunchFromCommandLine(
 void ApplicationSystem::CreateExtensions(
     content::RenderProcessHost* host,
     extensions::XWalkExtensionVector* extensions) {
+  const int render_process_id = host->GetID();
   Application* application =
-    application_service_->GetApplicationByRenderHostID(host->GetID());
-  if (!application)
+    application_service_->GetApplicationByRenderHostID(render_process_id);
+  if (!application &&
+      !application_service_->IsSpareRenderProcess(render_process_id))
     return;  // We might be in browser mode.
 
-  extensions->push_back(new ApplicationRuntimeExtension(application));
-  extensions->push_back(new ApplicationWidgetExtension(application));
+  extensions->push_back(new ApplicationRuntimeExtension(
+      application_service_.get(), render_process_id));
+  extensions->push_back(new ApplicationWidgetExtension(
+      application_service_.get(), render_process_id));
 }
 
 }  // namespace application
@@ -29,6 +29,7 @@ namespace xwalk {
 namespace application {
 
 class ApplicationService;
+class ManifestCache;
 
 // The ApplicationSystem manages the creation and destruction of services which
 // related to applications' runtime model.
@@ -73,6 +74,7 @@ class ApplicationSystem {
  private:
   // Note: initialization order matters.
   XWalkBrowserContext* browser_context_;
+  scoped_ptr<ManifestCache> manifest_cache_;
   scoped_ptr<ApplicationService> application_service_;
 
   DISALLOW_COPY_AND_ASSIGN(ApplicationSystem);
@@ -18,6 +18,7 @@
 #include "content/public/browser/screen_orientation_provider.h"
 
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/runtime/browser/runtime_request_scheduler.h"
 #include "xwalk/runtime/browser/runtime_url_request_context_getter.h"
 #include "xwalk/runtime/browser/ui/native_app_window.h"
 #include "xwalk/runtime/browser/ui/native_app_window_tizen.h"
@@ -160,6 +161,10 @@ ApplicationTizen::~ApplicationTizen() {
 #if defined(USE_OZONE)
   ui::PlatformEventSource::GetInstance()->RemovePlatformEventObserver(this);
 #endif
+  // Forgets the state, so the requests of the application are not limited
+  // if it is launched again.
+  RuntimeRequestScheduler::SetApplicationState(
+      id(), RuntimeRequestScheduler::APPLICATION_FOREGROUND);
 }
 
 void ApplicationTizen::Hide() {
@@ -168,6 +173,10 @@ void ApplicationTizen::Hide() {
     if ((*it)->window())
       (*it)->window()->Minimize();
   }
+  if (!is_suspended_) {
+    RuntimeRequestScheduler::SetApplicationState(
+        id(), RuntimeRequestScheduler::APPLICATION_BACKGROUND);
+  }
 }
 
 void ApplicationTizen::Show() {
@@ -176,6 +185,8 @@ void ApplicationTizen::Show() {
     if (auto window = runtime->window())
       window->Restore();
   }
+  RuntimeRequestScheduler::SetApplicationState(
+      id(), RuntimeRequestScheduler::APPLICATION_FOREGROUND);
 }
 
 bool ApplicationTizen::Launch(const LaunchParams& launch_params) {
@@ -245,6 +256,8 @@ void ApplicationTizen::Suspend() {
       (*it)->web_contents()->WasHidden();
   }
   is_suspended_ = true;
+  RuntimeRequestScheduler::SetApplicationState(
+      id(), RuntimeRequestScheduler::APPLICATION_SUSPENDED);
 }
 
 void ApplicationTizen::Resume() {
@@ -260,6 +273,9 @@ void ApplicationTizen::Resume() {
       (*it)->web_contents()->WasShown();
   }
   is_suspended_ = false;
+  // Still in the background until shown.
+  RuntimeRequestScheduler::SetApplicationState(
+      id(), RuntimeRequestScheduler::APPLICATION_BACKGROUND);
 }
 
 #if defined(USE_OZONE)
@@ -8,12 +8,16 @@
 #include <string>
 #include "base/values.h"
 #include "base/bind.h"
+#include "base/json/json_writer.h"
 #include "content/public/browser/browser_thread.h"
 #include "dbus/bus.h"
 #include "dbus/message.h"
 #include "dbus/exported_object.h"
 #include "xwalk/application/browser/application_tizen.h"
 #include "xwalk/application/browser/linux/running_applications_manager.h"
+#include "xwalk/runtime/browser/runtime_url_request_context_getter.h"
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/runtime/browser/xwalk_runner.h"
 
 namespace {
 
@@ -26,6 +30,11 @@ namespace {
 //     Will terminate the running application. This object will be unregistered
 //     from D-Bus.
 //
+//   GetNetworkStats() -> string
+//     Returns the statistics of the network requests of the application as a
+//     JSON object: request counts, bytes read, cache hit ratio, error rate
+//     and latency histograms.
+//
 // Properties:
 //
 //   readonly string AppID
@@ -35,6 +44,18 @@ const char kRunningApplicationDBusInterface[] =
 const char kRunningApplicationDBusError[] =
     "org.crosswalkproject.Running.Application.Error";
 
+void SendNetworkStats(dbus::MethodCall* method_call,
+                      dbus::ExportedObject::ResponseSender response_sender,
+                      scoped_ptr<base::DictionaryValue> stats) {
+  std::string json;
+  base::JSONWriter::Write(stats.get(), &json);
+
+  scoped_ptr<dbus::Response> response =
+      dbus::Response::FromMethodCall(method_call);
+  dbus::MessageWriter writer(response.get());
+  writer.AppendString(json);
+  response_sender.Run(response.Pass());
+}
 
 }  // namespace
 
@@ -75,6 +96,13 @@ RunningApplicationObject::RunningApplicationObject(
       base::Bind(&RunningApplicationObject::OnExported,
                  base::Unretained(this)));
 
+  dbus_object()->ExportMethod(
+      kRunningApplicationDBusInterface, "GetNetworkStats",
+      base::Bind(&RunningApplicationObject::OnGetNetworkStats,
+                 base::Unretained(this)),
+      base::Bind(&RunningApplicationObject::OnExported,
+                 base::Unretained(this)));
+
 #if defined(OS_TIZEN)
   dbus_object()->ExportMethod(
       kRunningApplicationDBusInterface, "Hide",
@@ -163,6 +191,26 @@ void RunningApplicationObject::OnGetExtensionProcessChannel(
                  response_sender));
 }
 
+void RunningApplicationObject::OnGetNetworkStats(
+    dbus::MethodCall* method_call,
+    dbus::ExportedObject::ResponseSender response_sender) {
+  // Only applications with their own storage partition have statistics,
+  // hosted ones share the default network context.
+  RuntimeURLRequestContextGetter* getter = XWalkRunner::GetInstance()->
+      browser_context()->GetURLRequestContextGetterById(application_->id());
+  if (!getter) {
+    scoped_ptr<dbus::ErrorResponse> error_response =
+        dbus::ErrorResponse::FromMethodCall(method_call,
+                                            kRunningApplicationDBusError,
+                                            "No network statistics");
+    response_sender.Run(error_response.Pass());
+    return;
+  }
+
+  getter->GetNetworkStats(
+      base::Bind(&SendNetworkStats, method_call, response_sender));
+}
+
 #if defined(OS_TIZEN)
 void RunningApplicationObject::OnHide(
     dbus::MethodCall* method_call,
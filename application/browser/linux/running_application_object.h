@@ -51,6 +51,9 @@ class RunningApplicationObject : public dbus::ManagedObject {
       dbus::MethodCall* method_call,
       dbus::ExportedObject::ResponseSender response_sender);
 
+  void OnGetNetworkStats(dbus::MethodCall* method_call,
+                         dbus::ExportedObject::ResponseSender response_sender);
+
 #if defined(OS_TIZEN)
   void OnHide(dbus::MethodCall* method_call,
               dbus::ExportedObject::ResponseSender response_sender);
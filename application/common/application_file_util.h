@@ -35,6 +35,14 @@ class FileDeleter {
   bool recursive_;
 };
 
+class ManifestCache;
+
+// Makes LoadManifest() reuse the manifests kept in |cache|, and store the
+// ones it has to parse there, except for the applications loaded from a
+// temporary directory. |cache| must outlive the calls to LoadManifest(), NULL
+// disables caching.
+void SetManifestCache(ManifestCache* cache);
+
 // Loads an application manifest from the specified directory. Returns NULL
 // on failure, with a description of the error in |error|.
 scoped_ptr<Manifest> LoadManifest(
@@ -76,6 +76,19 @@ Manifest::Manifest(scoped_ptr<base::DictionaryValue> value, Type type)
   SetSystemLocale(GetSystemLocale());
 }
 
+Manifest::Manifest(scoped_ptr<base::DictionaryValue> value,
+                   scoped_ptr<base::DictionaryValue> i18n_value,
+                   Type type)
+    : data_(value.Pass()),
+      i18n_data_(i18n_value.Pass()),
+      type_(type) {
+  data_->GetString(application_widget_keys::kDefaultLocaleKey,
+                   &default_locale_);
+  default_locale_ = base::StringToLowerASCII(default_locale_);
+
+  SetSystemLocale(GetSystemLocale());
+}
+
 Manifest::~Manifest() {
 }
 
@@ -29,6 +29,11 @@ class Manifest {
 
   explicit Manifest(
       scoped_ptr<base::DictionaryValue> value, Type type = TYPE_MANIFEST);
+  // Creates a manifest from the dictionaries previously returned by value()
+  // and i18n_value(), without parsing the localized elements again.
+  Manifest(scoped_ptr<base::DictionaryValue> value,
+           scoped_ptr<base::DictionaryValue> i18n_value,
+           Type type);
   ~Manifest();
 
   // Returns false and |error| will be non-empty if the manifest is malformed.
@@ -74,6 +79,9 @@ class Manifest {
   // Note: only use this when you KNOW you don't need the validation.
   const base::DictionaryValue* value() const { return data_.get(); }
 
+  // Gets the localized elements of a widget manifest, indexed by locale.
+  const base::DictionaryValue* i18n_value() const { return i18n_data_.get(); }
+
   const std::string& default_locale() const {
     return default_locale_;
   }
@@ -0,0 +1,289 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/application/common/manifest_cache.h"
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/sequenced_task_runner.h"
+#include "base/sha1.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+
+namespace xwalk {
+namespace application {
+
+namespace {
+
+const uint32 kMagic = 0x584d4331;  // "XMC1"
+
+// Must be incremented whenever the layout of an entry changes.
+const int kFormatVersion = 2;
+
+// Must be incremented whenever manifests are parsed differently, e.g. when
+// the JSON or widget XML parsers change the dictionaries they build, so the
+// entries written by the previous parser are not used.
+const int kParserVersion = 2;
+
+// Manifests are shallow, anything deeper than this is a corrupted entry.
+const int kMaxDepth = 64;
+
+enum ValueTag {
+  TAG_NULL,
+  TAG_BOOLEAN,
+  TAG_INTEGER,
+  TAG_DOUBLE,
+  TAG_STRING,
+  TAG_DICTIONARY,
+  TAG_LIST
+};
+
+bool WriteValue(const base::Value& value, Pickle* pickle) {
+  switch (value.GetType()) {
+    case base::Value::TYPE_NULL:
+      return pickle->WriteInt(TAG_NULL);
+    case base::Value::TYPE_BOOLEAN: {
+      bool boolean = false;
+      value.GetAsBoolean(&boolean);
+      return pickle->WriteInt(TAG_BOOLEAN) && pickle->WriteBool(boolean);
+    }
+    case base::Value::TYPE_INTEGER: {
+      int integer = 0;
+      value.GetAsInteger(&integer);
+      return pickle->WriteInt(TAG_INTEGER) && pickle->WriteInt(integer);
+    }
+    case base::Value::TYPE_DOUBLE: {
+      double number = 0;
+      value.GetAsDouble(&number);
+      return pickle->WriteInt(TAG_DOUBLE) && pickle->WriteDouble(number);
+    }
+    case base::Value::TYPE_STRING: {
+      std::string string;
+      value.GetAsString(&string);
+      return pickle->WriteInt(TAG_STRING) && pickle->WriteString(string);
+    }
+    case base::Value::TYPE_DICTIONARY: {
+      const base::DictionaryValue* dict = NULL;
+      value.GetAsDictionary(&dict);
+      if (!pickle->WriteInt(TAG_DICTIONARY) ||
+          !pickle->WriteInt(static_cast<int>(dict->size())))
+        return false;
+      for (base::DictionaryValue::Iterator it(*dict);
+           !it.IsAtEnd(); it.Advance()) {
+        if (!pickle->WriteString(it.key()) ||
+            !WriteValue(it.value(), pickle))
+          return false;
+      }
+      return true;
+    }
+    case base::Value::TYPE_LIST: {
+      const base::ListValue* list = NULL;
+      value.GetAsList(&list);
+      if (!pickle->WriteInt(TAG_LIST) ||
+          !pickle->WriteInt(static_cast<int>(list->GetSize())))
+        return false;
+      for (base::ListValue::const_iterator it = list->begin();
+           it != list->end(); ++it) {
+        if (!WriteValue(**it, pickle))
+          return false;
+      }
+      return true;
+    }
+    default:
+      // Manifests never contain binary values.
+      return false;
+  }
+}
+
+scoped_ptr<base::Value> ReadValue(PickleIterator* iter, int depth) {
+  int tag;
+  if (depth > kMaxDepth || !iter->ReadInt(&tag))
+    return scoped_ptr<base::Value>();
+
+  switch (tag) {
+    case TAG_NULL:
+      return make_scoped_ptr(base::Value::CreateNullValue());
+    case TAG_BOOLEAN: {
+      bool boolean;
+      if (!iter->ReadBool(&boolean))
+        break;
+      return make_scoped_ptr<base::Value>(
+          new base::FundamentalValue(boolean));
+    }
+    case TAG_INTEGER: {
+      int integer;
+      if (!iter->ReadInt(&integer))
+        break;
+      return make_scoped_ptr<base::Value>(
+          new base::FundamentalValue(integer));
+    }
+    case TAG_DOUBLE: {
+      double number;
+      if (!iter->ReadDouble(&number))
+        break;
+      return make_scoped_ptr<base::Value>(new base::FundamentalValue(number));
+    }
+    case TAG_STRING: {
+      std::string string;
+      if (!iter->ReadString(&string))
+        break;
+      return make_scoped_ptr<base::Value>(new base::StringValue(string));
+    }
+    case TAG_DICTIONARY: {
+      int size;
+      if (!iter->ReadInt(&size) || size < 0)
+        break;
+      scoped_ptr<base::DictionaryValue> dict(new base::DictionaryValue);
+      for (int i = 0; i < size; ++i) {
+        std::string key;
+        if (!iter->ReadString(&key))
+          return scoped_ptr<base::Value>();
+        scoped_ptr<base::Value> value = ReadValue(iter, depth + 1);
+        if (!value)
+          return scoped_ptr<base::Value>();
+        dict->SetWithoutPathExpansion(key, value.release());
+      }
+      return dict.PassAs<base::Value>();
+    }
+    case TAG_LIST: {
+      int size;
+      if (!iter->ReadInt(&size) || size < 0)
+        break;
+      scoped_ptr<base::ListValue> list(new base::ListValue);
+      for (int i = 0; i < size; ++i) {
+        scoped_ptr<base::Value> value = ReadValue(iter, depth + 1);
+        if (!value)
+          return scoped_ptr<base::Value>();
+        list->Append(value.release());
+      }
+      return list.PassAs<base::Value>();
+    }
+  }
+  return scoped_ptr<base::Value>();
+}
+
+scoped_ptr<base::DictionaryValue> ReadDictionary(PickleIterator* iter) {
+  scoped_ptr<base::Value> value = ReadValue(iter, 0);
+  if (!value || !value->IsType(base::Value::TYPE_DICTIONARY))
+    return scoped_ptr<base::DictionaryValue>();
+  return make_scoped_ptr(static_cast<base::DictionaryValue*>(value.release()));
+}
+
+void WriteEntry(const base::FilePath& cache_dir,
+                const base::FilePath& entry_path,
+                const std::string& data) {
+  if ((!base::DirectoryExists(cache_dir) &&
+       !base::CreateDirectory(cache_dir)) ||
+      !base::ImportantFileWriter::WriteFileAtomically(entry_path, data))
+    LOG(WARNING) << "Failed to write manifest cache entry "
+                 << entry_path.AsUTF8Unsafe();
+}
+
+// The entry is only valid as long as the manifest is left untouched.
+bool GetManifestStamp(const base::FilePath& manifest_path,
+                      int64* last_modified, int64* size) {
+  base::File::Info info;
+  if (!base::GetFileInfo(manifest_path, &info))
+    return false;
+  *last_modified = info.last_modified.ToInternalValue();
+  *size = info.size;
+  return true;
+}
+
+}  // namespace
+
+ManifestCache::ManifestCache(
+    const base::FilePath& cache_dir,
+    scoped_refptr<base::SequencedTaskRunner> task_runner)
+    : cache_dir_(cache_dir),
+      task_runner_(task_runner) {
+}
+
+ManifestCache::~ManifestCache() {
+}
+
+scoped_ptr<Manifest> ManifestCache::Load(const base::FilePath& manifest_path,
+                                         Manifest::Type type) const {
+  int64 last_modified, size;
+  if (!GetManifestStamp(manifest_path, &last_modified, &size))
+    return scoped_ptr<Manifest>();
+
+  base::MemoryMappedFile entry;
+  if (!entry.Initialize(GetEntryPath(manifest_path)))
+    return scoped_ptr<Manifest>();
+
+  Pickle pickle(reinterpret_cast<const char*>(entry.data()),
+                static_cast<int>(entry.length()));
+  PickleIterator iter(pickle);
+
+  uint32 magic;
+  int version, parser_version, entry_type;
+  std::string entry_manifest_path;
+  int64 entry_last_modified, entry_size;
+  if (!iter.ReadUInt32(&magic) || magic != kMagic ||
+      !iter.ReadInt(&version) || version != kFormatVersion ||
+      !iter.ReadInt(&parser_version) || parser_version != kParserVersion ||
+      !iter.ReadString(&entry_manifest_path) ||
+      entry_manifest_path != manifest_path.AsUTF8Unsafe() ||
+      !iter.ReadInt64(&entry_last_modified) ||
+      entry_last_modified != last_modified ||
+      !iter.ReadInt64(&entry_size) || entry_size != size ||
+      !iter.ReadInt(&entry_type) || entry_type != type)
+    return scoped_ptr<Manifest>();
+
+  scoped_ptr<base::DictionaryValue> value = ReadDictionary(&iter);
+  scoped_ptr<base::DictionaryValue> i18n_value = ReadDictionary(&iter);
+  if (!value || !i18n_value) {
+    LOG(WARNING) << "Ignoring corrupted manifest cache entry for "
+                 << manifest_path.AsUTF8Unsafe();
+    return scoped_ptr<Manifest>();
+  }
+
+  return make_scoped_ptr(
+      new Manifest(value.Pass(), i18n_value.Pass(), type));
+}
+
+bool ManifestCache::Store(const base::FilePath& manifest_path,
+                          const Manifest& manifest) const {
+  int64 last_modified, size;
+  if (!GetManifestStamp(manifest_path, &last_modified, &size))
+    return false;
+
+  Pickle pickle;
+  if (!pickle.WriteUInt32(kMagic) ||
+      !pickle.WriteInt(kFormatVersion) ||
+      !pickle.WriteInt(kParserVersion) ||
+      !pickle.WriteString(manifest_path.AsUTF8Unsafe()) ||
+      !pickle.WriteInt64(last_modified) ||
+      !pickle.WriteInt64(size) ||
+      !pickle.WriteInt(manifest.type()) ||
+      !WriteValue(*manifest.value(), &pickle) ||
+      !WriteValue(*manifest.i18n_value(), &pickle))
+    return false;
+
+  // Loads don't wait for the entry, a manifest loaded again before it is
+  // written is just parsed again.
+  return task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&WriteEntry, cache_dir_, GetEntryPath(manifest_path),
+                 std::string(static_cast<const char*>(pickle.data()),
+                             pickle.size())));
+}
+
+base::FilePath ManifestCache::GetEntryPath(
+    const base::FilePath& manifest_path) const {
+  const std::string hash = base::SHA1HashString(manifest_path.AsUTF8Unsafe());
+  return cache_dir_.AppendASCII(base::HexEncode(hash.data(), hash.size()));
+}
+
+}  // namespace application
+}  // namespace xwalk
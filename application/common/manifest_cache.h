@@ -0,0 +1,59 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_APPLICATION_COMMON_MANIFEST_CACHE_H_
+#define XWALK_APPLICATION_COMMON_MANIFEST_CACHE_H_
+
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "xwalk/application/common/manifest.h"
+
+namespace base {
+class SequencedTaskRunner;
+}
+
+namespace xwalk {
+namespace application {
+
+// Keeps the parsed form of manifest files on disk in a compact binary format,
+// so that loading a manifest which did not change since it was last loaded
+// skips the JSON or XML parsing and the localization of widget elements.
+//
+// Entries are keyed by the manifest path and are only used when the
+// modification time and size of the manifest still match the ones recorded
+// in the entry, and with the parser that wrote it. Manifest handlers still
+// run on every load, as their results are not serializable.
+class ManifestCache {
+ public:
+  // The entries are written on |task_runner|, in the order they are stored.
+  ManifestCache(const base::FilePath& cache_dir,
+                scoped_refptr<base::SequencedTaskRunner> task_runner);
+  ~ManifestCache();
+
+  // Returns the manifest cached for |manifest_path|, or NULL if there is no
+  // valid entry for it.
+  scoped_ptr<Manifest> Load(const base::FilePath& manifest_path,
+                            Manifest::Type type) const;
+
+  // Serializes |manifest|, parsed from |manifest_path|, and posts the write
+  // of its entry. Returns false if the manifest could not be serialized.
+  bool Store(const base::FilePath& manifest_path,
+             const Manifest& manifest) const;
+
+  const base::FilePath& cache_dir() const { return cache_dir_; }
+
+ private:
+  base::FilePath GetEntryPath(const base::FilePath& manifest_path) const;
+
+  base::FilePath cache_dir_;
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+
+  DISALLOW_COPY_AND_ASSIGN(ManifestCache);
+};
+
+}  // namespace application
+}  // namespace xwalk
+
+#endif  // XWALK_APPLICATION_COMMON_MANIFEST_CACHE_H_
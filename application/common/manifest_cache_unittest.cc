@@ -0,0 +1,159 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/application/common/manifest_cache.h"
+
+#include <string>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/test/test_simple_task_runner.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/application/common/application_file_util.h"
+
+namespace xwalk {
+namespace application {
+
+namespace {
+
+const char kJSONManifest[] =
+    "{ \"name\": \"cached\", \"xwalk_version\": \"1\","
+    "  \"permissions\": [\"a\", \"b\"], \"nested\": { \"value\": 2.5 } }";
+
+const char kWidgetManifest[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+    "<widget xmlns=\"http://www.w3.org/ns/widgets\" version=\"1.0\">"
+    "  <name>unlocalized</name>"
+    "  <name xml:lang=\"zh-cn\">localized</name>"
+    "  <access origin=\"http://a.com\"/>"
+    "  <access origin=\"http://b.com\"/>"
+    "</widget>";
+
+}  // namespace
+
+class ManifestCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    task_runner_ = new base::TestSimpleTaskRunner;
+    cache_.reset(new ManifestCache(temp_dir_.path().AppendASCII("cache"),
+                                   task_runner_));
+  }
+
+  // Stores |manifest| and waits for its entry to be written.
+  bool Store(const base::FilePath& path, const Manifest& manifest) {
+    if (!cache_->Store(path, manifest))
+      return false;
+    task_runner_->RunUntilIdle();
+    return true;
+  }
+
+  base::FilePath WriteManifest(const std::string& name,
+                               const std::string& content) {
+    base::FilePath path = temp_dir_.path().AppendASCII(name);
+    EXPECT_EQ(static_cast<int>(content.size()),
+              base::WriteFile(path, content.data(), content.size()));
+    return path;
+  }
+
+  base::ScopedTempDir temp_dir_;
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner_;
+  scoped_ptr<ManifestCache> cache_;
+};
+
+TEST_F(ManifestCacheTest, MissingEntry) {
+  base::FilePath path = WriteManifest("manifest.json", kJSONManifest);
+  EXPECT_FALSE(cache_->Load(path, Manifest::TYPE_MANIFEST));
+}
+
+TEST_F(ManifestCacheTest, StoreAndLoadManifest) {
+  base::FilePath path = WriteManifest("manifest.json", kJSONManifest);
+  std::string error;
+  scoped_ptr<Manifest> manifest =
+      LoadManifest(path, Manifest::TYPE_MANIFEST, &error);
+  ASSERT_TRUE(manifest);
+  ASSERT_TRUE(Store(path, *manifest));
+
+  scoped_ptr<Manifest> cached = cache_->Load(path, Manifest::TYPE_MANIFEST);
+  ASSERT_TRUE(cached);
+  EXPECT_EQ(Manifest::TYPE_MANIFEST, cached->type());
+  EXPECT_TRUE(manifest->Equals(cached.get()));
+
+  // The entry is not used for another type of manifest.
+  EXPECT_FALSE(cache_->Load(path, Manifest::TYPE_WIDGET));
+}
+
+TEST_F(ManifestCacheTest, StoreAndLoadWidget) {
+  base::FilePath path = WriteManifest("config.xml", kWidgetManifest);
+  std::string error;
+  scoped_ptr<Manifest> manifest =
+      LoadManifest(path, Manifest::TYPE_WIDGET, &error);
+  ASSERT_TRUE(manifest);
+  ASSERT_TRUE(Store(path, *manifest));
+
+  scoped_ptr<Manifest> cached = cache_->Load(path, Manifest::TYPE_WIDGET);
+  ASSERT_TRUE(cached);
+  EXPECT_TRUE(manifest->Equals(cached.get()));
+  EXPECT_TRUE(manifest->i18n_value()->Equals(cached->i18n_value()));
+
+  std::string name;
+  cached->SetSystemLocale("zh-cn");
+  EXPECT_TRUE(cached->GetString("widget.name.#text", &name));
+  EXPECT_EQ("localized", name);
+}
+
+TEST_F(ManifestCacheTest, ModifiedManifestInvalidatesEntry) {
+  base::FilePath path = WriteManifest("manifest.json", kJSONManifest);
+  std::string error;
+  scoped_ptr<Manifest> manifest =
+      LoadManifest(path, Manifest::TYPE_MANIFEST, &error);
+  ASSERT_TRUE(manifest);
+  ASSERT_TRUE(Store(path, *manifest));
+
+  WriteManifest("manifest.json", "{ \"name\": \"changed\" }");
+  EXPECT_FALSE(cache_->Load(path, Manifest::TYPE_MANIFEST));
+}
+
+TEST_F(ManifestCacheTest, LoadManifestUsesCache) {
+  base::FilePath path = WriteManifest("manifest.json", kJSONManifest);
+  SetManifestCache(cache_.get());
+
+  std::string error;
+  scoped_ptr<Manifest> manifest =
+      LoadManifest(path, Manifest::TYPE_MANIFEST, &error);
+  ASSERT_TRUE(manifest);
+
+  // The entry is written on the task runner.
+  EXPECT_FALSE(cache_->Load(path, Manifest::TYPE_MANIFEST));
+  task_runner_->RunUntilIdle();
+  scoped_ptr<Manifest> cached = cache_->Load(path, Manifest::TYPE_MANIFEST);
+  ASSERT_TRUE(cached);
+  EXPECT_TRUE(manifest->Equals(cached.get()));
+
+  SetManifestCache(NULL);
+}
+
+TEST_F(ManifestCacheTest, TemporaryApplicationsAreNotCached) {
+  base::FilePath path = WriteManifest("manifest.json", kJSONManifest);
+  SetManifestCache(cache_.get());
+
+  std::string error;
+  LoadApplication(temp_dir_.path(), std::string(),
+                  ApplicationData::TEMP_DIRECTORY, Manifest::TYPE_MANIFEST,
+                  &error);
+  task_runner_->RunUntilIdle();
+  EXPECT_FALSE(cache_->Load(path, Manifest::TYPE_MANIFEST));
+
+  LoadApplication(temp_dir_.path(), std::string(),
+                  ApplicationData::LOCAL_DIRECTORY, Manifest::TYPE_MANIFEST,
+                  &error);
+  task_runner_->RunUntilIdle();
+  EXPECT_TRUE(cache_->Load(path, Manifest::TYPE_MANIFEST));
+
+  SetManifestCache(NULL);
+}
+
+}  // namespace application
+}  // namespace xwalk
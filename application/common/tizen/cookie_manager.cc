@@ -31,9 +31,12 @@ void CookieManager::CookieDeleted(bool success) {
 
 void CookieManager::DeleteSessionOnlyOriginCookies(
     const net::CookieList& cookies) {
-  net::URLRequestContext* request_context = browser_context_->
-      GetURLRequestContextGetterById(
-          std::string(app_id_))->GetURLRequestContext();
+  // Applications without their own storage partition have no getter.
+  RuntimeURLRequestContextGetter* getter =
+      browser_context_->GetURLRequestContextGetterById(app_id_);
+  if (!getter)
+    return;
+  net::URLRequestContext* request_context = getter->GetURLRequestContext();
   if (!request_context)
     return;
   net::CookieMonster* cookie_monster =
@@ -50,9 +53,12 @@ void CookieManager::DeleteCookiesOnIOThread(
     const std::string& url,
     const std::string& cookie_name) {
   DCHECK(content::BrowserThread::CurrentlyOn(content::BrowserThread::IO));
-  net::URLRequestContext* request_context = browser_context_->
-      GetURLRequestContextGetterById(app_id_)->GetURLRequestContext();
-  net::CookieStore* cookie_store = request_context->cookie_store();
+  RuntimeURLRequestContextGetter* getter =
+      browser_context_->GetURLRequestContextGetterById(app_id_);
+  if (!getter)
+    return;
+  net::CookieStore* cookie_store =
+      getter->GetURLRequestContext()->cookie_store();
   cookie_store->GetCookieMonster()->GetAllCookiesAsync(
       base::Bind(&CookieManager::DeleteSessionOnlyOriginCookies,
                  base::Unretained(this)));
@@ -0,0 +1,429 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/application/common/widget_xml_parser.h"
+
+#include <cstring>
+
+#include "base/i18n/rtl.h"
+#include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/strings/string16.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/values.h"
+#include "third_party/libxml/src/include/libxml/parser.h"
+#include "xwalk/application/common/application_manifest_constants.h"
+
+namespace widget_keys = xwalk::application_widget_keys;
+
+namespace xwalk {
+namespace application {
+
+namespace {
+
+const char kAttributePrefix[] = "@";
+const char kNamespaceKey[] = "@namespace";
+const char kTextKey[] = "#text";
+
+const char kContentKey[] = "content";
+
+const char kWidgetNodeKey[] = "widget";
+const char kNameNodeKey[] = "name";
+const char kDescriptionNodeKey[] = "description";
+const char kAuthorNodeKey[] = "author";
+const char kLicenseNodeKey[] = "license";
+const char kVersionAttributeKey[] = "version";
+const char kShortAttributeKey[] = "short";
+const char kDirAttributeKey[] = "dir";
+
+const char kDirLTRKey[] = "ltr";
+const char kDirRTLKey[] = "rtl";
+const char kDirLROKey[] = "lro";
+const char kDirRLOKey[] = "rlo";
+
+const char* kSingletonElements[] = {
+  "allow-navigation",
+  "author",
+  "content-security-policy-report-only",
+  "content-security-policy",
+  "content"
+};
+
+inline const char* ToConstCharPointer(const xmlChar* ptr) {
+  return reinterpret_cast<const char*>(ptr);
+}
+
+base::string16 GetDirText(const base::string16& text, const std::string& dir) {
+  if (dir == kDirLTRKey)
+    return base::i18n::kLeftToRightEmbeddingMark
+           + text
+           + base::i18n::kPopDirectionalFormatting;
+
+  if (dir == kDirRTLKey)
+    return base::i18n::kRightToLeftEmbeddingMark
+           + text
+           + base::i18n::kPopDirectionalFormatting;
+
+  if (dir == kDirLROKey)
+    return base::i18n::kLeftToRightOverride
+           + text
+           + base::i18n::kPopDirectionalFormatting;
+
+  if (dir == kDirRLOKey)
+    return base::i18n::kRightToLeftOverride
+           + text
+           + base::i18n::kPopDirectionalFormatting;
+
+  return text;
+}
+
+// According to widget specification, this two prop need to support dir.
+// see detail on http://www.w3.org/TR/widgets/#the-dir-attribute
+inline bool IsPropSupportDir(const std::string& element,
+                             const std::string& prop) {
+  if (element == kWidgetNodeKey && prop == kVersionAttributeKey)
+    return true;
+  if (element == kNameNodeKey && prop == kShortAttributeKey)
+    return true;
+  return false;
+}
+
+// Only this four items need to support span and ignore other element.
+// See http://www.w3.org/TR/widgets/#the-span-element-and-its-attributes
+inline bool IsElementSupportSpanAndDir(const std::string& element) {
+  if (element == kNameNodeKey
+     || element == kDescriptionNodeKey
+     || element == kAuthorNodeKey
+     || element == kLicenseNodeKey)
+    return true;
+  return false;
+}
+
+bool IsSingletonElement(const std::string& name) {
+  for (size_t i = 0; i < arraysize(kSingletonElements); ++i)
+    if (kSingletonElements[i] == name)
+#if defined(OS_TIZEN)
+      // On Tizen platform, need to check namespace of 'content'
+      // element further, a content element with tizen namespace
+      // will replace the one with widget namespace.
+      return name != kContentKey;
+#else
+      return true;
+#endif
+  return false;
+}
+
+// Builds the manifest dictionary from libxml2 SAX2 events. Every element
+// keeps its dictionary on a stack until its end tag, where the dictionary is
+// moved into its parent, so no intermediate document tree is built and
+// repeated elements never get copied.
+class WidgetXMLParser {
+ public:
+  WidgetXMLParser() {}
+
+  scoped_ptr<base::DictionaryValue> Parse(const std::string& xml);
+
+ private:
+  // The type of the text node being accumulated, libxml2 merges adjacent
+  // character data of the same type into a single node.
+  enum RunType {
+    RUN_NONE,
+    RUN_TEXT,
+    RUN_CDATA
+  };
+
+  struct Element {
+    Element() : collect_text_with_dir(false), run_type(RUN_NONE) {}
+
+    std::string name;
+    std::string dir;
+    scoped_ptr<base::DictionaryValue> value;
+    // The character data of the direct children of the element.
+    std::string text;
+    // Whether the element, or one of its ancestors, supports span and dir,
+    // in which case the text of the whole subtree is needed with the bidi
+    // control characters of each nested element.
+    bool collect_text_with_dir;
+    base::string16 text_with_dir;
+    RunType run_type;
+    std::string run;
+  };
+
+  static void OnStartElement(void* context,
+                             const xmlChar* local_name,
+                             const xmlChar* prefix,
+                             const xmlChar* uri,
+                             int namespace_count,
+                             const xmlChar** namespaces,
+                             int attribute_count,
+                             int defaulted_count,
+                             const xmlChar** attributes);
+  static void OnEndElement(void* context,
+                           const xmlChar* local_name,
+                           const xmlChar* prefix,
+                           const xmlChar* uri);
+  static void OnCharacters(void* context, const xmlChar* data, int length);
+  static void OnCDataBlock(void* context, const xmlChar* data, int length);
+  static void OnComment(void* context, const xmlChar* data);
+  static void OnProcessingInstruction(void* context,
+                                      const xmlChar* target,
+                                      const xmlChar* data);
+
+  void StartElement(const xmlChar* local_name,
+                    const xmlChar* uri,
+                    int attribute_count,
+                    const xmlChar** attributes);
+  void EndElement();
+  void AppendText(RunType type, const char* data, int length);
+  void FlushRun(Element* element);
+  void AddChild(base::DictionaryValue* parent,
+                const std::string& name,
+                scoped_ptr<base::DictionaryValue> child);
+
+  ScopedVector<Element> stack_;
+  std::string root_name_;
+  scoped_ptr<base::DictionaryValue> root_;
+
+  DISALLOW_COPY_AND_ASSIGN(WidgetXMLParser);
+};
+
+scoped_ptr<base::DictionaryValue> WidgetXMLParser::Parse(
+    const std::string& xml) {
+  xmlSAXHandler handler;
+  memset(&handler, 0, sizeof(handler));
+  handler.initialized = XML_SAX2_MAGIC;
+  handler.startElementNs = &WidgetXMLParser::OnStartElement;
+  handler.endElementNs = &WidgetXMLParser::OnEndElement;
+  handler.characters = &WidgetXMLParser::OnCharacters;
+  handler.ignorableWhitespace = &WidgetXMLParser::OnCharacters;
+  handler.cdataBlock = &WidgetXMLParser::OnCDataBlock;
+  handler.comment = &WidgetXMLParser::OnComment;
+  handler.processingInstruction = &WidgetXMLParser::OnProcessingInstruction;
+
+  xmlParserCtxtPtr context =
+      xmlCreateMemoryParserCtxt(xml.data(), static_cast<int>(xml.size()));
+  if (!context)
+    return scoped_ptr<base::DictionaryValue>();
+
+  // The entities are replaced, otherwise libxml2 passes "&amp;" in attribute
+  // values as "&#38;". Only the predefined entities and the character
+  // references are known, since entity declarations are not handled, so no
+  // external entity is ever loaded.
+  xmlSAXHandlerPtr default_handler = context->sax;
+  context->sax = &handler;
+  context->userData = this;
+  xmlCtxtUseOptions(context, XML_PARSE_NOENT | XML_PARSE_NONET);
+  xmlParseDocument(context);
+  const bool well_formed = context->wellFormed;
+  context->sax = default_handler;
+  xmlFreeParserCtxt(context);
+
+  if (!well_formed || !root_)
+    return scoped_ptr<base::DictionaryValue>();
+  DCHECK(stack_.empty());
+
+  scoped_ptr<base::DictionaryValue> result(new base::DictionaryValue);
+  result->SetWithoutPathExpansion(root_name_, root_.release());
+  return result.Pass();
+}
+
+// static
+void WidgetXMLParser::OnStartElement(void* context,
+                                     const xmlChar* local_name,
+                                     const xmlChar* prefix,
+                                     const xmlChar* uri,
+                                     int namespace_count,
+                                     const xmlChar** namespaces,
+                                     int attribute_count,
+                                     int defaulted_count,
+                                     const xmlChar** attributes) {
+  static_cast<WidgetXMLParser*>(context)->StartElement(
+      local_name, uri, attribute_count, attributes);
+}
+
+// static
+void WidgetXMLParser::OnEndElement(void* context,
+                                   const xmlChar* local_name,
+                                   const xmlChar* prefix,
+                                   const xmlChar* uri) {
+  static_cast<WidgetXMLParser*>(context)->EndElement();
+}
+
+// static
+void WidgetXMLParser::OnCharacters(void* context,
+                                   const xmlChar* data,
+                                   int length) {
+  static_cast<WidgetXMLParser*>(context)->AppendText(
+      RUN_TEXT, ToConstCharPointer(data), length);
+}
+
+// static
+void WidgetXMLParser::OnCDataBlock(void* context,
+                                   const xmlChar* data,
+                                   int length) {
+  static_cast<WidgetXMLParser*>(context)->AppendText(
+      RUN_CDATA, ToConstCharPointer(data), length);
+}
+
+// static
+void WidgetXMLParser::OnComment(void* context, const xmlChar* data) {
+  WidgetXMLParser* parser = static_cast<WidgetXMLParser*>(context);
+  if (!parser->stack_.empty())
+    parser->FlushRun(parser->stack_.back());
+}
+
+// static
+void WidgetXMLParser::OnProcessingInstruction(void* context,
+                                              const xmlChar* target,
+                                              const xmlChar* data) {
+  OnComment(context, data);
+}
+
+void WidgetXMLParser::StartElement(const xmlChar* local_name,
+                                   const xmlChar* uri,
+                                   int attribute_count,
+                                   const xmlChar** attributes) {
+  Element* parent = stack_.empty() ? NULL : stack_.back();
+  if (parent)
+    FlushRun(parent);
+
+  scoped_ptr<Element> element(new Element);
+  element->name = ToConstCharPointer(local_name);
+  element->value.reset(new base::DictionaryValue);
+  element->collect_text_with_dir =
+      IsElementSupportSpanAndDir(element->name) ||
+      (parent && parent->collect_text_with_dir);
+
+  // Each attribute is given as (local name, prefix, URI, value, end).
+  element->dir = parent ? parent->dir : std::string();
+  for (int i = 0; i < attribute_count; ++i) {
+    const xmlChar** attribute = attributes + i * 5;
+    if (!strcmp(ToConstCharPointer(attribute[0]), kDirAttributeKey)) {
+      element->dir.assign(ToConstCharPointer(attribute[3]),
+                          attribute[4] - attribute[3]);
+      break;
+    }
+  }
+
+  for (int i = 0; i < attribute_count; ++i) {
+    const xmlChar** attribute = attributes + i * 5;
+    const std::string name(ToConstCharPointer(attribute[0]));
+    const std::string value(ToConstCharPointer(attribute[3]),
+                            attribute[4] - attribute[3]);
+    const std::string key = kAttributePrefix + name;
+    if (IsPropSupportDir(element->name, name)) {
+      element->value->SetStringWithoutPathExpansion(
+          key, GetDirText(base::UTF8ToUTF16(value), element->dir));
+    } else {
+      element->value->SetStringWithoutPathExpansion(key, value);
+    }
+  }
+
+  if (uri)
+    element->value->SetString(kNamespaceKey, ToConstCharPointer(uri));
+
+  stack_.push_back(element.release());
+}
+
+void WidgetXMLParser::EndElement() {
+  DCHECK(!stack_.empty());
+  Element* element = stack_.back();
+  FlushRun(element);
+
+  if (IsElementSupportSpanAndDir(element->name)) {
+    base::string16 text = GetDirText(element->text_with_dir, element->dir);
+    if (!text.empty())
+      element->value->SetString(kTextKey, text);
+  } else if (!element->text.empty()) {
+    element->value->SetString(kTextKey, element->text);
+  }
+
+  Element* parent = stack_.size() > 1 ? stack_[stack_.size() - 2] : NULL;
+  if (!parent) {
+    root_name_ = element->name;
+    root_ = element->value.Pass();
+  } else {
+    if (parent->collect_text_with_dir) {
+      parent->text_with_dir +=
+          GetDirText(element->text_with_dir, element->dir);
+    }
+    AddChild(parent->value.get(), element->name, element->value.Pass());
+  }
+  stack_.pop_back();
+}
+
+void WidgetXMLParser::AppendText(RunType type, const char* data, int length) {
+  if (stack_.empty())
+    return;
+  Element* element = stack_.back();
+  element->text.append(data, length);
+  if (!element->collect_text_with_dir)
+    return;
+  if (element->run_type != type)
+    FlushRun(element);
+  element->run_type = type;
+  element->run.append(data, length);
+}
+
+void WidgetXMLParser::FlushRun(Element* element) {
+  if (element->run_type == RUN_NONE)
+    return;
+  element->text_with_dir += base::i18n::StripWrappingBidiControlCharacters(
+      base::UTF8ToUTF16(element->run));
+  element->run.clear();
+  element->run_type = RUN_NONE;
+}
+
+void WidgetXMLParser::AddChild(base::DictionaryValue* parent,
+                               const std::string& name,
+                               scoped_ptr<base::DictionaryValue> child) {
+  base::Value* existing = NULL;
+  if (!parent->GetWithoutPathExpansion(name, &existing)) {
+    parent->SetWithoutPathExpansion(name, child.release());
+    return;
+  }
+
+  if (IsSingletonElement(name))
+    return;
+
+#if defined(OS_TIZEN)
+  if (name == kContentKey) {
+    std::string current_namespace, new_namespace;
+    base::DictionaryValue* current_value = NULL;
+    if (existing->GetAsDictionary(&current_value))
+      current_value->GetString(kNamespaceKey, &current_namespace);
+    child->GetString(kNamespaceKey, &new_namespace);
+    if (current_namespace != new_namespace &&
+        new_namespace == widget_keys::kTizenNamespacePrefix)
+      parent->SetWithoutPathExpansion(name, child.release());
+    return;
+  }
+#endif
+
+  base::ListValue* list = NULL;
+  if (existing->GetAsList(&list)) {
+    list->Append(child.release());
+    return;
+  }
+
+  // The second occurrence of an element turns the entry into a list, the
+  // first occurrence is moved into it rather than copied.
+  DCHECK(existing->IsType(base::Value::TYPE_DICTIONARY));
+  scoped_ptr<base::Value> previous;
+  parent->RemoveWithoutPathExpansion(name, &previous);
+  list = new base::ListValue;
+  list->Append(previous.release());
+  list->Append(child.release());
+  parent->SetWithoutPathExpansion(name, list);
+}
+
+}  // namespace
+
+scoped_ptr<base::DictionaryValue> ParseWidgetXML(const std::string& xml) {
+  WidgetXMLParser parser;
+  return parser.Parse(xml);
+}
+
+}  // namespace application
+}  // namespace xwalk
@@ -0,0 +1,65 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_APPLICATION_COMMON_WIDGET_XML_PARSER_H_
+#define XWALK_APPLICATION_COMMON_WIDGET_XML_PARSER_H_
+
+#include <string>
+
+#include "base/memory/scoped_ptr.h"
+
+namespace base {
+class DictionaryValue;
+}
+
+namespace xwalk {
+namespace application {
+
+// Parses a widget configuration document (config.xml) into the dictionary
+// layout used by widget manifests, in a single pass over the document.
+// Returns NULL if |xml| is not a well-formed XML document.
+//
+// The keys for the XML node to Dictionary mapping are described below:
+// XML                                 Dictionary
+// <e></e>                             "e":{"#text": ""}
+// <e>textA</e>                        "e":{"#text":"textA"}
+// <e attr="val">textA</e>             "e":{ "@attr":"val", "#text": "textA"}
+// <e> <a>textA</a> <b>textB</b> </e>  "e":{
+//                                       "a":{"#text":"textA"}
+//                                       "b":{"#text":"textB"}
+//                                     }
+// <e> <a>textX</a> <a>textY</a> </e>  "e":{
+//                                       "a":[ {"#text":"textX"},
+//                                             {"#text":"textY"}]
+//                                     }
+// <e> textX <a>textY</a> </e>         "e":{ "#text":"textX",
+//                                           "a":{"#text":"textY"}
+//                                     }
+//
+// For elements that are specified under a namespace, the dictionary
+// will add '@namespace' key for them, e.g.,
+// XML:
+// <e xmln="linkA" xmlns:N="LinkB">
+//   <sub-e1> text1 </sub-e>
+//   <N:sub-e2 text2 />
+// </e>
+// will be saved in Dictionary as,
+// "e":{
+//   "#text": "",
+//   "@namespace": "linkA"
+//   "sub-e1": {
+//     "#text": "text1",
+//     "@namespace": "linkA"
+//   },
+//   "sub-e2": {
+//     "#text":"text2"
+//     "@namespace": "linkB"
+//   }
+// }
+scoped_ptr<base::DictionaryValue> ParseWidgetXML(const std::string& xml);
+
+}  // namespace application
+}  // namespace xwalk
+
+#endif  // XWALK_APPLICATION_COMMON_WIDGET_XML_PARSER_H_
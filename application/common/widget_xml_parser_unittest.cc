@@ -0,0 +1,160 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/application/common/widget_xml_parser.h"
+
+#include <string>
+
+#include "base/i18n/rtl.h"
+#include "base/strings/stringprintf.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace xwalk {
+namespace application {
+
+namespace {
+
+const char kWidgetNamespace[] = "http://www.w3.org/ns/widgets";
+
+const char kWidget[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+    "<widget xmlns=\"http://www.w3.org/ns/widgets\""
+    "        xmlns:t=\"http://tizen.org/ns/widgets\" version=\"1.0\">"
+    "<name short=\"s\">app</name>"
+    "<t:application id=\"x\"/>"
+    "<icon src=\"a.png\"/>"
+    "<icon src=\"b.png\"/>"
+    "<icon src=\"c.png\"/>"
+    "<author>first</author>"
+    "<author>second</author>"
+    "<content src=\"index.html\"><![CDATA[a<b]]></content>"
+    "</widget>";
+
+}  // namespace
+
+TEST(WidgetXMLParserTest, ElementsAndAttributes) {
+  scoped_ptr<base::DictionaryValue> value = ParseWidgetXML(kWidget);
+  ASSERT_TRUE(value);
+
+  std::string string;
+  EXPECT_TRUE(value->GetString("widget.@version", &string));
+  EXPECT_EQ("1.0", string);
+  EXPECT_TRUE(value->GetString("widget.@namespace", &string));
+  EXPECT_EQ(kWidgetNamespace, string);
+  EXPECT_TRUE(value->GetString("widget.name.#text", &string));
+  EXPECT_EQ("app", string);
+  EXPECT_TRUE(value->GetString("widget.name.@short", &string));
+  EXPECT_EQ("s", string);
+  EXPECT_TRUE(value->GetString("widget.application.@namespace", &string));
+  EXPECT_EQ("http://tizen.org/ns/widgets", string);
+  EXPECT_TRUE(value->GetString("widget.content.#text", &string));
+  EXPECT_EQ("a<b", string);
+
+  // Singleton elements keep their first occurrence.
+  EXPECT_TRUE(value->GetString("widget.author.#text", &string));
+  EXPECT_EQ("first", string);
+
+  // Repeated elements are turned into a list, in document order.
+  base::ListValue* icons = NULL;
+  ASSERT_TRUE(value->GetList("widget.icon", &icons));
+  ASSERT_EQ(3u, icons->GetSize());
+  const char* sources[] = { "a.png", "b.png", "c.png" };
+  for (size_t i = 0; i < arraysize(sources); ++i) {
+    base::DictionaryValue* icon = NULL;
+    ASSERT_TRUE(icons->GetDictionary(i, &icon));
+    EXPECT_TRUE(icon->GetString("@src", &string));
+    EXPECT_EQ(sources[i], string);
+  }
+}
+
+TEST(WidgetXMLParserTest, Entities) {
+  scoped_ptr<base::DictionaryValue> value = ParseWidgetXML(
+      "<widget xmlns=\"http://www.w3.org/ns/widgets\">"
+      "<content src=\"index.html?a=1&amp;b=&quot;2&quot;&#x26;c=&lt;3\"/>"
+      "<access origin=\"http://a.com/?x=1&amp;y=2\"/>"
+      "<name>a &amp; b</name>"
+      "</widget>");
+  ASSERT_TRUE(value);
+
+  std::string string;
+  EXPECT_TRUE(value->GetString("widget.content.@src", &string));
+  EXPECT_EQ("index.html?a=1&b=\"2\"&c=<3", string);
+  EXPECT_TRUE(value->GetString("widget.access.@origin", &string));
+  EXPECT_EQ("http://a.com/?x=1&y=2", string);
+  EXPECT_TRUE(value->GetString("widget.name.#text", &string));
+  EXPECT_EQ("a & b", string);
+}
+
+TEST(WidgetXMLParserTest, DirAndSpan) {
+  scoped_ptr<base::DictionaryValue> value = ParseWidgetXML(
+      "<widget xmlns=\"http://www.w3.org/ns/widgets\" dir=\"rtl\""
+      "        version=\"2\">"
+      "<description>a<span dir=\"ltr\">b</span>c</description>"
+      "<license dir=\"ltr\">l</license>"
+      "</widget>");
+  ASSERT_TRUE(value);
+
+  base::string16 text;
+  EXPECT_TRUE(value->GetString("widget.@version", &text));
+  EXPECT_EQ(base::i18n::kRightToLeftEmbeddingMark + base::ASCIIToUTF16("2") +
+            base::i18n::kPopDirectionalFormatting, text);
+
+  EXPECT_TRUE(value->GetString("widget.description.#text", &text));
+  EXPECT_EQ(base::i18n::kRightToLeftEmbeddingMark + base::ASCIIToUTF16("a") +
+            base::i18n::kLeftToRightEmbeddingMark + base::ASCIIToUTF16("b") +
+            base::i18n::kPopDirectionalFormatting + base::ASCIIToUTF16("c") +
+            base::i18n::kPopDirectionalFormatting, text);
+
+  EXPECT_TRUE(value->GetString("widget.license.#text", &text));
+  EXPECT_EQ(base::i18n::kLeftToRightEmbeddingMark + base::ASCIIToUTF16("l") +
+            base::i18n::kPopDirectionalFormatting, text);
+}
+
+TEST(WidgetXMLParserTest, ManyRepeatedElements) {
+  const int kCount = 5000;
+  std::string xml = "<widget xmlns=\"http://www.w3.org/ns/widgets\">";
+  for (int i = 0; i < kCount; ++i)
+    xml += base::StringPrintf("<access origin=\"http://%d.com\"/>", i);
+  xml += "</widget>";
+
+  scoped_ptr<base::DictionaryValue> value = ParseWidgetXML(xml);
+  ASSERT_TRUE(value);
+  base::ListValue* access = NULL;
+  ASSERT_TRUE(value->GetList("widget.access", &access));
+  ASSERT_EQ(static_cast<size_t>(kCount), access->GetSize());
+
+  base::DictionaryValue* last = NULL;
+  std::string origin;
+  ASSERT_TRUE(access->GetDictionary(kCount - 1, &last));
+  EXPECT_TRUE(last->GetString("@origin", &origin));
+  EXPECT_EQ(base::StringPrintf("http://%d.com", kCount - 1), origin);
+}
+
+TEST(WidgetXMLParserTest, MalformedDocuments) {
+  const char* kMalformed[] = {
+    "",
+    "widget",
+    "<widget>",
+    "<widget></name>",
+    "<widget><name></widget>",
+    "<widget a=\"1\" a=\"2\"/>",
+    "<widget>&undefined;</widget>",
+    "<widget/><widget/>",
+    "<widget><![CDATA[</widget>",
+    "<widget>\xff\xfe</widget>",
+  };
+  for (size_t i = 0; i < arraysize(kMalformed); ++i)
+    EXPECT_FALSE(ParseWidgetXML(kMalformed[i])) << kMalformed[i];
+
+  // No truncation of a valid document is accepted.
+  const std::string widget(kWidget);
+  for (size_t length = 0; length < widget.size(); ++length)
+    EXPECT_FALSE(ParseWidgetXML(widget.substr(0, length))) << length;
+  EXPECT_TRUE(ParseWidgetXML(widget));
+}
+
+}  // namespace application
+}  // namespace xwalk
@@ -11,6 +11,7 @@
 #include "grit/xwalk_application_resources.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "xwalk/application/browser/application.h"
+#include "xwalk/application/browser/application_service.h"
 #include "xwalk/application/common/application_data.h"
 #include "xwalk/runtime/browser/runtime.h"
 
@@ -20,15 +21,20 @@ namespace xwalk {
 namespace application {
 
 ApplicationRuntimeExtension::ApplicationRuntimeExtension(
-    Application* application)
-  : application_(application) {
+    ApplicationService* service, int render_process_id)
+  : service_(service),
+    render_process_id_(render_process_id) {
   set_name("xwalk.app.runtime");
   set_javascript_api(ResourceBundle::GetSharedInstance().GetRawDataResource(
       IDR_XWALK_APPLICATION_RUNTIME_API).as_string());
 }
 
 XWalkExtensionInstance* ApplicationRuntimeExtension::CreateInstance() {
-  return new AppRuntimeExtensionInstance(application_);
+  Application* application =
+      service_->GetApplicationByRenderHostID(render_process_id_);
+  if (!application)
+    return NULL;
+  return new AppRuntimeExtensionInstance(application);
 }
 
 AppRuntimeExtensionInstance::AppRuntimeExtensionInstance(
@@ -13,6 +13,7 @@
 namespace xwalk {
 namespace application {
 class Application;
+class ApplicationService;
 
 using extensions::XWalkExtension;
 using extensions::XWalkExtensionFunctionHandler;
@@ -21,13 +22,18 @@ using extensions::XWalkExtensionInstance;
 
 class ApplicationRuntimeExtension : public XWalkExtension {
  public:
-  explicit ApplicationRuntimeExtension(Application* application);
+  // The application is looked up when an instance is created, since the
+  // render process may not be hosting any application yet, e.g. if it is
+  // the spare one kept by ApplicationService.
+  ApplicationRuntimeExtension(ApplicationService* service,
+                              int render_process_id);
 
   // XWalkExtension implementation.
   XWalkExtensionInstance* CreateInstance() override;
 
  private:
-  Application* application_;
+  ApplicationService* service_;
+  int render_process_id_;
 };
 
 class AppRuntimeExtensionInstance : public XWalkExtensionInstance {
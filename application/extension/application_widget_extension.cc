@@ -20,6 +20,7 @@
 #include "grit/xwalk_application_resources.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "xwalk/application/browser/application.h"
+#include "xwalk/application/browser/application_service.h"
 #include "xwalk/application/common/application_data.h"
 #include "xwalk/application/common/application_manifest_constants.h"
 #include "xwalk/application/common/manifest_handlers/widget_handler.h"
@@ -83,15 +84,20 @@ namespace application {
 namespace widget_keys = xwalk::application_widget_keys;
 
 ApplicationWidgetExtension::ApplicationWidgetExtension(
-    Application* application)
-  : application_(application) {
+    ApplicationService* service, int render_process_id)
+  : service_(service),
+    render_process_id_(render_process_id) {
   set_name("widget");
   set_javascript_api(ResourceBundle::GetSharedInstance().GetRawDataResource(
       IDR_XWALK_APPLICATION_WIDGET_API).as_string());
 }
 
 XWalkExtensionInstance* ApplicationWidgetExtension::CreateInstance() {
-  return new AppWidgetExtensionInstance(application_);
+  Application* application =
+      service_->GetApplicationByRenderHostID(render_process_id_);
+  if (!application)
+    return NULL;
+  return new AppWidgetExtensionInstance(application);
 }
 
 AppWidgetExtensionInstance::AppWidgetExtensionInstance(
@@ -12,19 +12,25 @@
 namespace xwalk {
 namespace application {
 class Application;
+class ApplicationService;
 
 using extensions::XWalkExtension;
 using extensions::XWalkExtensionInstance;
 
 class ApplicationWidgetExtension : public XWalkExtension {
  public:
-  explicit ApplicationWidgetExtension(Application* application);
+  // The application is looked up when an instance is created, since the
+  // render process may not be hosting any application yet, e.g. if it is
+  // the spare one kept by ApplicationService.
+  ApplicationWidgetExtension(ApplicationService* service,
+                             int render_process_id);
 
   // XWalkExtension implementation.
   XWalkExtensionInstance* CreateInstance() override;
 
  private:
-  Application* application_;
+  ApplicationService* service_;
+  int render_process_id_;
 };
 
 class AppWidgetExtensionInstance : public XWalkExtensionInstance {
@@ -43,6 +43,10 @@ class XWalkExtensionData {
     return extension_process_host_.Pass();
   }
 
+  XWalkExtensionProcessHost* GetExtensionProcessHost() {
+    return extension_process_host_.get();
+  }
+
   content::RenderProcessHost* render_process_host() {
     return render_process_host_;
   }
@@ -10,6 +10,20 @@
 namespace xwalk {
 namespace extensions {
 
+namespace {
+
+// Messages without a callback have 0 or an empty string as callback id.
+bool HasCallback(const base::Value& callback_id) {
+  int int_id;
+  if (callback_id.GetAsInteger(&int_id))
+    return int_id != 0;
+
+  std::string string_id;
+  return callback_id.GetAsString(&string_id) && !string_id.empty();
+}
+
+}  // namespace
+
 XWalkExtensionFunctionInfo::XWalkExtensionFunctionInfo(
     const std::string& name,
     scoped_ptr<base::ListValue> arguments,
@@ -46,15 +60,16 @@ void XWalkExtensionFunctionHandler::HandleMessage(scoped_ptr<base::Value> msg) {
 
   // The second parameter stands for callback id, the remaining
   // ones are the function arguments.
-  std::string callback_id;
-  if (!args->GetString(1, &callback_id)) {
-    LOG(WARNING) << "The callback id is not a string.";
+  scoped_ptr<base::Value> callback_id;
+  args->Remove(1, &callback_id);
+  if (!callback_id->IsType(base::Value::TYPE_INTEGER) &&
+      !callback_id->IsType(base::Value::TYPE_STRING)) {
+    LOG(WARNING) << "The callback id is not an integer or a string.";
     return;
   }
 
   // We reuse args to pass the extra arguments to the handler, so remove
-  // function_name and callback_id from it.
-  args->Remove(0, NULL);
+  // function_name from it.
   args->Remove(0, NULL);
 
   scoped_ptr<XWalkExtensionFunctionInfo> info(
@@ -64,7 +79,7 @@ void XWalkExtensionFunctionHandler::HandleMessage(scoped_ptr<base::Value> msg) {
           base::Bind(&XWalkExtensionFunctionHandler::DispatchResult,
                      weak_factory_.GetWeakPtr(),
                      base::MessageLoopProxy::current(),
-                     callback_id)));
+                     base::Owned(callback_id.release()))));
 
   if (!HandleFunction(info.Pass())) {
     DLOG(WARNING) << "Function not registered: " << function_name;
@@ -83,11 +98,21 @@ bool XWalkExtensionFunctionHandler::HandleFunction(
   return true;
 }
 
+const XWalkExtensionFunctionHandler::FunctionHandler*
+XWalkExtensionFunctionHandler::GetHandler(
+    const std::string& function_name) const {
+  FunctionHandlerMap::const_iterator iter = handlers_.find(function_name);
+  if (iter == handlers_.end())
+    return NULL;
+
+  return &iter->second;
+}
+
 // static
 void XWalkExtensionFunctionHandler::DispatchResult(
     const base::WeakPtr<XWalkExtensionFunctionHandler>& handler,
     scoped_refptr<base::MessageLoopProxy> client_task_runner,
-    const std::string& callback_id,
+    const base::Value* callback_id,
     scoped_ptr<base::ListValue> result) {
   DCHECK(result);
 
@@ -96,12 +121,12 @@ void XWalkExtensionFunctionHandler::DispatchResult(
         base::Bind(&XWalkExtensionFunctionHandler::DispatchResult,
                    handler,
                    client_task_runner,
-                   callback_id,
+                   base::Owned(callback_id->DeepCopy()),
                    base::Passed(&result)));
     return;
   }
 
-  if (callback_id.empty()) {
+  if (!HasCallback(*callback_id)) {
     DLOG(WARNING) << "Sending a reply with an empty callback id has no"
         "practical effect. This code can be optimized by not creating "
         "and not posting the result.";
@@ -110,7 +135,7 @@ void XWalkExtensionFunctionHandler::DispatchResult(
 
   // Prepend the callback id to the list, so the handlers
   // on the JavaScript side know which callback should be evoked.
-  result->Insert(0, new base::StringValue(callback_id));
+  result->Insert(0, callback_id->DeepCopy());
 
   if (handler)
     handler->PostMessageToInstance(result.Pass());
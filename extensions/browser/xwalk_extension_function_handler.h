@@ -102,11 +102,17 @@ class XWalkExtensionFunctionHandler {
     handlers_[function_name] = callback;
   }
 
+  // Returns the handler registered for |function_name| or NULL. The pointer
+  // remains valid for the lifetime of this object, so callers invoking the
+  // same function repeatedly can skip the lookup.
+  const FunctionHandler* GetHandler(const std::string& function_name) const;
+
  private:
+  // The |callback_id| is an integer, or a string for older callers.
   static void DispatchResult(
       const base::WeakPtr<XWalkExtensionFunctionHandler>& handler,
       scoped_refptr<base::MessageLoopProxy> client_task_runner,
-      const std::string& callback_id,
+      const base::Value* callback_id,
       scoped_ptr<base::ListValue> result);
 
   void PostMessageToInstance(scoped_ptr<base::Value> msg);
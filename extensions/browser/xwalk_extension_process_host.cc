@@ -125,6 +125,8 @@ XWalkExtensionProcessHost::XWalkExtensionProcessHost(
       runtime_variables_(runtime_variables.Pass()) {
   render_process_host_->GetChannel()->AddFilter(
       render_process_message_filter_.get());
+  if (!runtime_variables_)
+    return;
   BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
       base::Bind(&XWalkExtensionProcessHost::StartProcess,
       base::Unretained(this)));
@@ -217,6 +219,16 @@ void XWalkExtensionProcessHost::StartProcess() {
         external_extensions_path_, runtime_variables_lv));
 }
 
+void XWalkExtensionProcessHost::SetRuntimeVariables(
+    scoped_ptr<base::ValueMap> runtime_variables) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  CHECK(!runtime_variables_);
+  runtime_variables_ = runtime_variables.Pass();
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&XWalkExtensionProcessHost::StartProcess,
+      base::Unretained(this)));
+}
+
 void XWalkExtensionProcessHost::StopProcess() {
   if (process_)
     process_.reset();
@@ -51,12 +51,19 @@ class XWalkExtensionProcessHost
     ~Delegate() {}
   };
 
+  // A NULL |runtime_variables| defers the start of the extension process
+  // until SetRuntimeVariables() is called, e.g. for a render process that
+  // was launched before knowing which application it is going to host.
   XWalkExtensionProcessHost(content::RenderProcessHost* render_process_host,
                             const base::FilePath& external_extensions_path,
                             XWalkExtensionProcessHost::Delegate* delegate,
                             scoped_ptr<base::ValueMap> runtime_variables);
   virtual ~XWalkExtensionProcessHost();
 
+  // Provides the runtime variables of a deferred extension process and
+  // starts it.
+  void SetRuntimeVariables(scoped_ptr<base::ValueMap> runtime_variables);
+
   // IPC::Sender implementation
   bool Send(IPC::Message* msg) override;
 
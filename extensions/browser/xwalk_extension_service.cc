@@ -248,6 +248,10 @@ void XWalkExtensionService::OnRenderProcessHostCreatedInternal(
   if (!cmd_line->HasSwitch(switches::kXWalkDisableExtensionProcess)) {
     CreateExtensionProcessHost(host, data, runtime_variables.Pass());
   } else if (!external_extensions_path_.empty()) {
+    // The in process servers are queried by the render process as soon as it
+    // starts, so registering these extensions cannot be deferred.
+    if (!runtime_variables)
+      runtime_variables.reset(new base::ValueMap);
     RegisterExternalExtensionsInDirectory(
         data->in_process_ui_thread_server(),
         external_extensions_path_, runtime_variables.Pass());
@@ -264,8 +268,9 @@ void XWalkExtensionService::OnRenderProcessWillLaunch(
   CHECK(host);
 
   if (!g_external_extensions_path_for_testing_.empty()) {
-    (*runtime_variables)["runtime_name"] =
-        new base::StringValue("xwalk");
+    if (runtime_variables)
+      (*runtime_variables)["runtime_name"] =
+          new base::StringValue("xwalk");
     OnRenderProcessHostCreatedInternal(host, ui_thread_extensions,
         extension_thread_extensions, runtime_variables.Pass());
     return;
@@ -275,6 +280,23 @@ void XWalkExtensionService::OnRenderProcessWillLaunch(
       extension_thread_extensions, runtime_variables.Pass());
 }
 
+void XWalkExtensionService::SetRuntimeVariables(
+    content::RenderProcessHost* host,
+    scoped_ptr<base::ValueMap> runtime_variables) {
+  RenderProcessToExtensionDataMap::iterator it =
+      extension_data_map_.find(host->GetID());
+  if (it == extension_data_map_.end())
+    return;
+
+  XWalkExtensionProcessHost* eph = it->second->GetExtensionProcessHost();
+  if (!eph)
+    return;
+
+  if (!g_external_extensions_path_for_testing_.empty())
+    (*runtime_variables)["runtime_name"] = new base::StringValue("xwalk");
+  eph->SetRuntimeVariables(runtime_variables.Pass());
+}
+
 // static
 void
 XWalkExtensionService::SetCreateExtensionThreadExtensionsCallbackForTesting(
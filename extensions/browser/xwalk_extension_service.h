@@ -69,12 +69,20 @@ class XWalkExtensionService : public content::NotificationObserver,
   // The vectors contain the extensions to be used for this render process,
   // ownership of these extensions is taken by the XWalkExtensionService. The
   // vectors will be empty after the call.
+  //
+  // A NULL |runtime_variables| defers the start of the extension process
+  // until SetRuntimeVariables() is called for |host|.
   void OnRenderProcessWillLaunch(
       content::RenderProcessHost* host,
       XWalkExtensionVector* ui_thread_extensions,
       XWalkExtensionVector* extension_thread_extensions,
       scoped_ptr<base::ValueMap> runtime_variables);
 
+  // Provides the runtime variables of a render process launched without them
+  // and starts its extension process.
+  void SetRuntimeVariables(content::RenderProcessHost* host,
+                           scoped_ptr<base::ValueMap> runtime_variables);
+
   // To be called when a RenderProcess died, so we can gracefully shutdown the
   // associated ExtensionProcess. See Runtime::RenderProcessGone() and
   // XWalkContentBrowserClient::RenderProcessHostGone().
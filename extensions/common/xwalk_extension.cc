@@ -19,7 +19,9 @@ bool XWalkExtension::PermissionsDelegate::RegisterPermissions(
   return false;
 }
 
-XWalkExtension::XWalkExtension() : permissions_delegate_(NULL) {}
+XWalkExtension::XWalkExtension()
+    : shares_instances_(false),
+      permissions_delegate_(NULL) {}
 
 XWalkExtension::~XWalkExtension() {}
 
@@ -56,6 +56,11 @@ class XWalkExtension {
   // objects outside the namespace that is implicitly created using its name.
   virtual const std::vector<std::string>& entry_points() const;
 
+  // Whether the frames of the same origin in a render process share a single
+  // instance, instead of getting one each. Messages posted by a shared
+  // instance are delivered to all of its frames.
+  bool shares_instances() const { return shares_instances_; }
+
   void set_permissions_delegate(XWalkExtension::PermissionsDelegate* delegate) {
     permissions_delegate_ = delegate;
   }
@@ -73,6 +78,9 @@ class XWalkExtension {
     entry_points_.insert(entry_points_.end(), entry_points.begin(),
                          entry_points.end());
   }
+  void set_shares_instances(bool shares_instances) {
+    shares_instances_ = shares_instances;
+  }
 
  private:
   // Name of extension, used for dispatching messages.
@@ -85,6 +93,8 @@ class XWalkExtension {
 
   std::vector<std::string> entry_points_;
 
+  bool shares_instances_;
+
   // Permission check delegate for both in and out of process extensions.
   PermissionsDelegate* permissions_delegate_;
 
@@ -93,7 +103,7 @@ class XWalkExtension {
 
 // XWalkExtensionInstance represents an instance of a certain extension, which
 // is created per ScriptContext created by Crosswalk (which happens for every
-// frame loaded).
+// frame loaded), or per origin for extensions sharing their instances.
 //
 // XWalkExtensionInstance objects allow us to keep separated state for each
 // execution.
@@ -62,6 +62,7 @@ IPC_STRUCT_BEGIN(XWalkExtensionServerMsg_ExtensionRegisterParams)
   IPC_STRUCT_MEMBER(std::string, name)
   IPC_STRUCT_MEMBER(std::string, js_api)
   IPC_STRUCT_MEMBER(std::vector<std::string>, entry_points)
+  IPC_STRUCT_MEMBER(bool, shares_instances)
 IPC_STRUCT_END()
 
 IPC_MESSAGE_CONTROL2(XWalkExtensionServerMsg_CreateInstance,  // NOLINT(*)
@@ -352,6 +352,7 @@ void XWalkExtensionServer::OnGetExtensions(
     for (const std::string& entry_point : entry_points) {
       extension_parameters.entry_points.push_back(entry_point);
     }
+    extension_parameters.shares_instances = extension->shares_instances();
 
     reply->push_back(extension_parameters);
   }
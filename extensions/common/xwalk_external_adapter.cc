@@ -4,17 +4,20 @@
 
 #include "xwalk/extensions/common/xwalk_external_adapter.h"
 
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/stl_util.h"
+#include "xwalk/extensions/common/xwalk_external_task_runner.h"
 
 namespace xwalk {
 namespace extensions {
 
 XWalkExternalAdapter::XWalkExternalAdapter()
-    : next_xw_extension_(1),
-      next_xw_instance_(1) {}
+    : next_xw_extension_(1) {}
 
-XWalkExternalAdapter::~XWalkExternalAdapter() {}
+XWalkExternalAdapter::~XWalkExternalAdapter() {
+  STLDeleteValues(&buffers_);
+}
 
 XWalkExternalAdapter* XWalkExternalAdapter::GetInstance() {
   return Singleton<XWalkExternalAdapter>::get();
@@ -25,7 +28,9 @@ XW_Extension XWalkExternalAdapter::GetNextXWExtension() {
 }
 
 XW_Instance XWalkExternalAdapter::GetNextXWInstance() {
-  return next_xw_instance_++;
+  XW_Instance xw_instance = instance_table_.Reserve();
+  CHECK(xw_instance);
+  return xw_instance;
 }
 
 void XWalkExternalAdapter::RegisterExtension(
@@ -45,17 +50,31 @@ void XWalkExternalAdapter::UnregisterExtension(
 }
 
 void XWalkExternalAdapter::RegisterInstance(XWalkExternalInstance* context) {
-  XW_Instance xw_instance = context->xw_instance_;
-  CHECK(IsValidXWInstance(xw_instance));
-  CHECK(!ContainsKey(instance_map_, xw_instance));
-  instance_map_[xw_instance] = context;
+  instance_table_.Publish(context->xw_instance_, context);
 }
 
 void XWalkExternalAdapter::UnregisterInstance(XWalkExternalInstance* context) {
-  XW_Instance xw_instance = context->xw_instance_;
-  CHECK(IsValidXWInstance(xw_instance));
-  CHECK(ContainsKey(instance_map_, xw_instance));
-  instance_map_.erase(xw_instance);
+  CHECK(instance_table_.IsValid(context->xw_instance_));
+  instance_table_.Remove(context->xw_instance_);
+}
+
+void* XWalkExternalAdapter::AddBuffer(scoped_ptr<base::BinaryValue> buffer) {
+  void* data = buffer->GetBuffer();
+  base::AutoLock lock(buffers_lock_);
+  DCHECK(!ContainsKey(buffers_, data));
+  buffers_[data] = buffer.release();
+  return data;
+}
+
+scoped_ptr<base::BinaryValue> XWalkExternalAdapter::TakeBuffer(void* data) {
+  base::AutoLock lock(buffers_lock_);
+  BufferMap::iterator it = buffers_.find(data);
+  if (it == buffers_.end())
+    return scoped_ptr<base::BinaryValue>();
+
+  scoped_ptr<base::BinaryValue> buffer(it->second);
+  buffers_.erase(it);
+  return buffer.Pass();
 }
 
 const void* XWalkExternalAdapter::GetInterface(const char* name) {
@@ -79,6 +98,19 @@ const void* XWalkExternalAdapter::GetInterface(const char* name) {
     return &messagingInterface1;
   }
 
+  if (!strcmp(name, XW_MESSAGING_INTERFACE_2)) {
+    static const XW_MessagingInterface_2 messagingInterface2 = {
+      MessagingRegister,
+      MessagingPostMessage,
+      MessagingRegisterBinary,
+      MessagingPostBinaryMessage,
+      MessagingAllocateBuffer,
+      MessagingPostBuffer,
+      MessagingReleaseBuffer
+    };
+    return &messagingInterface2;
+  }
+
   if (!strcmp(name, XW_INTERNAL_SYNC_MESSAGING_INTERFACE_1)) {
     static const XW_Internal_SyncMessagingInterface_1
         syncMessagingInterface1 = {
@@ -95,6 +127,14 @@ const void* XWalkExternalAdapter::GetInterface(const char* name) {
     return &entryPointsInterface1;
   }
 
+  if (!strcmp(name, XW_INTERNAL_ENTRY_POINTS_INTERFACE_2)) {
+    static const XW_Internal_EntryPointsInterface_2 entryPointsInterface2 = {
+      EntryPointsSetExtraJSEntryPoints,
+      EntryPointsSetSharedInstances
+    };
+    return &entryPointsInterface2;
+  }
+
   if (!strcmp(name, XW_INTERNAL_RUNTIME_INTERFACE_1)) {
     static const XW_Internal_RuntimeInterface_1 runtimeInterface1 = {
       RuntimeGetStringVariable
@@ -110,6 +150,16 @@ const void* XWalkExternalAdapter::GetInterface(const char* name) {
     return &permissionsInterface1;
   }
 
+  if (!strcmp(name, XW_INTERNAL_TASK_RUNNER_INTERFACE_1)) {
+    static const XW_Internal_TaskRunnerInterface_1 taskRunnerInterface1 = {
+      TaskRunnerPostInstanceTask,
+      TaskRunnerPostWorkerTask,
+      TaskRunnerWatchFileDescriptor,
+      TaskRunnerStopWatchingFileDescriptor
+    };
+    return &taskRunnerInterface1;
+  }
+
   LOG(WARNING) << "Interface '" << name << "' is not supported.";
   return NULL;
 }
@@ -118,10 +168,6 @@ bool XWalkExternalAdapter::IsValidXWExtension(XW_Extension xw_extension) {
   return xw_extension > 0 && xw_extension < next_xw_extension_;
 }
 
-bool XWalkExternalAdapter::IsValidXWInstance(XW_Instance xw_instance) {
-  return xw_instance > 0 && xw_instance < next_xw_instance_;
-}
-
 XWalkExternalExtension* XWalkExternalAdapter::GetExtension(
     XW_Extension xw_extension) {
   XWalkExternalAdapter* adapter = XWalkExternalAdapter::GetInstance();
@@ -131,15 +177,6 @@ XWalkExternalExtension* XWalkExternalAdapter::GetExtension(
   return it->second;
 }
 
-XWalkExternalInstance* XWalkExternalAdapter::GetInstance(
-    XW_Instance xw_instance) {
-  XWalkExternalAdapter* adapter = XWalkExternalAdapter::GetInstance();
-  InstanceMap::iterator it = adapter->instance_map_.find(xw_instance);
-  if (it == adapter->instance_map_.end())
-    return NULL;
-  return it->second;
-}
-
 // static
 void XWalkExternalAdapter::LogInvalidCall(
     int32_t value, const char* type,
@@ -168,5 +205,94 @@ int XWalkExternalAdapter::PermissionsRegisterPermissions(XW_Extension xw,
   return ptr->RegisterPermissions(perm_table) ? XW_OK : XW_ERROR;
 }
 
+// static
+void* XWalkExternalAdapter::MessagingAllocateBuffer(size_t size) {
+  // Never returns NULL, even for empty buffers.
+  scoped_ptr<char[]> data(new char[size ? size : 1]);
+  return GetInstance()->AddBuffer(
+      make_scoped_ptr(new base::BinaryValue(data.Pass(), size)));
+}
+
+// static
+void XWalkExternalAdapter::MessagingPostBuffer(XW_Instance xw, void* buffer,
+                                               size_t size) {
+  scoped_ptr<base::BinaryValue> value(GetInstance()->TakeBuffer(buffer));
+  if (!value) {
+    LOG(WARNING) << "Ignoring call to Messaging function PostBuffer as it "
+                 << "received a buffer not owned by the extension.";
+    return;
+  }
+  if (size > value->GetSize()) {
+    LOG(WARNING) << "Ignoring call to Messaging function PostBuffer as it "
+                 << "received a size bigger than the buffer.";
+    return;
+  }
+
+  // Only a shorter message needs a copy, binary values can't be truncated.
+  if (size < value->GetSize()) {
+    value.reset(base::BinaryValue::CreateWithCopiedBuffer(
+        value->GetBuffer(), size));
+  }
+
+  ScopedInstance scoped(xw);
+  XWalkExternalInstance* ptr = scoped.get();
+  if (!ptr) {
+    LogInvalidCall(xw, "Instance", "Messaging", "PostBuffer");
+    return;
+  }
+  ptr->MessagingPostBuffer(value.Pass());
+}
+
+// static
+void XWalkExternalAdapter::MessagingReleaseBuffer(void* buffer) {
+  if (!GetInstance()->TakeBuffer(buffer)) {
+    LOG(WARNING) << "Ignoring call to Messaging function ReleaseBuffer as it "
+                 << "received a buffer not owned by the extension.";
+  }
+}
+
+int XWalkExternalAdapter::TaskRunnerPostInstanceTask(XW_Instance xw,
+    XW_TaskCallback callback, void* user_data, int64_t delay_ms) {
+  ScopedInstance scoped(xw);
+  XWalkExternalInstance* ptr = scoped.get();
+  if (!ptr) {
+    LogInvalidCall(xw, "Instance", "TaskRunner", "PostInstanceTask");
+    return XW_ERROR;
+  }
+  if (!callback || delay_ms < 0)
+    return XW_ERROR;
+  return ptr->TaskRunnerPostInstanceTask(callback, user_data, delay_ms) ?
+      XW_OK : XW_ERROR;
+}
+
+int XWalkExternalAdapter::TaskRunnerPostWorkerTask(XW_Extension xw,
+    XW_TaskCallback callback, void* user_data, int64_t delay_ms) {
+  // Only checks the range of |xw|, the extension map is not safe to use from
+  // the worker threads the extension may call this from.
+  if (!GetInstance()->IsValidXWExtension(xw)) {
+    LogInvalidCall(xw, "Extension", "TaskRunner", "PostWorkerTask");
+    return XW_ERROR;
+  }
+  if (!callback || delay_ms < 0)
+    return XW_ERROR;
+  return XWalkExternalTaskRunner::GetInstance()->PostWorkerTask(
+      base::Bind(callback, user_data),
+      base::TimeDelta::FromMilliseconds(delay_ms)) ? XW_OK : XW_ERROR;
+}
+
+XW_FileDescriptorWatch XWalkExternalAdapter::TaskRunnerWatchFileDescriptor(
+    XW_Instance xw, int fd, int events, XW_FileDescriptorCallback callback,
+    void* user_data) {
+  ScopedInstance scoped(xw);
+  XWalkExternalInstance* ptr = scoped.get();
+  if (!ptr) {
+    LogInvalidCall(xw, "Instance", "TaskRunner", "WatchFileDescriptor");
+    return 0;
+  }
+  if (!callback)
+    return 0;
+  return ptr->TaskRunnerWatchFileDescriptor(fd, events, callback, user_data);
+}
+
 }  // namespace extensions
 }  // namespace xwalk
@@ -6,14 +6,19 @@
 #define XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_ADAPTER_H_
 
 #include <map>
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/singleton.h"
+#include "base/synchronization/lock.h"
+#include "base/values.h"
 #include "xwalk/extensions/public/XW_Extension.h"
 #include "xwalk/extensions/public/XW_Extension_SyncMessage.h"
 #include "xwalk/extensions/public/XW_Extension_EntryPoints.h"
 #include "xwalk/extensions/public/XW_Extension_Permissions.h"
 #include "xwalk/extensions/public/XW_Extension_Runtime.h"
+#include "xwalk/extensions/public/XW_Extension_TaskRunner.h"
 #include "xwalk/extensions/common/xwalk_external_extension.h"
 #include "xwalk/extensions/common/xwalk_external_instance.h"
+#include "xwalk/extensions/common/xwalk_handle_table.h"
 
 // NOTE: Those macros define functions that are used in the structs by
 // GetInterface(). They dispatch the function to the appropriate
@@ -21,7 +26,8 @@
 
 #define DEFINE_FUNCTION_1(TYPE, INTERFACE, NAME, ARG1)          \
   static void INTERFACE ## NAME(XW_ ## TYPE xw, ARG1 arg1) {    \
-    XWalkExternal ## TYPE * ptr = Get ## TYPE(xw);              \
+    Scoped ## TYPE scoped(xw);                                  \
+    XWalkExternal ## TYPE * ptr = scoped.get();                 \
     if (!ptr)                                                   \
       LogInvalidCall(xw, #TYPE, #INTERFACE, #NAME);             \
     else                                                        \
@@ -30,7 +36,8 @@
 
 #define DEFINE_FUNCTION_2(TYPE, INTERFACE, NAME, ARG1, ARG2)             \
   static void INTERFACE ## NAME(XW_ ## TYPE xw, ARG1 arg1, ARG2 arg2) {  \
-    XWalkExternal ## TYPE * ptr = Get ## TYPE(xw);                       \
+    Scoped ## TYPE scoped(xw);                                           \
+    XWalkExternal ## TYPE * ptr = scoped.get();                          \
     if (!ptr)                                                            \
       LogInvalidCall(xw, #TYPE, #INTERFACE, #NAME);                      \
     else                                                                 \
@@ -39,7 +46,8 @@
 
 #define DEFINE_FUNCTION_3(TYPE, INTERFACE, NAME, A1, A2, A3)           \
   static void INTERFACE ## NAME(XW_ ## TYPE xw, A1 a1, A2 a2, A3 a3) { \
-    XWalkExternal ## TYPE * ptr = Get ## TYPE(xw);                     \
+    Scoped ## TYPE scoped(xw);                                         \
+    XWalkExternal ## TYPE * ptr = scoped.get();                        \
     if (ptr)                                                           \
       ptr->INTERFACE ## NAME(a1, a2, a3);                              \
     else                                                               \
@@ -48,7 +56,8 @@
 
 #define DEFINE_RET_FUNCTION_0(TYPE, INTERFACE, NAME, RET_ARG)   \
   static RET_ARG INTERFACE ## NAME(XW_ ## TYPE xw) {            \
-    XWalkExternal ## TYPE * ptr = Get ## TYPE(xw);              \
+    Scoped ## TYPE scoped(xw);                                  \
+    XWalkExternal ## TYPE * ptr = scoped.get();                 \
     if (ptr)                                                    \
       return ptr->INTERFACE ## NAME();                          \
     LogInvalidCall(xw, #TYPE, #INTERFACE, #NAME);               \
@@ -80,10 +89,19 @@ class XWalkExternalAdapter {
   void UnregisterExtension(XWalkExternalExtension* extension);
 
   // This adds the context to the adapter's mapping, so C calls to
-  // its corresponding XW_Instance are correctly dispatched.
+  // its corresponding XW_Instance are correctly dispatched. C calls can
+  // come from any thread, UnregisterInstance() waits for the ones in
+  // progress on the context to return.
   void RegisterInstance(XWalkExternalInstance* context);
   void UnregisterInstance(XWalkExternalInstance* context);
 
+  // Buffers owned by the extensions for XW_MessagingInterface_2 are binary
+  // values kept by the adapter, so they can be posted without copying.
+  // AddBuffer() returns the data of |buffer| for the extension, and
+  // TakeBuffer() returns NULL for data not owned by the extensions.
+  void* AddBuffer(scoped_ptr<base::BinaryValue> buffer);
+  scoped_ptr<base::BinaryValue> TakeBuffer(void* data);
+
   // Returns the correct struct according to interface asked. This is
   // passed to external extensions in XW_Initialize() call.
   static const void* GetInterface(const char* name);
@@ -95,12 +113,36 @@ class XWalkExternalAdapter {
   ~XWalkExternalAdapter();
 
   bool IsValidXWExtension(XW_Extension xw_extension);
-  bool IsValidXWInstance(XW_Instance xw_instance);
 
   // Used by the DEFINE_* macros to bridge the calls using C API identifiers
-  // XW_Extension and XW_Instance to the right C++ object.
+  // XW_Extension and XW_Instance to the right C++ object, for the duration
+  // of the call.
   static XWalkExternalExtension* GetExtension(XW_Extension xw_extension);
-  static XWalkExternalInstance* GetInstance(XW_Instance xw_instance);
+
+  class ScopedExtension {
+   public:
+    explicit ScopedExtension(XW_Extension xw_extension)
+        : extension_(GetExtension(xw_extension)) {}
+
+    XWalkExternalExtension* get() const { return extension_; }
+
+   private:
+    XWalkExternalExtension* extension_;
+  };
+
+  typedef XWalkHandleTable<XWalkExternalInstance> InstanceTable;
+
+  class ScopedInstance {
+   public:
+    explicit ScopedInstance(XW_Instance xw_instance)
+        : lookup_(&XWalkExternalAdapter::GetInstance()->instance_table_,
+                  xw_instance) {}
+
+    XWalkExternalInstance* get() const { return lookup_.get(); }
+
+   private:
+    InstanceTable::ScopedLookup lookup_;
+  };
   static void LogInvalidCall(int32_t value, const char* type,
                              const char* interface, const char* function);
 
@@ -115,6 +157,7 @@ class XWalkExternalAdapter {
   DEFINE_RET_FUNCTION_0(Instance, Core, GetInstanceData, void*);
   DEFINE_FUNCTION_1(Extension, EntryPoints,
                     SetExtraJSEntryPoints, const char**);
+  DEFINE_FUNCTION_1(Extension, EntryPoints, SetSharedInstances, int);
 
   // XW_Internal_PermissionsInterface_1 from XW_Extension_Permissions.h
   static int PermissionsCheckAPIAccessControl(XW_Extension xw,
@@ -126,6 +169,15 @@ class XWalkExternalAdapter {
   DEFINE_FUNCTION_1(Extension, Messaging, Register, XW_HandleMessageCallback);
   DEFINE_FUNCTION_1(Instance, Messaging, PostMessage, const char*);
 
+  // XW_MessagingInterface_2 from XW_Extension.h.
+  DEFINE_FUNCTION_1(Extension, Messaging, RegisterBinary,
+                    XW_HandleBinaryMessageCallback);
+  DEFINE_FUNCTION_2(Instance, Messaging, PostBinaryMessage, const void*,
+                    size_t);
+  static void* MessagingAllocateBuffer(size_t size);
+  static void MessagingPostBuffer(XW_Instance xw, void* buffer, size_t size);
+  static void MessagingReleaseBuffer(void* buffer);
+
   // XW_Internal_SyncMessaging_1 from XW_Extension_SyncMessage.h.
   DEFINE_FUNCTION_1(Extension, SyncMessaging, Register,
                     XW_HandleSyncMessageCallback);
@@ -135,14 +187,30 @@ class XWalkExternalAdapter {
   DEFINE_FUNCTION_3(Extension, Runtime, GetStringVariable, const char *,
                     char*, size_t);
 
+  // XW_Internal_TaskRunnerInterface_1 from XW_Extension_TaskRunner.h
+  static int TaskRunnerPostInstanceTask(XW_Instance xw,
+      XW_TaskCallback callback, void* user_data, int64_t delay_ms);
+  static int TaskRunnerPostWorkerTask(XW_Extension xw,
+      XW_TaskCallback callback, void* user_data, int64_t delay_ms);
+  static XW_FileDescriptorWatch TaskRunnerWatchFileDescriptor(XW_Instance xw,
+      int fd, int events, XW_FileDescriptorCallback callback,
+      void* user_data);
+  DEFINE_FUNCTION_1(Instance, TaskRunner, StopWatchingFileDescriptor,
+                    XW_FileDescriptorWatch);
+
   typedef std::map<XW_Extension, XWalkExternalExtension*> ExtensionMap;
   ExtensionMap extension_map_;
 
-  typedef std::map<XW_Instance, XWalkExternalInstance*> InstanceMap;
-  InstanceMap instance_map_;
+  // Instances are looked up from the threads of the extensions, without
+  // taking a lock.
+  InstanceTable instance_table_;
 
   XW_Extension next_xw_extension_;
-  XW_Instance next_xw_instance_;
+
+  // Buffers owned by the extensions, by their data.
+  typedef std::map<void*, base::BinaryValue*> BufferMap;
+  base::Lock buffers_lock_;
+  BufferMap buffers_;
 
   DISALLOW_COPY_AND_ASSIGN(XWalkExternalAdapter);
 };
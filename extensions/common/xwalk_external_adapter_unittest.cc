@@ -0,0 +1,146 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/common/xwalk_external_adapter.h"
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop/message_loop.h"
+#include "base/threading/simple_thread.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/extensions/common/xwalk_external_extension.h"
+#include "xwalk/extensions/common/xwalk_external_instance.h"
+#include "xwalk/extensions/public/XW_Extension.h"
+
+using xwalk::extensions::XWalkExternalAdapter;
+using xwalk::extensions::XWalkExternalExtension;
+using xwalk::extensions::XWalkExternalInstance;
+
+namespace {
+
+const int kPosterThreads = 8;
+const int kLiveInstances = 16;
+const int kChurnIterations = 5000;
+
+// Receives the messages posted to an instance, which must still be alive.
+struct MessageSink {
+  MessageSink() : alive(1), messages(0) {}
+
+  base::subtle::Atomic32 alive;
+  base::subtle::Atomic32 messages;
+};
+
+void OnMessagePosted(MessageSink* sink, base::subtle::Atomic32* dead_sinks,
+                     scoped_ptr<base::Value> msg) {
+  if (!base::subtle::Acquire_Load(&sink->alive))
+    base::subtle::NoBarrier_AtomicIncrement(dead_sinks, 1);
+  base::subtle::NoBarrier_AtomicIncrement(&sink->messages, 1);
+}
+
+// Posts messages through the C API to the instances published by the main
+// thread, as fast as it can.
+class Poster : public base::DelegateSimpleThread::Delegate {
+ public:
+  Poster(const XW_MessagingInterface_1* messaging,
+         base::subtle::Atomic32* handles, base::subtle::Atomic32* done)
+      : messaging_(messaging),
+        handles_(handles),
+        done_(done) {}
+
+  void Run() override {
+    for (int i = 0; !base::subtle::Acquire_Load(done_); ++i) {
+      XW_Instance instance =
+          base::subtle::Acquire_Load(&handles_[i % kLiveInstances]);
+      messaging_->PostMessage(instance, "message");
+    }
+  }
+
+ private:
+  const XW_MessagingInterface_1* messaging_;
+  base::subtle::Atomic32* handles_;
+  base::subtle::Atomic32* done_;
+};
+
+}  // namespace
+
+// Instances are created and destroyed while other threads post messages to
+// them, the way extensions do from their own threads. A message must never
+// reach an instance that was destroyed.
+TEST(XWalkExternalAdapterTest, ConcurrentPostMessage) {
+  base::MessageLoop message_loop;
+  XWalkExternalAdapter* adapter = XWalkExternalAdapter::GetInstance();
+  const XW_MessagingInterface_1* messaging =
+      static_cast<const XW_MessagingInterface_1*>(
+          XWalkExternalAdapter::GetInterface(XW_MESSAGING_INTERFACE_1));
+  ASSERT_TRUE(messaging);
+
+  // Not loaded, the instances don't call into any library.
+  XWalkExternalExtension extension(base::FilePath(FILE_PATH_LITERAL("none")));
+
+  base::subtle::Atomic32 dead_sinks = 0;
+  base::subtle::Atomic32 done = 0;
+  base::subtle::Atomic32 handles[kLiveInstances];
+  XWalkExternalInstance* instances[kLiveInstances];
+  MessageSink* sinks[kLiveInstances];
+
+  // The callback is set before the handle is given to the posting threads.
+  for (int i = 0; i < kLiveInstances; ++i) {
+    sinks[i] = new MessageSink;
+    handles[i] = adapter->GetNextXWInstance();
+    instances[i] = new XWalkExternalInstance(&extension, handles[i]);
+    instances[i]->SetPostMessageCallback(
+        base::Bind(&OnMessagePosted, sinks[i], &dead_sinks));
+  }
+
+  ScopedVector<Poster> posters;
+  ScopedVector<base::DelegateSimpleThread> threads;
+  for (int i = 0; i < kPosterThreads; ++i) {
+    posters.push_back(new Poster(messaging, handles, &done));
+    threads.push_back(new base::DelegateSimpleThread(posters.back(),
+                                                     "ExternalPoster"));
+    threads.back()->Start();
+  }
+
+  // The calls in progress on an instance are over once it is destroyed, so
+  // its sink can be marked as dead and freed.
+  int messages = 0;
+  for (int i = 0; i < kChurnIterations; ++i) {
+    int index = i % kLiveInstances;
+    MessageSink* sink = new MessageSink;
+    XW_Instance handle = adapter->GetNextXWInstance();
+    XWalkExternalInstance* instance =
+        new XWalkExternalInstance(&extension, handle);
+    instance->SetPostMessageCallback(
+        base::Bind(&OnMessagePosted, sink, &dead_sinks));
+    base::subtle::Release_Store(&handles[index], handle);
+
+    delete instances[index];
+    base::subtle::Release_Store(&sinks[index]->alive, 0);
+    messages += base::subtle::Acquire_Load(&sinks[index]->messages);
+    delete sinks[index];
+
+    instances[index] = instance;
+    sinks[index] = sink;
+  }
+
+  base::subtle::Release_Store(&done, 1);
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i]->Join();
+
+  for (int i = 0; i < kLiveInstances; ++i) {
+    delete instances[i];
+    messages += base::subtle::Acquire_Load(&sinks[i]->messages);
+    delete sinks[i];
+  }
+
+  EXPECT_EQ(0, base::subtle::Acquire_Load(&dead_sinks));
+  EXPECT_GT(messages, 0);
+
+  // Destroyed instances are not resolved anymore.
+  messaging->PostMessage(handles[0], "message");
+  EXPECT_EQ(0, base::subtle::Acquire_Load(&dead_sinks));
+}
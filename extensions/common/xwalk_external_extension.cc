@@ -22,6 +22,7 @@ XWalkExternalExtension::XWalkExternalExtension(const base::FilePath& path)
       destroyed_instance_callback_(NULL),
       shutdown_callback_(NULL),
       handle_msg_callback_(NULL),
+      handle_binary_msg_callback_(NULL),
       handle_sync_msg_callback_(NULL),
       initialized_(false),
       library_path_(path) {
@@ -119,6 +120,12 @@ void XWalkExternalExtension::MessagingRegister(
   handle_msg_callback_ = callback;
 }
 
+void XWalkExternalExtension::MessagingRegisterBinary(
+    XW_HandleBinaryMessageCallback callback) {
+  RETURN_IF_INITIALIZED("RegisterBinary from MessagingInterface");
+  handle_binary_msg_callback_ = callback;
+}
+
 void XWalkExternalExtension::SyncMessagingRegister(
     XW_HandleSyncMessageCallback callback) {
   RETURN_IF_INITIALIZED("Register from Internal_SyncMessagingInterface");
@@ -138,6 +145,11 @@ void XWalkExternalExtension::EntryPointsSetExtraJSEntryPoints(
   set_entry_points(entries);
 }
 
+void XWalkExternalExtension::EntryPointsSetSharedInstances(int shared) {
+  RETURN_IF_INITIALIZED("SetSharedInstances from EntryPoints");
+  set_shares_instances(shared != 0);
+}
+
 void XWalkExternalExtension::RuntimeGetStringVariable(const char* key,
     char* value, size_t value_len) {
   const base::ValueMap::const_iterator it = runtime_variables_.find(key);
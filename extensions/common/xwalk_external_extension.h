@@ -61,10 +61,14 @@ class XWalkExternalExtension : public XWalkExtension {
       XW_DestroyedInstanceCallback destroyed_callback);
   void CoreRegisterShutdownCallback(XW_ShutdownCallback callback);
   void EntryPointsSetExtraJSEntryPoints(const char** entry_points);
+  void EntryPointsSetSharedInstances(int shared);
 
   // XW_MessagingInterface_1 (from XW_Extension.h) implementation.
   void MessagingRegister(XW_HandleMessageCallback callback);
 
+  // XW_MessagingInterface_2 (from XW_Extension.h) implementation.
+  void MessagingRegisterBinary(XW_HandleBinaryMessageCallback callback);
+
   // XW_Internal_SyncMessagingInterface_1 (from XW_Extension.h) implementation.
   void SyncMessagingRegister(XW_HandleSyncMessageCallback callback);
 
@@ -79,6 +83,7 @@ class XWalkExternalExtension : public XWalkExtension {
   XW_DestroyedInstanceCallback destroyed_instance_callback_;
   XW_ShutdownCallback shutdown_callback_;
   XW_HandleMessageCallback handle_msg_callback_;
+  XW_HandleBinaryMessageCallback handle_binary_msg_callback_;
   XW_HandleSyncMessageCallback handle_sync_msg_callback_;
 
   bool initialized_;
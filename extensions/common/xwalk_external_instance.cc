@@ -5,9 +5,14 @@
 #include "xwalk/extensions/common/xwalk_external_instance.h"
 
 #include <string>
+#include "base/bind.h"
+#include "base/location.h"
 #include "base/logging.h"
+#include "base/single_thread_task_runner.h"
+#include "base/thread_task_runner_handle.h"
 #include "xwalk/extensions/common/xwalk_external_extension.h"
 #include "xwalk/extensions/common/xwalk_external_adapter.h"
+#include "xwalk/extensions/common/xwalk_external_task_runner.h"
 
 namespace xwalk {
 namespace extensions {
@@ -17,7 +22,10 @@ XWalkExternalInstance::XWalkExternalInstance(
     : xw_instance_(xw_instance),
       extension_(extension),
       instance_data_(NULL),
-      is_handling_sync_msg_(false) {
+      is_handling_sync_msg_(false),
+      task_runner_(base::ThreadTaskRunnerHandle::Get()),
+      weak_factory_(this) {
+  weak_this_ = weak_factory_.GetWeakPtr();
   XWalkExternalAdapter::GetInstance()->RegisterInstance(this);
   XW_CreatedInstanceCallback callback = extension_->created_instance_callback_;
   if (callback)
@@ -30,9 +38,22 @@ XWalkExternalInstance::~XWalkExternalInstance() {
   if (callback)
     callback(xw_instance_);
   XWalkExternalAdapter::GetInstance()->UnregisterInstance(this);
+
+  // No calls can be in progress anymore, so no watch can be added.
+  XWalkExternalTaskRunner* runner = XWalkExternalTaskRunner::GetInstance();
+  for (std::set<XW_FileDescriptorWatch>::iterator it = watches_.begin();
+       it != watches_.end(); ++it) {
+    runner->StopWatchingFileDescriptor(*it);
+  }
 }
 
 void XWalkExternalInstance::HandleMessage(scoped_ptr<base::Value> msg) {
+  if (msg->IsType(base::Value::TYPE_BINARY)) {
+    HandleBinaryMessage(make_scoped_ptr(
+        static_cast<base::BinaryValue*>(msg.release())));
+    return;
+  }
+
   XW_HandleMessageCallback callback = extension_->handle_msg_callback_;
   if (!callback) {
     LOG(WARNING) << "Ignoring message sent for external extension '"
@@ -48,6 +69,22 @@ void XWalkExternalInstance::HandleMessage(scoped_ptr<base::Value> msg) {
   callback(xw_instance_, string_msg.c_str());
 }
 
+void XWalkExternalInstance::HandleBinaryMessage(
+    scoped_ptr<base::BinaryValue> msg) {
+  XW_HandleBinaryMessageCallback callback =
+      extension_->handle_binary_msg_callback_;
+  if (!callback) {
+    LOG(WARNING) << "Ignoring binary message sent for external extension '"
+                 << extension_->name() << "' which doesn't support it.";
+    return;
+  }
+
+  // The extension takes the buffer of the message, see AddBuffer().
+  size_t size = msg->GetSize();
+  void* data = XWalkExternalAdapter::GetInstance()->AddBuffer(msg.Pass());
+  callback(xw_instance_, data, size);
+}
+
 void XWalkExternalInstance::HandleSyncMessage(scoped_ptr<base::Value> msg) {
   XW_HandleSyncMessageCallback callback = extension_->handle_sync_msg_callback_;
   if (!callback) {
@@ -77,9 +114,69 @@ void XWalkExternalInstance::MessagingPostMessage(const char* msg) {
   PostMessageToJS(scoped_ptr<base::Value>(new base::StringValue(msg)));
 }
 
+void XWalkExternalInstance::MessagingPostBinaryMessage(const void* data,
+                                                       size_t size) {
+  PostMessageToJS(scoped_ptr<base::Value>(
+      base::BinaryValue::CreateWithCopiedBuffer(
+          static_cast<const char*>(data), size)));
+}
+
+void XWalkExternalInstance::MessagingPostBuffer(
+    scoped_ptr<base::BinaryValue> buffer) {
+  PostMessageToJS(buffer.PassAs<base::Value>());
+}
+
 void XWalkExternalInstance::SyncMessagingSetSyncReply(const char* reply) {
   SendSyncReplyToJS(scoped_ptr<base::Value>(new base::StringValue(reply)));
 }
 
+bool XWalkExternalInstance::TaskRunnerPostInstanceTask(
+    XW_TaskCallback callback, void* user_data, int64_t delay_ms) {
+  return task_runner_->PostDelayedTask(FROM_HERE,
+      base::Bind(&XWalkExternalInstance::RunInstanceTask, weak_this_,
+                 callback, user_data),
+      base::TimeDelta::FromMilliseconds(delay_ms));
+}
+
+XW_FileDescriptorWatch XWalkExternalInstance::TaskRunnerWatchFileDescriptor(
+    int fd, int events, XW_FileDescriptorCallback callback, void* user_data) {
+  XW_FileDescriptorWatch watch =
+      XWalkExternalTaskRunner::GetInstance()->WatchFileDescriptor(
+          fd, events, task_runner_,
+          base::Bind(&XWalkExternalInstance::RunFileDescriptorCallback,
+                     weak_this_, callback, user_data));
+  if (!watch)
+    return 0;
+
+  base::AutoLock lock(watches_lock_);
+  watches_.insert(watch);
+  return watch;
+}
+
+void XWalkExternalInstance::TaskRunnerStopWatchingFileDescriptor(
+    XW_FileDescriptorWatch watch) {
+  {
+    base::AutoLock lock(watches_lock_);
+    if (!watches_.erase(watch)) {
+      LOG(WARNING) << "Ignoring unknown file descriptor watch " << watch
+                   << " for external extension '" << extension_->name()
+                   << "'.";
+      return;
+    }
+  }
+
+  XWalkExternalTaskRunner::GetInstance()->StopWatchingFileDescriptor(watch);
+}
+
+void XWalkExternalInstance::RunInstanceTask(XW_TaskCallback callback,
+                                            void* user_data) {
+  callback(user_data);
+}
+
+void XWalkExternalInstance::RunFileDescriptorCallback(
+    XW_FileDescriptorCallback callback, void* user_data, int fd, int events) {
+  callback(xw_instance_, fd, events, user_data);
+}
+
 }  // namespace extensions
 }  // namespace xwalk
@@ -5,10 +5,19 @@
 #ifndef XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_INSTANCE_H_
 #define XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_INSTANCE_H_
 
+#include <set>
 #include <string>
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/synchronization/lock.h"
 #include "xwalk/extensions/common/xwalk_extension.h"
 #include "xwalk/extensions/public/XW_Extension.h"
 #include "xwalk/extensions/public/XW_Extension_SyncMessage.h"
+#include "xwalk/extensions/public/XW_Extension_TaskRunner.h"
+
+namespace base {
+class SingleThreadTaskRunner;
+}
 
 namespace xwalk {
 namespace extensions {
@@ -43,16 +52,49 @@ class XWalkExternalInstance : public XWalkExtensionInstance {
   // XW_MessagingInterface_1 (from XW_Extension.h) implementation.
   void MessagingPostMessage(const char* msg);
 
+  // XW_MessagingInterface_2 (from XW_Extension.h) implementation.
+  void MessagingPostBinaryMessage(const void* data, size_t size);
+  void MessagingPostBuffer(scoped_ptr<base::BinaryValue> buffer);
+
+  void HandleBinaryMessage(scoped_ptr<base::BinaryValue> msg);
+
   // XW_Internal_SyncMessagingInterface_1 (from XW_Extension_SyncMessage.h)
   // implementation.
   void SyncMessagingSetSyncReply(const char* reply);
 
+  // XW_Internal_TaskRunnerInterface_1 (from XW_Extension_TaskRunner.h)
+  // implementation. Unlike the other functions, these can be called from any
+  // thread, and the callbacks are run on the thread of the instance.
+  bool TaskRunnerPostInstanceTask(XW_TaskCallback callback, void* user_data,
+                                  int64_t delay_ms);
+  XW_FileDescriptorWatch TaskRunnerWatchFileDescriptor(
+      int fd, int events, XW_FileDescriptorCallback callback, void* user_data);
+  void TaskRunnerStopWatchingFileDescriptor(XW_FileDescriptorWatch watch);
+
+  void RunInstanceTask(XW_TaskCallback callback, void* user_data);
+  void RunFileDescriptorCallback(XW_FileDescriptorCallback callback,
+                                 void* user_data, int fd, int events);
+
   XW_Instance xw_instance_;
   std::string sync_reply_;
   XWalkExternalExtension* extension_;
   void* instance_data_;
   bool is_handling_sync_msg_;
 
+  // The thread the instance lives on, where the tasks posted by the
+  // extension run.
+  scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
+
+  // Watches not stopped by the extension are stopped with the instance.
+  base::Lock watches_lock_;
+  std::set<XW_FileDescriptorWatch> watches_;
+
+  // Bound to the tasks posted to |task_runner_|, which are dropped if the
+  // instance is gone. Created up front since tasks can be posted from other
+  // threads.
+  base::WeakPtrFactory<XWalkExternalInstance> weak_factory_;
+  base::WeakPtr<XWalkExternalInstance> weak_this_;
+
   DISALLOW_COPY_AND_ASSIGN(XWalkExternalInstance);
 };
 
@@ -0,0 +1,242 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/common/xwalk_external_task_runner.h"
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/singleton.h"
+#include "base/message_loop/message_loop.h"
+#include "base/single_thread_task_runner.h"
+#include "base/threading/sequenced_worker_pool.h"
+#include "base/threading/thread.h"
+#include "xwalk/extensions/public/XW_Extension.h"
+#include "xwalk/extensions/public/XW_Extension_TaskRunner.h"
+
+namespace xwalk {
+namespace extensions {
+
+namespace {
+
+// Shared by all the extensions of the process, so a few threads are enough
+// for the short tasks extensions are expected to post.
+const size_t kMaxWorkerThreads = 4;
+
+}  // namespace
+
+#if defined(OS_POSIX)
+// Lives on the IO loop, except for the callbacks which are posted to the
+// task runner of the watch. Watches are not persistent, so a file descriptor
+// that stays ready doesn't flood the task runner: the watch is resumed once
+// the callback has run. The events ready at once are passed to a single
+// callback, and a file descriptor that can't be watched ends the watch with
+// XW_FILE_DESCRIPTOR_ERROR.
+class XWalkExternalTaskRunner::Watcher
+    : public base::RefCountedThreadSafe<Watcher>,
+      public base::MessagePumpLibevent::Watcher {
+ public:
+  Watcher(int fd,
+          int events,
+          const scoped_refptr<base::SingleThreadTaskRunner>& io_task_runner,
+          const scoped_refptr<base::SingleThreadTaskRunner>& task_runner,
+          const FileDescriptorCallback& callback)
+      : fd_(fd),
+        events_(events),
+        io_task_runner_(io_task_runner),
+        task_runner_(task_runner),
+        callback_(callback),
+        ready_events_(0),
+        stopped_(false) {}
+
+  void Start() {
+    io_task_runner_->PostTask(FROM_HERE,
+        base::Bind(&Watcher::StartOnIOThread, this));
+  }
+
+  void Stop() {
+    {
+      base::AutoLock lock(lock_);
+      stopped_ = true;
+    }
+    io_task_runner_->PostTask(FROM_HERE,
+        base::Bind(&Watcher::StopOnIOThread, this));
+  }
+
+  // base::MessagePumpLibevent::Watcher implementation.
+  void OnFileCanReadWithoutBlocking(int fd) override {
+    AddReadyEvents(XW_FILE_DESCRIPTOR_READ);
+  }
+
+  void OnFileCanWriteWithoutBlocking(int fd) override {
+    AddReadyEvents(XW_FILE_DESCRIPTOR_WRITE);
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<Watcher>;
+
+  ~Watcher() override {}
+
+  bool IsStopped() {
+    base::AutoLock lock(lock_);
+    return stopped_;
+  }
+
+  void StartOnIOThread() {
+    if (IsStopped())
+      return;
+
+    base::MessageLoopForIO::Mode mode = base::MessageLoopForIO::WATCH_READ;
+    if (events_ == XW_FILE_DESCRIPTOR_WRITE)
+      mode = base::MessageLoopForIO::WATCH_WRITE;
+    else if (events_ == (XW_FILE_DESCRIPTOR_READ | XW_FILE_DESCRIPTOR_WRITE))
+      mode = base::MessageLoopForIO::WATCH_READ_WRITE;
+
+    if (!controller_)
+      controller_.reset(new base::MessagePumpLibevent::FileDescriptorWatcher);
+
+    if (!base::MessageLoopForIO::current()->WatchFileDescriptor(
+            fd_, false, mode, controller_.get(), this)) {
+      LOG(WARNING) << "Failed to watch the file descriptor " << fd_ << ".";
+      task_runner_->PostTask(FROM_HERE,
+          base::Bind(&Watcher::RunCallback, this, XW_FILE_DESCRIPTOR_ERROR));
+    }
+  }
+
+  // Both events of a wakeup are reported one after the other by the pump,
+  // so they are gathered until the notification is over.
+  void AddReadyEvents(int events) {
+    if (!ready_events_) {
+      io_task_runner_->PostTask(FROM_HERE,
+          base::Bind(&Watcher::PostCallbackOnIOThread, this));
+    }
+    ready_events_ |= events;
+  }
+
+  void PostCallbackOnIOThread() {
+    task_runner_->PostTask(FROM_HERE,
+        base::Bind(&Watcher::RunCallback, this, ready_events_));
+    ready_events_ = 0;
+  }
+
+  void StopOnIOThread() {
+    // The controller must be destroyed on the IO loop.
+    controller_.reset();
+  }
+
+  void RunCallback(int events) {
+    if (IsStopped())
+      return;
+
+    callback_.Run(fd_, events);
+    if (events != XW_FILE_DESCRIPTOR_ERROR)
+      Start();
+  }
+
+  const int fd_;
+  const int events_;
+  scoped_refptr<base::SingleThreadTaskRunner> io_task_runner_;
+  scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
+  FileDescriptorCallback callback_;
+
+  // Only used on the IO loop.
+  scoped_ptr<base::MessagePumpLibevent::FileDescriptorWatcher> controller_;
+  int ready_events_;
+
+  base::Lock lock_;
+  bool stopped_;
+
+  DISALLOW_COPY_AND_ASSIGN(Watcher);
+};
+#else
+class XWalkExternalTaskRunner::Watcher
+    : public base::RefCountedThreadSafe<Watcher> {
+ public:
+  void Stop() {}
+
+ private:
+  friend class base::RefCountedThreadSafe<Watcher>;
+  ~Watcher() {}
+};
+#endif
+
+XWalkExternalTaskRunner::XWalkExternalTaskRunner()
+    : worker_pool_(new base::SequencedWorkerPool(kMaxWorkerThreads,
+                                                 "XWalkExtensionWorker")),
+      next_watch_(1) {}
+
+XWalkExternalTaskRunner::~XWalkExternalTaskRunner() {}
+
+// static
+XWalkExternalTaskRunner* XWalkExternalTaskRunner::GetInstance() {
+  // Leaky, so tasks and watches can still run while the process exits.
+  return Singleton<XWalkExternalTaskRunner,
+                   LeakySingletonTraits<XWalkExternalTaskRunner> >::get();
+}
+
+void XWalkExternalTaskRunner::SetIOTaskRunner(
+    const scoped_refptr<base::SingleThreadTaskRunner>& io_task_runner) {
+  base::AutoLock lock(lock_);
+  DCHECK(!io_task_runner_.get());
+  io_task_runner_ = io_task_runner;
+}
+
+bool XWalkExternalTaskRunner::PostWorkerTask(const base::Closure& task,
+                                             base::TimeDelta delay) {
+  if (delay > base::TimeDelta())
+    return worker_pool_->PostDelayedWorkerTask(FROM_HERE, task, delay);
+
+  return worker_pool_->PostWorkerTaskWithShutdownBehavior(
+      FROM_HERE, task, base::SequencedWorkerPool::SKIP_ON_SHUTDOWN);
+}
+
+int32_t XWalkExternalTaskRunner::WatchFileDescriptor(
+    int fd,
+    int events,
+    const scoped_refptr<base::SingleThreadTaskRunner>& task_runner,
+    const FileDescriptorCallback& callback) {
+#if defined(OS_POSIX)
+  if (fd < 0 || !events ||
+      (events & ~(XW_FILE_DESCRIPTOR_READ | XW_FILE_DESCRIPTOR_WRITE))) {
+    return 0;
+  }
+
+  base::AutoLock lock(lock_);
+  if (!io_task_runner_.get()) {
+    io_thread_.reset(new base::Thread("XWalkExtensionIOThread"));
+    io_thread_->StartWithOptions(
+        base::Thread::Options(base::MessageLoop::TYPE_IO, 0));
+    io_task_runner_ = io_thread_->message_loop_proxy();
+  }
+
+  scoped_refptr<Watcher> watcher(
+      new Watcher(fd, events, io_task_runner_, task_runner, callback));
+  watcher->Start();
+
+  int32_t watch = next_watch_++;
+  watchers_[watch] = watcher;
+  return watch;
+#else
+  NOTIMPLEMENTED();
+  return 0;
+#endif
+}
+
+void XWalkExternalTaskRunner::StopWatchingFileDescriptor(int32_t watch) {
+  scoped_refptr<Watcher> watcher;
+  {
+    base::AutoLock lock(lock_);
+    WatcherMap::iterator it = watchers_.find(watch);
+    if (it == watchers_.end())
+      return;
+
+    watcher = it->second;
+    watchers_.erase(it);
+  }
+
+  watcher->Stop();
+}
+
+}  // namespace extensions
+}  // namespace xwalk
@@ -0,0 +1,83 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_TASK_RUNNER_H_
+#define XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_TASK_RUNNER_H_
+
+#include <map>
+
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+template <typename T> struct DefaultSingletonTraits;
+
+namespace base {
+class SequencedWorkerPool;
+class SingleThreadTaskRunner;
+class Thread;
+}
+
+namespace xwalk {
+namespace extensions {
+
+// Provides the threads shared by the external extensions of a process: a
+// bounded pool of worker threads and an IO loop for watching file
+// descriptors. Used by XWalkExternalAdapter to implement
+// XW_Internal_TaskRunnerInterface, all methods can be called from any thread.
+class XWalkExternalTaskRunner {
+ public:
+  // Receives the file descriptor and the XW_FILE_DESCRIPTOR_* events.
+  typedef base::Callback<void(int fd, int events)> FileDescriptorCallback;
+
+  static XWalkExternalTaskRunner* GetInstance();
+
+  // Sets the IO loop used for watching file descriptors. When not set, a
+  // dedicated IO thread is started for the first watch.
+  void SetIOTaskRunner(
+      const scoped_refptr<base::SingleThreadTaskRunner>& io_task_runner);
+
+  bool PostWorkerTask(const base::Closure& task, base::TimeDelta delay);
+
+  // Watches |fd| for |events|. When some happen, the watch is suspended and
+  // |callback| is posted to |task_runner| once with all of them, then the
+  // watch resumes once the callback has run. Returns 0 for invalid arguments.
+  // If the IO loop fails to watch |fd|, |callback| is posted with
+  // XW_FILE_DESCRIPTOR_ERROR instead and the watch ends.
+  int32_t WatchFileDescriptor(
+      int fd,
+      int events,
+      const scoped_refptr<base::SingleThreadTaskRunner>& task_runner,
+      const FileDescriptorCallback& callback);
+
+  // No callback is run after this, when called from the thread the callbacks
+  // of the watch are posted to.
+  void StopWatchingFileDescriptor(int32_t watch);
+
+ private:
+  friend struct DefaultSingletonTraits<XWalkExternalTaskRunner>;
+
+  class Watcher;
+
+  XWalkExternalTaskRunner();
+  ~XWalkExternalTaskRunner();
+
+  base::Lock lock_;
+  scoped_refptr<base::SequencedWorkerPool> worker_pool_;
+  scoped_refptr<base::SingleThreadTaskRunner> io_task_runner_;
+  scoped_ptr<base::Thread> io_thread_;
+
+  typedef std::map<int32_t, scoped_refptr<Watcher> > WatcherMap;
+  WatcherMap watchers_;
+  int32_t next_watch_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkExternalTaskRunner);
+};
+
+}  // namespace extensions
+}  // namespace xwalk
+
+#endif  // XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_TASK_RUNNER_H_
@@ -0,0 +1,154 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/common/xwalk_external_task_runner.h"
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/thread_task_runner_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/extensions/public/XW_Extension.h"
+#include "xwalk/extensions/public/XW_Extension_TaskRunner.h"
+
+#if defined(OS_POSIX)
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using xwalk::extensions::XWalkExternalTaskRunner;
+
+namespace {
+
+void SignalEvent(base::WaitableEvent* event) {
+  event->Signal();
+}
+
+#if defined(OS_POSIX)
+void OnReadable(int* calls, int* received_events, const base::Closure& quit,
+                int fd, int events) {
+  (*calls)++;
+  *received_events = events;
+
+  // Drains the pipe, so the watch doesn't fire again once resumed.
+  char buffer;
+  ASSERT_EQ(1, read(fd, &buffer, 1));
+  quit.Run();
+}
+
+void OnEvents(int* calls, int* received_events, const base::Closure& quit,
+              int fd, int events) {
+  (*calls)++;
+  *received_events = events;
+  quit.Run();
+}
+#endif
+
+}  // namespace
+
+TEST(XWalkExternalTaskRunnerTest, PostWorkerTask) {
+  base::WaitableEvent event(false, false);
+  EXPECT_TRUE(XWalkExternalTaskRunner::GetInstance()->PostWorkerTask(
+      base::Bind(&SignalEvent, &event), base::TimeDelta()));
+  event.Wait();
+
+  EXPECT_TRUE(XWalkExternalTaskRunner::GetInstance()->PostWorkerTask(
+      base::Bind(&SignalEvent, &event),
+      base::TimeDelta::FromMilliseconds(10)));
+  event.Wait();
+}
+
+#if defined(OS_POSIX)
+TEST(XWalkExternalTaskRunnerTest, WatchFileDescriptor) {
+  base::MessageLoop message_loop;
+  XWalkExternalTaskRunner* runner = XWalkExternalTaskRunner::GetInstance();
+
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+
+  EXPECT_EQ(0, runner->WatchFileDescriptor(fds[0], 0,
+      base::ThreadTaskRunnerHandle::Get(),
+      XWalkExternalTaskRunner::FileDescriptorCallback()));
+
+  int calls = 0;
+  int events = 0;
+  base::RunLoop run_loop;
+  int32_t watch = runner->WatchFileDescriptor(fds[0], XW_FILE_DESCRIPTOR_READ,
+      base::ThreadTaskRunnerHandle::Get(),
+      base::Bind(&OnReadable, &calls, &events, run_loop.QuitClosure()));
+  EXPECT_GT(watch, 0);
+
+  // The callback runs on this thread, once the IO loop sees the data.
+  ASSERT_EQ(1, write(fds[1], "x", 1));
+  run_loop.Run();
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(XW_FILE_DESCRIPTOR_READ, events);
+
+  // Nothing runs after the watch is stopped.
+  runner->StopWatchingFileDescriptor(watch);
+  ASSERT_EQ(1, write(fds[1], "x", 1));
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(1, calls);
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+// A descriptor both readable and writable is reported by a single callback.
+TEST(XWalkExternalTaskRunnerTest, WatchReadAndWrite) {
+  base::MessageLoop message_loop;
+  XWalkExternalTaskRunner* runner = XWalkExternalTaskRunner::GetInstance();
+
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  ASSERT_EQ(1, write(fds[1], "x", 1));
+
+  int calls = 0;
+  int events = 0;
+  base::RunLoop run_loop;
+  int32_t watch = runner->WatchFileDescriptor(fds[0],
+      XW_FILE_DESCRIPTOR_READ | XW_FILE_DESCRIPTOR_WRITE,
+      base::ThreadTaskRunnerHandle::Get(),
+      base::Bind(&OnEvents, &calls, &events, run_loop.QuitClosure()));
+  EXPECT_GT(watch, 0);
+
+  run_loop.Run();
+  runner->StopWatchingFileDescriptor(watch);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(XW_FILE_DESCRIPTOR_READ | XW_FILE_DESCRIPTOR_WRITE, events);
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+// Regular files can't be watched by the IO loop, which is only known once
+// the watch was returned.
+TEST(XWalkExternalTaskRunnerTest, WatchFailure) {
+  base::MessageLoop message_loop;
+  XWalkExternalTaskRunner* runner = XWalkExternalTaskRunner::GetInstance();
+
+  base::FilePath path;
+  FILE* file = base::CreateAndOpenTemporaryFile(&path);
+  ASSERT_TRUE(file);
+
+  int calls = 0;
+  int events = 0;
+  base::RunLoop run_loop;
+  int32_t watch = runner->WatchFileDescriptor(fileno(file),
+      XW_FILE_DESCRIPTOR_READ, base::ThreadTaskRunnerHandle::Get(),
+      base::Bind(&OnEvents, &calls, &events, run_loop.QuitClosure()));
+  EXPECT_GT(watch, 0);
+
+  run_loop.Run();
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(XW_FILE_DESCRIPTOR_ERROR, events);
+  runner->StopWatchingFileDescriptor(watch);
+
+  base::CloseFile(file);
+  base::DeleteFile(path, false);
+}
+#endif
@@ -0,0 +1,189 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_EXTENSIONS_COMMON_XWALK_HANDLE_TABLE_H_
+#define XWALK_EXTENSIONS_COMMON_XWALK_HANDLE_TABLE_H_
+
+#include <stdint.h>
+#include <deque>
+
+#include "base/atomicops.h"
+#include "base/logging.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/platform_thread.h"
+
+namespace xwalk {
+namespace extensions {
+
+// Maps positive integer handles to objects, for handles given to C code that
+// can use them from any thread. A handle embeds the generation of its slot,
+// so a stale handle never resolves to an object added later in the same slot.
+//
+// Lookups are wait-free and keep the object from being removed until the
+// ScopedLookup goes out of scope. Adding and removing objects take a lock,
+// and Remove() waits for the lookups in progress to finish, so the object
+// can be destroyed right after.
+template <typename T>
+class XWalkHandleTable {
+ public:
+  // Index 0 is never used, so 0 is never a valid handle.
+  static const int kIndexBits = 16;
+  static const int32_t kIndexMask = (1 << kIndexBits) - 1;
+  static const int32_t kGenerationMask = (1 << (31 - kIndexBits)) - 1;
+  static const int kChunkSize = 256;
+  static const int kMaxChunks = (kIndexMask + 1) / kChunkSize;
+
+  class ScopedLookup {
+   public:
+    ScopedLookup(XWalkHandleTable* table, int32_t handle)
+        : users_(NULL),
+          object_(NULL) {
+      table->Acquire(handle, &users_, &object_);
+    }
+
+    ~ScopedLookup() {
+      if (users_)
+        base::subtle::Barrier_AtomicIncrement(users_, -1);
+    }
+
+    T* get() const { return object_; }
+
+   private:
+    base::subtle::Atomic32* users_;
+    T* object_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedLookup);
+  };
+
+  XWalkHandleTable() : next_index_(1) {
+    for (int i = 0; i < kMaxChunks; ++i)
+      base::subtle::NoBarrier_Store(&chunks_[i], 0);
+  }
+
+  ~XWalkHandleTable() {
+    for (int i = 0; i < kMaxChunks; ++i)
+      delete[] GetChunk(i);
+  }
+
+  // Returns a handle with no object yet, which is not resolved by lookups
+  // until Publish() is called. Returns 0 if the table is full.
+  int32_t Reserve() {
+    base::AutoLock lock(lock_);
+
+    int32_t index;
+    if (!free_indexes_.empty()) {
+      // Slots are reused in FIFO order, so a stale handle would need the
+      // generation of its slot to wrap around to be resolved again.
+      index = free_indexes_.front();
+      free_indexes_.pop_front();
+    } else if (next_index_ <= kIndexMask) {
+      index = next_index_++;
+      if (index % kChunkSize == 0 || index == 1) {
+        base::subtle::Release_Store(&chunks_[index / kChunkSize],
+            reinterpret_cast<base::subtle::AtomicWord>(new Slot[kChunkSize]));
+      }
+    } else {
+      LOG(ERROR) << "No handles left.";
+      return 0;
+    }
+
+    Slot* slot = GetSlot(index);
+    slot->object = NULL;
+    return (slot->generation << kIndexBits) | index;
+  }
+
+  void Publish(int32_t handle, T* object) {
+    base::AutoLock lock(lock_);
+    Slot* slot = GetSlot(handle & kIndexMask);
+    CHECK(slot && !slot->object);
+    CHECK_EQ((slot->generation << kIndexBits) | (handle & kIndexMask), handle);
+
+    slot->object = object;
+    base::subtle::Release_Store(&slot->handle, handle);
+  }
+
+  // Makes |handle| invalid, waiting for the lookups in progress on its
+  // object. Must not be called while holding a lookup on the same handle.
+  void Remove(int32_t handle) {
+    base::AutoLock lock(lock_);
+    Slot* slot = GetSlot(handle & kIndexMask);
+    CHECK(slot);
+    CHECK_EQ((slot->generation << kIndexBits) | (handle & kIndexMask), handle);
+
+    // Pairs with the barrier of Acquire(): either the lookup sees the handle
+    // is gone, or we see it is using the object.
+    base::subtle::NoBarrier_Store(&slot->handle, 0);
+    base::subtle::MemoryBarrier();
+    while (base::subtle::Acquire_Load(&slot->users) != 0)
+      base::PlatformThread::YieldCurrentThread();
+
+    slot->object = NULL;
+    slot->generation = (slot->generation + 1) & kGenerationMask;
+    free_indexes_.push_back(handle & kIndexMask);
+  }
+
+  bool IsValid(int32_t handle) {
+    ScopedLookup lookup(this, handle);
+    return lookup.get() != NULL;
+  }
+
+ private:
+  struct Slot {
+    Slot() : handle(0), users(0), object(NULL), generation(0) {}
+
+    // The published handle, 0 while the slot has no object.
+    base::subtle::Atomic32 handle;
+    base::subtle::Atomic32 users;
+
+    // Written before |handle| is published, and cleared once there are no
+    // |users| left.
+    T* object;
+
+    // Only used with |lock_| held.
+    int32_t generation;
+  };
+
+  Slot* GetChunk(int chunk) const {
+    return reinterpret_cast<Slot*>(
+        base::subtle::Acquire_Load(&chunks_[chunk]));
+  }
+
+  Slot* GetSlot(int32_t index) const {
+    if (index <= 0 || index > kIndexMask)
+      return NULL;
+    Slot* chunk = GetChunk(index / kChunkSize);
+    return chunk ? &chunk[index % kChunkSize] : NULL;
+  }
+
+  void Acquire(int32_t handle, base::subtle::Atomic32** users, T** object) {
+    if (handle <= 0)
+      return;
+
+    Slot* slot = GetSlot(handle & kIndexMask);
+    if (!slot)
+      return;
+
+    base::subtle::Barrier_AtomicIncrement(&slot->users, 1);
+    if (base::subtle::Acquire_Load(&slot->handle) != handle) {
+      base::subtle::Barrier_AtomicIncrement(&slot->users, -1);
+      return;
+    }
+
+    *users = &slot->users;
+    *object = slot->object;
+  }
+
+  base::subtle::AtomicWord chunks_[kMaxChunks];
+
+  base::Lock lock_;
+  std::deque<int32_t> free_indexes_;
+  int32_t next_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkHandleTable);
+};
+
+}  // namespace extensions
+}  // namespace xwalk
+
+#endif  // XWALK_EXTENSIONS_COMMON_XWALK_HANDLE_TABLE_H_
@@ -0,0 +1,177 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/common/xwalk_handle_table.h"
+
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/memory/scoped_vector.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using xwalk::extensions::XWalkHandleTable;
+
+namespace {
+
+const int kReaderThreads = 8;
+const int kLiveObjects = 16;
+const int kChurnIterations = 20000;
+
+struct TestObject {
+  TestObject() : alive(1) {}
+
+  base::subtle::Atomic32 alive;
+};
+
+typedef XWalkHandleTable<TestObject> TestTable;
+
+// Resolves the handles published by the main thread as fast as it can, and
+// checks that a resolved object is never one that was removed.
+class Reader : public base::DelegateSimpleThread::Delegate {
+ public:
+  Reader(TestTable* table, base::subtle::Atomic32* handles,
+         base::subtle::Atomic32* done)
+      : table_(table),
+        handles_(handles),
+        done_(done),
+        resolved_(0),
+        dead_objects_(0) {}
+
+  void Run() override {
+    for (int i = 0; !base::subtle::Acquire_Load(done_); ++i) {
+      int32_t handle =
+          base::subtle::Acquire_Load(&handles_[i % kLiveObjects]);
+      TestTable::ScopedLookup lookup(table_, handle);
+      if (!lookup.get())
+        continue;
+
+      resolved_++;
+      if (!base::subtle::Acquire_Load(&lookup.get()->alive))
+        dead_objects_++;
+    }
+  }
+
+  int resolved() const { return resolved_; }
+  int dead_objects() const { return dead_objects_; }
+
+ private:
+  TestTable* table_;
+  base::subtle::Atomic32* handles_;
+  base::subtle::Atomic32* done_;
+  int resolved_;
+  int dead_objects_;
+};
+
+}  // namespace
+
+TEST(XWalkHandleTableTest, ReserveAndRemove) {
+  TestTable table;
+  TestObject object;
+
+  int32_t handle = table.Reserve();
+  EXPECT_EQ(1, handle);
+
+  // Reserved handles are not resolved until published.
+  EXPECT_FALSE(table.IsValid(handle));
+  table.Publish(handle, &object);
+  EXPECT_TRUE(table.IsValid(handle));
+  {
+    TestTable::ScopedLookup lookup(&table, handle);
+    EXPECT_EQ(&object, lookup.get());
+  }
+
+  EXPECT_FALSE(table.IsValid(0));
+  EXPECT_FALSE(table.IsValid(-1));
+  EXPECT_FALSE(table.IsValid(handle + 1));
+
+  // A slot reused after a removal gets another generation, so the stale
+  // handle is not resolved to the new object.
+  table.Remove(handle);
+  EXPECT_FALSE(table.IsValid(handle));
+
+  int32_t new_handle = table.Reserve();
+  EXPECT_NE(handle, new_handle);
+  EXPECT_EQ(handle & TestTable::kIndexMask,
+            new_handle & TestTable::kIndexMask);
+
+  TestObject new_object;
+  table.Publish(new_handle, &new_object);
+  EXPECT_FALSE(table.IsValid(handle));
+  EXPECT_TRUE(table.IsValid(new_handle));
+  table.Remove(new_handle);
+}
+
+TEST(XWalkHandleTableTest, ManyHandles) {
+  TestTable table;
+  TestObject object;
+
+  // Crosses several chunks of slots.
+  std::vector<int32_t> handles;
+  for (int i = 0; i < 4 * TestTable::kChunkSize; ++i) {
+    handles.push_back(table.Reserve());
+    table.Publish(handles.back(), &object);
+  }
+
+  for (size_t i = 0; i < handles.size(); ++i) {
+    EXPECT_TRUE(table.IsValid(handles[i]));
+    table.Remove(handles[i]);
+    EXPECT_FALSE(table.IsValid(handles[i]));
+  }
+}
+
+TEST(XWalkHandleTableTest, ConcurrentLookups) {
+  TestTable table;
+  base::subtle::Atomic32 handles[kLiveObjects];
+  TestObject* objects[kLiveObjects];
+  base::subtle::Atomic32 done = 0;
+
+  for (int i = 0; i < kLiveObjects; ++i) {
+    objects[i] = new TestObject;
+    handles[i] = table.Reserve();
+    table.Publish(handles[i], objects[i]);
+  }
+
+  ScopedVector<Reader> readers;
+  ScopedVector<base::DelegateSimpleThread> threads;
+  for (int i = 0; i < kReaderThreads; ++i) {
+    readers.push_back(new Reader(&table, handles, &done));
+    threads.push_back(new base::DelegateSimpleThread(readers.back(),
+                                                     "HandleTableReader"));
+    threads.back()->Start();
+  }
+
+  // Replaces the objects while the readers are resolving their handles. An
+  // object is only marked as dead and destroyed after being removed.
+  for (int i = 0; i < kChurnIterations; ++i) {
+    int index = i % kLiveObjects;
+    TestObject* object = new TestObject;
+    int32_t handle = table.Reserve();
+    table.Publish(handle, object);
+
+    int32_t old_handle = base::subtle::Acquire_Load(&handles[index]);
+    base::subtle::Release_Store(&handles[index], handle);
+    table.Remove(old_handle);
+
+    base::subtle::Release_Store(&objects[index]->alive, 0);
+    delete objects[index];
+    objects[index] = object;
+  }
+
+  base::subtle::Release_Store(&done, 1);
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i]->Join();
+
+  int resolved = 0;
+  for (size_t i = 0; i < readers.size(); ++i) {
+    EXPECT_EQ(0, readers[i]->dead_objects());
+    resolved += readers[i]->resolved();
+  }
+  EXPECT_GT(resolved, 0);
+
+  for (int i = 0; i < kLiveObjects; ++i) {
+    table.Remove(handles[i]);
+    delete objects[i];
+  }
+}
@@ -13,6 +13,7 @@
 #include "ipc/ipc_message_macros.h"
 #include "ipc/ipc_sync_channel.h"
 #include "xwalk/extensions/common/xwalk_extension_messages.h"
+#include "xwalk/extensions/common/xwalk_external_task_runner.h"
 
 namespace xwalk {
 namespace extensions {
@@ -23,6 +24,8 @@ XWalkExtensionProcess::XWalkExtensionProcess(
       io_thread_("XWalkExtensionProcess_IOThread") {
   io_thread_.StartWithOptions(
       base::Thread::Options(base::MessageLoop::TYPE_IO, 0));
+  XWalkExternalTaskRunner::GetInstance()->SetIOTaskRunner(
+      io_thread_.message_loop_proxy());
 
   extensions_server_.set_permissions_delegate(this);
   CreateBrowserProcessChannel(channel_handle);
@@ -41,6 +41,9 @@
         'common/xwalk_external_extension.h',
         'common/xwalk_external_instance.cc',
         'common/xwalk_external_instance.h',
+        'common/xwalk_external_task_runner.cc',
+        'common/xwalk_external_task_runner.h',
+        'common/xwalk_handle_table.h',
         'common/xwalk_extension_permission_types.h',
         'extension_process/xwalk_extension_process_main.cc',
         'extension_process/xwalk_extension_process_main.h',
@@ -51,6 +54,7 @@
         'public/XW_Extension.h',
         'public/XW_Extension_Permissions.h',
         'public/XW_Extension_SyncMessage.h',
+        'public/XW_Extension_TaskRunner.h',
         'renderer/xwalk_extension_client.cc',
         'renderer/xwalk_extension_client.h',
         'renderer/xwalk_extension_module.cc',
@@ -64,6 +68,8 @@
         'renderer/xwalk_module_system.h',
         'renderer/xwalk_v8_utils.cc',
         'renderer/xwalk_v8_utils.h',
+        'renderer/xwalk_v8_value_serializer.cc',
+        'renderer/xwalk_v8_value_serializer.h',
         'renderer/xwalk_v8tools_module.cc',
         'renderer/xwalk_v8tools_module.h',
       ],
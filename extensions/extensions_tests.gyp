@@ -6,12 +6,19 @@
       'dependencies': [
         '../../base/base.gyp:base',
         '../../base/base.gyp:run_all_unittests',
+        '../../gin/gin.gyp:gin_test',
+        '../../ipc/ipc.gyp:ipc',
         '../../testing/gtest.gyp:gtest',
+        '../../v8/tools/gyp/v8.gyp:v8',
         'extensions.gyp:xwalk_extensions',
       ],
       'sources': [
         'browser/xwalk_extension_function_handler_unittest.cc',
         'common/xwalk_extension_server_unittest.cc',
+        'common/xwalk_external_adapter_unittest.cc',
+        'common/xwalk_external_task_runner_unittest.cc',
+        'common/xwalk_handle_table_unittest.cc',
+        'renderer/xwalk_v8_value_serializer_unittest.cc',
       ],
     },
     {
@@ -110,5 +110,22 @@
         }],
       ],
     },
+    {
+      'target_name': 'benchmark_extension',
+      'type': 'loadable_module',
+      'variables': {
+        'mac_strip': 0,
+      },
+      'sources': [
+        'test/benchmark_extension.c',
+      ],
+      'conditions': [
+        ['OS=="win"', {
+          'product_dir': '<(PRODUCT_DIR)\\tests\\extension\\benchmark_extension\\'
+        }, {
+          'product_dir': '<(PRODUCT_DIR)/tests/extension/benchmark_extension/'
+        }],
+      ],
+    },
   ],
 }
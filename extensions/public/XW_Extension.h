@@ -33,6 +33,7 @@ extern "C" {
 #define XW_EXPORT __declspec(dllexport)
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 
 
@@ -113,10 +114,13 @@ struct XW_CoreInterface_1 {
   //            extension.
   //
   // - extension.postMessage(): post a string message to the extension native
-  //                            code. See below for details.
+  //                            code. See below for details. With
+  //                            XW_MessagingInterface_2, an ArrayBuffer or a
+  //                            typed array can be posted as a binary message.
   // - extension.setMessageListener(): allow setting a callback that is called
   //                                   when the native code sends a message
-  //                                   to JavaScript. Callback takes a string.
+  //                                   to JavaScript. Callback takes a string,
+  //                                   or an ArrayBuffer for binary messages.
   //
   // This function should be called only during XW_Initialize().
   void (*SetJavaScriptAPI)(XW_Extension extension, const char* api);
@@ -178,6 +182,64 @@ struct XW_MessagingInterface_1 {
 
 typedef struct XW_MessagingInterface_1 XW_MessagingInterface;
 
+
+//
+// XW_MESSAGING_INTERFACE_2: Same as XW_MESSAGING_INTERFACE_1, plus binary
+// messages, which are ArrayBuffers on the JavaScript side.
+//
+// Binary messages are passed in buffers managed by Crosswalk, so they can be
+// handed between Crosswalk and the extension without being copied. The
+// extension owns the buffers it receives and the ones it allocates, until it
+// either posts them with PostBuffer() or releases them with ReleaseBuffer().
+//
+// Versioned definitions should be used for this interface, the unversioned
+// ones still refer to XW_MESSAGING_INTERFACE_1.
+//
+
+#define XW_MESSAGING_INTERFACE_2 "XW_MessagingInterface_2"
+
+// The extension owns |data| after the call.
+typedef void (*XW_HandleBinaryMessageCallback)(XW_Instance instance,
+                                               void* data,
+                                               size_t size);
+
+struct XW_MessagingInterface_2 {
+  // Same as in XW_MessagingInterface_1, for string messages.
+  void (*Register)(XW_Extension extension,
+                   XW_HandleMessageCallback handle_message);
+  void (*PostMessage)(XW_Instance instance, const char* message);
+
+  // Register a callback to be called when the JavaScript code associated
+  // with the extension posts an ArrayBuffer or a typed array.
+  void (*RegisterBinary)(XW_Extension extension,
+                         XW_HandleBinaryMessageCallback handle_message);
+
+  // Post a copy of |size| bytes from |data| to the web content associated
+  // with the instance. The listener receives them in an ArrayBuffer.
+  //
+  // This function is thread-safe and can be called until the instance is
+  // destroyed.
+  void (*PostBinaryMessage)(XW_Instance instance,
+                            const void* data,
+                            size_t size);
+
+  // Return a buffer of |size| bytes owned by the extension. Can be called
+  // from any thread.
+  void* (*AllocateBuffer)(size_t size);
+
+  // Post the first |size| bytes of |buffer| without copying them, and take
+  // ownership of the buffer, even if the call fails. |buffer| must be owned
+  // by the extension, either received or allocated, and |size| can't be
+  // bigger than its size.
+  //
+  // This function is thread-safe and can be called until the instance is
+  // destroyed.
+  void (*PostBuffer)(XW_Instance instance, void* buffer, size_t size);
+
+  // Free a buffer owned by the extension. Can be called from any thread.
+  void (*ReleaseBuffer)(void* buffer);
+};
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -18,6 +18,8 @@ extern "C" {
 
 #define XW_INTERNAL_ENTRY_POINTS_INTERFACE_1 \
   "XW_Internal_EntryPointsInterface_1"
+#define XW_INTERNAL_ENTRY_POINTS_INTERFACE_2 \
+  "XW_Internal_EntryPointsInterface_2"
 #define XW_INTERNAL_ENTRY_POINTS_INTERFACE \
   XW_INTERNAL_ENTRY_POINTS_INTERFACE_1
 
@@ -41,6 +43,21 @@ struct XW_Internal_EntryPointsInterface_1 {
 typedef struct XW_Internal_EntryPointsInterface_1
     XW_Internal_EntryPointsInterface;
 
+struct XW_Internal_EntryPointsInterface_2 {
+  // Same as in XW_Internal_EntryPointsInterface_1.
+  void (*SetExtraJSEntryPoints)(XW_Extension extension,
+                                const char** entry_points);
+
+  // When |shared| is not 0, the frames of the same origin in a render process
+  // share a single instance instead of getting one each, so native state
+  // like sockets is not duplicated between them. Messages posted by the
+  // instance are delivered to all of its frames, so the JavaScript code must
+  // be able to tell apart the replies to other frames.
+  //
+  // This function should be called only during XW_Initialize().
+  void (*SetSharedInstances)(XW_Extension extension, int shared);
+};
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
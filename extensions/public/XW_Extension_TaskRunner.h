@@ -0,0 +1,95 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_EXTENSIONS_PUBLIC_XW_EXTENSION_TASKRUNNER_H_
+#define XWALK_EXTENSIONS_PUBLIC_XW_EXTENSION_TASKRUNNER_H_
+
+// NOTE: This file and interfaces marked as internal are not considered stable
+// and can be modified in incompatible ways between Crosswalk versions.
+
+#ifndef XWALK_EXTENSIONS_PUBLIC_XW_EXTENSION_H_
+#error "You should include XW_Extension.h before this file"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XW_INTERNAL_TASK_RUNNER_INTERFACE_1 \
+  "XW_Internal_TaskRunnerInterface_1"
+#define XW_INTERNAL_TASK_RUNNER_INTERFACE \
+  XW_INTERNAL_TASK_RUNNER_INTERFACE_1
+
+//
+// XW_INTERNAL_TASK_RUNNER_INTERFACE: allow extensions to run work on the
+// threads of Crosswalk instead of creating their own.
+//
+
+typedef void (*XW_TaskCallback)(void* user_data);
+
+// Events of a file descriptor, combined as a bitmask.
+#define XW_FILE_DESCRIPTOR_READ 1
+#define XW_FILE_DESCRIPTOR_WRITE 2
+
+// Passed alone to the callback of a watch when the file descriptor can't be
+// watched. The callback isn't called again, but the watch should still be
+// stopped.
+#define XW_FILE_DESCRIPTOR_ERROR 4
+
+// Identifies a file descriptor watch, valid watches are positive.
+typedef int32_t XW_FileDescriptorWatch;
+
+typedef void (*XW_FileDescriptorCallback)(XW_Instance instance,
+                                          int fd,
+                                          int events,
+                                          void* user_data);
+
+struct XW_Internal_TaskRunnerInterface_1 {
+  // Runs |callback| on the thread handling the messages of |instance|, after
+  // |delay_ms| milliseconds. The task is dropped if the instance is destroyed
+  // before it runs, so |user_data| should be owned by the instance. Can be
+  // called from any thread. Returns XW_OK, or XW_ERROR for an invalid
+  // instance.
+  int (*PostInstanceTask)(XW_Instance instance,
+                          XW_TaskCallback callback,
+                          void* user_data,
+                          int64_t delay_ms);
+
+  // Runs |callback| on a pool of worker threads shared by all the extensions
+  // of the process, after |delay_ms| milliseconds. Tasks may run in
+  // parallel and in any order, and may be skipped at shutdown. Can be called
+  // from any thread. Returns XW_OK, or XW_ERROR for an invalid extension.
+  int (*PostWorkerTask)(XW_Extension extension,
+                        XW_TaskCallback callback,
+                        void* user_data,
+                        int64_t delay_ms);
+
+  // Watches |fd| for the |events| given as a XW_FILE_DESCRIPTOR_* bitmask on
+  // the IO loop of the process. |callback| runs on the thread handling the
+  // messages of |instance| with the events that happened, and the watch
+  // resumes once it returns. Watches end with the instance. Returns the
+  // watch, or 0 for invalid arguments. The file descriptor is registered
+  // asynchronously, so a failure is reported to |callback| with
+  // XW_FILE_DESCRIPTOR_ERROR.
+  XW_FileDescriptorWatch (*WatchFileDescriptor)(
+      XW_Instance instance,
+      int fd,
+      int events,
+      XW_FileDescriptorCallback callback,
+      void* user_data);
+
+  // Stops a watch. The callback is not called after this returns, if called
+  // from the thread of the instance.
+  void (*StopWatchingFileDescriptor)(XW_Instance instance,
+                                     XW_FileDescriptorWatch watch);
+};
+
+typedef struct XW_Internal_TaskRunnerInterface_1
+    XW_Internal_TaskRunnerInterface;
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // XWALK_EXTENSIONS_PUBLIC_XW_EXTENSION_TASKRUNNER_H_
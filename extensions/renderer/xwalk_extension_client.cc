@@ -4,10 +4,14 @@
 
 #include "xwalk/extensions/renderer/xwalk_extension_client.h"
 
+#include <algorithm>
+
+#include "base/message_loop/message_loop.h"
 #include "base/values.h"
 #include "base/stl_util.h"
 #include "ipc/ipc_sender.h"
 #include "xwalk/extensions/common/xwalk_extension_messages.h"
+#include "xwalk/extensions/renderer/xwalk_v8_value_serializer.h"
 
 namespace xwalk {
 namespace extensions {
@@ -19,6 +23,7 @@ XWalkExtensionClient::XWalkExtensionClient()
 
 XWalkExtensionClient::~XWalkExtensionClient() {
   STLDeleteValues(&extension_apis_);
+  STLDeleteValues(&shared_instances_);
 }
 
 bool XWalkExtensionClient::Send(IPC::Message* msg) {
@@ -39,11 +44,64 @@ int64_t XWalkExtensionClient::CreateInstance(
   return next_instance_id_++;
 }
 
+int64_t XWalkExtensionClient::AcquireSharedInstance(
+    const std::string& extension_name, const std::string& origin,
+    InstanceHandler* handler) {
+  CHECK(handler);
+  std::pair<std::string, std::string> key(extension_name, origin);
+  SharedInstanceMap::iterator it = shared_instances_.find(key);
+  if (it != shared_instances_.end()) {
+    it->second->handlers.push_back(handler);
+    return it->second->instance_id;
+  }
+
+  scoped_ptr<SharedInstance> shared(new SharedInstance(extension_name,
+                                                       origin));
+  shared->instance_id = CreateInstance(extension_name, shared.get());
+  if (!shared->instance_id)
+    return 0;
+
+  shared->handlers.push_back(handler);
+  int64_t instance_id = shared->instance_id;
+  shared_instances_[key] = shared.release();
+  return instance_id;
+}
+
+void XWalkExtensionClient::ReleaseSharedInstance(int64_t instance_id,
+                                                 InstanceHandler* handler) {
+  HandlerMap::iterator it = handlers_.find(instance_id);
+  if (it == handlers_.end() || !it->second) {
+    LOG(WARNING) << "Can't release invalid shared instance id: "
+                 << instance_id;
+    return;
+  }
+
+  // Only shared instances are released, so the handler is a SharedInstance.
+  SharedInstance* shared = static_cast<SharedInstance*>(it->second);
+  std::vector<InstanceHandler*>::iterator handler_it =
+      std::find(shared->handlers.begin(), shared->handlers.end(), handler);
+  if (handler_it == shared->handlers.end())
+    return;
+
+  shared->handlers.erase(handler_it);
+  if (!shared->handlers.empty())
+    return;
+
+  shared_instances_.erase(std::make_pair(shared->extension_name,
+                                         shared->origin));
+  DestroyInstance(instance_id);
+
+  // The last handler can be released while the shared instance is
+  // forwarding a message to it, e.g. when a frame is removed by the message
+  // listener.
+  base::MessageLoop::current()->DeleteSoon(FROM_HERE, shared);
+}
+
 bool XWalkExtensionClient::OnMessageReceived(const IPC::Message& message) {
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(XWalkExtensionClient, message)
-    IPC_MESSAGE_HANDLER(XWalkExtensionClientMsg_PostMessageToJS,
-        OnPostMessageToJS)
+    IPC_MESSAGE_HANDLER_GENERIC(XWalkExtensionClientMsg_PostMessageToJS,
+        OnPostMessageToJS(message))
     IPC_MESSAGE_HANDLER(XWalkExtensionClientMsg_PostOutOfLineMessageToJS,
         OnPostOutOfLineMessageToJS)
     IPC_MESSAGE_HANDLER(XWalkExtensionClientMsg_InstanceDestroyed,
@@ -54,14 +112,31 @@ bool XWalkExtensionClient::OnMessageReceived(const IPC::Message& message) {
   return handled;
 }
 
-XWalkExtensionClient::ExtensionCodePoints::ExtensionCodePoints() {
+XWalkExtensionClient::ExtensionCodePoints::ExtensionCodePoints()
+    : shares_instances(false) {
 }
 
 XWalkExtensionClient::ExtensionCodePoints::~ExtensionCodePoints() {
+  // The default traits of v8::Persistent don't release the handle. This is a
+  // no-op if ReleaseCachedScripts() was called.
+  wrapped_api_script.Reset();
 }
 
-void XWalkExtensionClient::OnPostMessageToJS(int64_t instance_id,
-                                             const base::ListValue& msg) {
+void XWalkExtensionClient::ReleaseCachedScripts() {
+  for (ExtensionAPIMap::iterator it = extension_apis_.begin();
+       it != extension_apis_.end(); ++it) {
+    it->second->wrapped_api_script.Reset();
+  }
+}
+
+void XWalkExtensionClient::OnPostMessageToJS(const IPC::Message& message) {
+  // Only the instance id is read here, the handler reads the contents
+  // straight into JavaScript values.
+  PickleIterator iter(message);
+  int64_t instance_id;
+  if (!IPC::ReadParam(&message, &iter, &instance_id))
+    return;
+
   HandlerMap::const_iterator it = handlers_.find(instance_id);
   if (it == handlers_.end()) {
     LOG(WARNING) << "Can't PostMessage to invalid Extension instance id: "
@@ -73,10 +148,33 @@ void XWalkExtensionClient::OnPostMessageToJS(int64_t instance_id,
   if (!it->second)
     return;
 
-  const base::Value* value;
-  if (!msg.Get(0, &value))
-    return;
-  it->second->HandleMessageFromNative(*value);
+  it->second->HandleMessageFromNative(message, &iter);
+}
+
+XWalkExtensionClient::SharedInstance::SharedInstance(
+    const std::string& extension_name, const std::string& origin)
+    : extension_name(extension_name),
+      origin(origin),
+      instance_id(0) {
+}
+
+XWalkExtensionClient::SharedInstance::~SharedInstance() {
+}
+
+void XWalkExtensionClient::SharedInstance::HandleMessageFromNative(
+    const IPC::Message& message, PickleIterator* iter) {
+  // Handlers can be released by the ones before them, so they are checked
+  // against the current list before each call.
+  std::vector<InstanceHandler*> handlers_to_call(handlers);
+  for (size_t i = 0; i < handlers_to_call.size(); ++i) {
+    if (std::find(handlers.begin(), handlers.end(), handlers_to_call[i]) ==
+        handlers.end())
+      continue;
+
+    // Each handler reads the contents from the start.
+    PickleIterator handler_iter(*iter);
+    handlers_to_call[i]->HandleMessageFromNative(message, &handler_iter);
+  }
 }
 
 void XWalkExtensionClient::OnPostOutOfLineMessageToJS(
@@ -139,10 +237,20 @@ scoped_ptr<base::ListValue> WrapValueInList(scoped_ptr<base::Value> value) {
 
 }  // namespace
 
-void XWalkExtensionClient::PostMessageToNative(int64_t instance_id,
-    scoped_ptr<base::Value> msg) {
-  scoped_ptr<base::ListValue> list_msg = WrapValueInList(msg.Pass());
-  Send(new XWalkExtensionServerMsg_PostMessageToNative(instance_id, *list_msg));
+bool XWalkExtensionClient::PostMessageToNative(int64_t instance_id,
+    v8::Handle<v8::Value> msg, v8::Handle<v8::Context> context,
+    XWalkV8ValueSerializer* serializer) {
+  // Written the way XWalkExtensionServerMsg_PostMessageToNative writes its
+  // parameters, with the value written by |serializer| instead of going
+  // through a base::ListValue.
+  scoped_ptr<IPC::Message> message(new IPC::Message(
+      MSG_ROUTING_CONTROL, XWalkExtensionServerMsg_PostMessageToNative::ID,
+      IPC::Message::PRIORITY_NORMAL));
+  IPC::WriteParam(message.get(), instance_id);
+  if (!serializer->WriteValueAsList(msg, context, message.get()))
+    return false;
+
+  return Send(message.release());
 }
 
 scoped_ptr<base::Value> XWalkExtensionClient::SendSyncMessageToNative(
@@ -173,6 +281,7 @@ void XWalkExtensionClient::Initialize(IPC::Sender* sender) {
     codepoint->api = (*it).js_api;
 
     codepoint->entry_points = (*it).entry_points;
+    codepoint->shares_instances = (*it).shares_instances;
 
     std::string name = (*it).name;
     extension_apis_[name] = codepoint;
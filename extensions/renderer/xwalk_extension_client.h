@@ -8,24 +8,31 @@
 #include <stdint.h>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/shared_memory.h"
 #include "base/values.h"
 #include "ipc/ipc_listener.h"
+#include "v8/include/v8.h"
+
+class PickleIterator;
 
 namespace base {
 class Value;
 }
 
 namespace IPC {
+class Message;
 class Sender;
 }
 
 namespace xwalk {
 namespace extensions {
 
+class XWalkV8ValueSerializer;
+
 // This class holds the JavaScript context of Extensions. It lives in the
 // Render Process and communicates directly with its associated
 // XWalkExtensionServer through an IPC channel.
@@ -36,7 +43,9 @@ namespace extensions {
 class XWalkExtensionClient : public IPC::Listener {
  public:
   struct InstanceHandler {
-    virtual void HandleMessageFromNative(const base::Value& msg) = 0;
+    // The message contents are read from |iter| with XWalkV8ValueSerializer.
+    virtual void HandleMessageFromNative(const IPC::Message& message,
+                                         PickleIterator* iter) = 0;
    protected:
     ~InstanceHandler() {}
   };
@@ -48,7 +57,18 @@ class XWalkExtensionClient : public IPC::Listener {
                          InstanceHandler* handler);
   void DestroyInstance(int64_t instance_id);
 
-  void PostMessageToNative(int64_t instance_id, scoped_ptr<base::Value> msg);
+  // Returns the instance of |extension_name| shared by the handlers of
+  // |origin|, creating it for the first one. Each handler must release the
+  // instance with ReleaseSharedInstance() instead of DestroyInstance().
+  int64_t AcquireSharedInstance(const std::string& extension_name,
+                                const std::string& origin,
+                                InstanceHandler* handler);
+  void ReleaseSharedInstance(int64_t instance_id, InstanceHandler* handler);
+
+  // Returns false, posting nothing, if |msg| can't be serialized.
+  bool PostMessageToNative(int64_t instance_id, v8::Handle<v8::Value> msg,
+                           v8::Handle<v8::Context> context,
+                           XWalkV8ValueSerializer* serializer);
   scoped_ptr<base::Value> SendSyncMessageToNative(int64_t instance_id,
       scoped_ptr<base::Value> msg);
 
@@ -62,18 +82,27 @@ class XWalkExtensionClient : public IPC::Listener {
     ~ExtensionCodePoints();
     std::string api;
     std::vector<std::string> entry_points;
+    bool shares_instances;
+
+    // The API code wrapped by XWalkExtensionModule, compiled the first time
+    // a context loads the extension and bound to each context after that.
+    v8::Persistent<v8::UnboundScript> wrapped_api_script;
   };
 
   typedef std::map<std::string, ExtensionCodePoints*> ExtensionAPIMap;
 
   const ExtensionAPIMap& extension_apis() const { return extension_apis_; }
 
+  // Releases the compiled API scripts. Must be called on the thread of the
+  // isolate before it is disposed, if it is disposed before this client.
+  void ReleaseCachedScripts();
+
  private:
   bool Send(IPC::Message* msg);
 
   // Message Handlers.
   void OnInstanceDestroyed(int64_t instance_id);
-  void OnPostMessageToJS(int64_t instance_id, const base::ListValue& msg);
+  void OnPostMessageToJS(const IPC::Message& message);
   void OnPostOutOfLineMessageToJS(base::SharedMemoryHandle handle,
                                   size_t size);
 
@@ -83,6 +112,28 @@ class XWalkExtensionClient : public IPC::Listener {
   typedef std::map<int64_t, InstanceHandler*> HandlerMap;
   HandlerMap handlers_;
 
+  // Handler of a shared instance, forwarding its messages to the handlers
+  // sharing it.
+  struct SharedInstance : public InstanceHandler {
+    SharedInstance(const std::string& extension_name,
+                   const std::string& origin);
+    ~SharedInstance();
+
+    // InstanceHandler implementation.
+    void HandleMessageFromNative(const IPC::Message& message,
+                                 PickleIterator* iter) override;
+
+    std::string extension_name;
+    std::string origin;
+    int64_t instance_id;
+    std::vector<InstanceHandler*> handlers;
+  };
+
+  // Shared instances by extension name and origin.
+  typedef std::map<std::pair<std::string, std::string>, SharedInstance*>
+      SharedInstanceMap;
+  SharedInstanceMap shared_instances_;
+
   int64_t next_instance_id_;
 };
 
@@ -9,8 +9,11 @@
 #include "base/strings/stringprintf.h"
 #include "base/values.h"
 #include "content/public/renderer/v8_value_converter.h"
+#include "third_party/WebKit/public/platform/WebString.h"
+#include "third_party/WebKit/public/web/WebDocument.h"
 #include "third_party/WebKit/public/web/WebFrame.h"
 #include "third_party/WebKit/public/web/WebScopedMicrotaskSuppression.h"
+#include "third_party/WebKit/public/web/WebSecurityOrigin.h"
 #include "xwalk/extensions/renderer/xwalk_module_system.h"
 #include "xwalk/extensions/renderer/xwalk_v8_utils.h"
 
@@ -25,16 +28,18 @@ const char* kXWalkExtensionModule = "kXWalkExtensionModule";
 
 }  // namespace
 
-XWalkExtensionModule::XWalkExtensionModule(XWalkExtensionClient* client,
-                                           XWalkModuleSystem* module_system,
-                                           const std::string& extension_name,
-                                           const std::string& extension_code)
+XWalkExtensionModule::XWalkExtensionModule(
+    XWalkExtensionClient* client,
+    XWalkModuleSystem* module_system,
+    const std::string& extension_name,
+    XWalkExtensionClient::ExtensionCodePoints* code_points)
     : extension_name_(extension_name),
-      extension_code_(extension_code),
+      code_points_(code_points),
       converter_(content::V8ValueConverter::create()),
       client_(client),
       module_system_(module_system),
-      instance_id_(0) {
+      instance_id_(0),
+      instance_shared_(false) {
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
   v8::HandleScope handle_scope(isolate);
   v8::Handle<v8::Object> function_data = v8::Object::New(isolate);
@@ -78,7 +83,9 @@ XWalkExtensionModule::~XWalkExtensionModule() {
   function_data_.Reset();
   message_listener_.Reset();
 
-  if (instance_id_)
+  if (instance_id_ && instance_shared_)
+    client_->ReleaseSharedInstance(instance_id_, this);
+  else if (instance_id_)
     client_->DestroyInstance(instance_id_);
 }
 
@@ -117,32 +124,18 @@ std::string WrapAPICode(const std::string& extension_code,
       extension_name.c_str());
 }
 
-v8::Handle<v8::Value> RunString(const std::string& code,
-                                std::string* exception) {
-  v8::Isolate* isolate = v8::Isolate::GetCurrent();
-  v8::EscapableHandleScope handle_scope(isolate);
-  v8::Handle<v8::String> v8_code(
-      v8::String::NewFromUtf8(isolate, code.c_str()));
-
-  blink::WebScopedMicrotaskSuppression suppression;
-  v8::TryCatch try_catch;
-  try_catch.SetVerbose(true);
-
-  v8::Handle<v8::Script> script(v8::Script::Compile(v8_code));
-  if (try_catch.HasCaught()) {
-    *exception = ExceptionToString(try_catch);
-    return handle_scope.Escape(
-        v8::Local<v8::Primitive>(v8::Undefined(isolate)));
-  }
-
-  v8::Local<v8::Value> result = script->Run();
-  if (try_catch.HasCaught()) {
-    *exception = ExceptionToString(try_catch);
-    return handle_scope.Escape(
-        v8::Local<v8::Primitive>(v8::Undefined(isolate)));
-  }
-
-  return handle_scope.Escape(result);
+// Returns the origin whose frames can share instances with the frame of
+// |context|, or an empty string if there is none.
+std::string GetSharingOrigin(v8::Handle<v8::Context> context) {
+  blink::WebFrame* frame = blink::WebFrame::frameForContext(context);
+  if (!frame)
+    return std::string();
+
+  // Unique origins, e.g. of sandboxed frames, are never the same.
+  blink::WebSecurityOrigin origin = frame->document().securityOrigin();
+  if (origin.isUnique())
+    return std::string();
+  return origin.toString().utf8();
 }
 
 }  // namespace
@@ -150,12 +143,20 @@ v8::Handle<v8::Value> RunString(const std::string& code,
 void XWalkExtensionModule::LoadExtensionCode(
     v8::Handle<v8::Context> context, v8::Handle<v8::Function> requireNative) {
   CHECK(!instance_id_);
-  instance_id_ = client_->CreateInstance(extension_name_, this);
+  std::string origin;
+  if (code_points_->shares_instances)
+    origin = GetSharingOrigin(context);
+
+  if (!origin.empty()) {
+    instance_id_ = client_->AcquireSharedInstance(extension_name_, origin,
+                                                  this);
+    instance_shared_ = true;
+  } else {
+    instance_id_ = client_->CreateInstance(extension_name_, this);
+  }
 
   std::string exception;
-  std::string wrapped_api_code = WrapAPICode(extension_code_, extension_name_);
-  v8::Handle<v8::Value> result =
-      RunString(wrapped_api_code, &exception);
+  v8::Handle<v8::Value> result = RunWrappedAPICode(&exception);
   if (!result->IsFunction()) {
     LOG(WARNING) << "Couldn't load JS API code for " << extension_name_
       << ": " << exception;
@@ -183,7 +184,47 @@ void XWalkExtensionModule::LoadExtensionCode(
   }
 }
 
-void XWalkExtensionModule::HandleMessageFromNative(const base::Value& msg) {
+v8::Handle<v8::Value> XWalkExtensionModule::RunWrappedAPICode(
+    std::string* exception) {
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::EscapableHandleScope handle_scope(isolate);
+
+  blink::WebScopedMicrotaskSuppression suppression;
+  v8::TryCatch try_catch;
+  try_catch.SetVerbose(true);
+
+  // Pages with many frames load the same extensions in each of them, so the
+  // wrapped code is compiled once per renderer.
+  v8::Local<v8::UnboundScript> unbound_script;
+  if (code_points_->wrapped_api_script.IsEmpty()) {
+    std::string wrapped_api_code =
+        WrapAPICode(code_points_->api, extension_name_);
+    v8::ScriptCompiler::Source source(
+        v8::String::NewFromUtf8(isolate, wrapped_api_code.c_str()));
+    unbound_script = v8::ScriptCompiler::CompileUnbound(isolate, &source);
+    if (try_catch.HasCaught()) {
+      *exception = ExceptionToString(try_catch);
+      return handle_scope.Escape(
+          v8::Local<v8::Primitive>(v8::Undefined(isolate)));
+    }
+    code_points_->wrapped_api_script.Reset(isolate, unbound_script);
+  } else {
+    unbound_script = v8::Local<v8::UnboundScript>::New(
+        isolate, code_points_->wrapped_api_script);
+  }
+
+  v8::Local<v8::Value> result = unbound_script->BindToCurrentContext()->Run();
+  if (try_catch.HasCaught()) {
+    *exception = ExceptionToString(try_catch);
+    return handle_scope.Escape(
+        v8::Local<v8::Primitive>(v8::Undefined(isolate)));
+  }
+
+  return handle_scope.Escape(result);
+}
+
+void XWalkExtensionModule::HandleMessageFromNative(
+    const IPC::Message& message, PickleIterator* iter) {
   if (message_listener_.IsEmpty())
     return;
 
@@ -192,7 +233,13 @@ void XWalkExtensionModule::HandleMessageFromNative(const base::Value& msg) {
   v8::Handle<v8::Context> context = module_system_->GetV8Context();
   v8::Context::Scope context_scope(context);
 
-  v8::Handle<v8::Value> v8_value(converter_->ToV8Value(&msg, context));
+  v8::Handle<v8::Value> v8_value(
+      serializer_.ReadValueFromList(message, iter, context));
+  if (v8_value.IsEmpty()) {
+    LOG(WARNING) << "Malformed message from extension " << extension_name_;
+    return;
+  }
+
   v8::Handle<v8::Function> message_listener =
       v8::Local<v8::Function>::New(isolate, message_listener_);;
 
@@ -215,12 +262,10 @@ void XWalkExtensionModule::PostMessageCallback(
   }
 
   v8::Handle<v8::Context> context = info.GetIsolate()->GetCurrentContext();
-  scoped_ptr<base::Value> value(
-      module->converter_->FromV8Value(info[0], context));
 
   CHECK(module->instance_id_);
-  module->client_->PostMessageToNative(module->instance_id_, value.Pass());
-  result.Set(true);
+  result.Set(module->client_->PostMessageToNative(
+      module->instance_id_, info[0], context, &module->serializer_));
 }
 
 // static
@@ -8,6 +8,7 @@
 #include <string>
 #include "xwalk/extensions/renderer/xwalk_extension_client.h"
 #include "xwalk/extensions/renderer/xwalk_module_system.h"
+#include "xwalk/extensions/renderer/xwalk_v8_value_serializer.h"
 
 namespace WebKit {
 class WebFrame;
@@ -31,10 +32,11 @@ class XWalkModuleSystem;
 // there'll be a set of different modules per v8::Context.
 class XWalkExtensionModule : public XWalkExtensionClient::InstanceHandler {
  public:
+  // |code_points| are owned by |client|.
   XWalkExtensionModule(XWalkExtensionClient* client,
                        XWalkModuleSystem* module_system,
                        const std::string& extension_name,
-                       const std::string& extension_code);
+                       XWalkExtensionClient::ExtensionCodePoints* code_points);
   virtual ~XWalkExtensionModule();
 
   // TODO(cmarcelo): Make this return a v8::Handle<v8::Object>, and
@@ -46,7 +48,8 @@ class XWalkExtensionModule : public XWalkExtensionClient::InstanceHandler {
 
  private:
   // XWalkExtensionClient::InstanceHandler implementation.
-  void HandleMessageFromNative(const base::Value& msg) override;
+  void HandleMessageFromNative(const IPC::Message& message,
+                               PickleIterator* iter) override;
 
   // Callbacks for JS functions available in 'extension' object.
   static void PostMessageCallback(
@@ -59,6 +62,11 @@ class XWalkExtensionModule : public XWalkExtensionClient::InstanceHandler {
   static XWalkExtensionModule* GetExtensionModule(
       const v8::FunctionCallbackInfo<v8::Value>& info);
 
+  // Runs the wrapped API code in the current context, which returns the
+  // function loading the API. The code is only wrapped and compiled for the
+  // first context, the script is cached in |code_points_|.
+  v8::Handle<v8::Value> RunWrappedAPICode(std::string* exception);
+
   // Template for the 'extension' object exposed to the extension JS code.
   v8::Persistent<v8::ObjectTemplate> object_template_;
 
@@ -71,15 +79,21 @@ class XWalkExtensionModule : public XWalkExtensionClient::InstanceHandler {
   v8::Persistent<v8::Function> message_listener_;
 
   std::string extension_name_;
-  std::string extension_code_;
+  XWalkExtensionClient::ExtensionCodePoints* code_points_;
 
   // TODO(cmarcelo): Move to a single converter, since we always use same
   // parameters.
   scoped_ptr<content::V8ValueConverter> converter_;
 
+  // Used for the async messages, which skip the base::Value conversion.
+  XWalkV8ValueSerializer serializer_;
+
   XWalkExtensionClient* client_;
   XWalkModuleSystem* module_system_;
   int64_t instance_id_;
+
+  // Whether |instance_id_| is shared with the other frames of the origin.
+  bool instance_shared_;
 };
 
 }  // namespace extensions
@@ -68,7 +68,7 @@ void CreateExtensionModules(XWalkExtensionClient* client,
       continue;
     scoped_ptr<XWalkExtensionModule> module(
         new XWalkExtensionModule(client, module_system,
-                                 it->first, codepoint->api));
+                                 it->first, codepoint));
     module_system->RegisterExtensionModule(module.Pass(),
                                            codepoint->entry_points);
   }
@@ -86,7 +86,7 @@ void CreateExtensionModulesWithoutDeviceAPI(XWalkExtensionClient* client,
       continue;
     scoped_ptr<XWalkExtensionModule> module(
         new XWalkExtensionModule(client, module_system,
-                                 it->first, codepoint->api));
+                                 it->first, codepoint));
     module_system->RegisterExtensionModule(module.Pass(),
                                            codepoint->entry_points);
   }
@@ -8,15 +8,16 @@ var extension_object;
 
 function wrapCallback(args, callback) {
   if (callback) {
-    var id = (callback_id++).toString();
+    // Callback IDs are integers, which are cheaper to convert and compare
+    // than strings on both sides.
+    var id = ++callback_id;
     callback_listeners[id] = callback;
     args.unshift(id);
   } else {
     // The function name and the callback ID are prepended before
-    // the arguments. If there is no callback, an empty string is
-    // should be used. This will be sorted out by the InternalInstance
-    // message handler.
-    args.unshift("");
+    // the arguments. If there is no callback, 0 should be used. This
+    // will be sorted out by the InternalInstance message handler.
+    args.unshift(0);
   }
 
   return id;
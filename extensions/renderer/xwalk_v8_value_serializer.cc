@@ -0,0 +1,336 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/renderer/xwalk_v8_value_serializer.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/float_util.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+#include "content/public/renderer/v8_value_converter.h"
+#include "ipc/ipc_message.h"
+#include "ipc/ipc_message_utils.h"
+
+namespace xwalk {
+namespace extensions {
+
+namespace {
+
+// Same nesting limit as V8ValueConverter and the IPC traits of base::Value.
+const int kMaxRecursionDepth = 100;
+
+void WriteType(IPC::Message* message, base::Value::Type type) {
+  IPC::WriteParam(message, static_cast<int>(type));
+}
+
+// Same format as IPC::ParamTraits<std::string>, without copying the string.
+void WriteString(IPC::Message* message, const v8::String::Utf8Value& utf8) {
+  IPC::WriteParam(message, utf8.length());
+  message->WriteBytes(*utf8, utf8.length());
+}
+
+v8::Handle<v8::String> NewString(v8::Isolate* isolate,
+                                 const base::StringPiece& string) {
+  return v8::String::NewFromUtf8(isolate, string.data(),
+                                 v8::String::kNormalString, string.length());
+}
+
+}  // namespace
+
+XWalkV8ValueSerializer::XWalkV8ValueSerializer()
+    : converter_(content::V8ValueConverter::create()) {
+}
+
+XWalkV8ValueSerializer::~XWalkV8ValueSerializer() {
+}
+
+bool XWalkV8ValueSerializer::WriteValueAsList(v8::Handle<v8::Value> value,
+                                              v8::Handle<v8::Context> context,
+                                              IPC::Message* message) {
+  if (!IsConvertible(value, 0))
+    return false;
+
+  context_ = context;
+  WriteType(message, base::Value::TYPE_LIST);
+  IPC::WriteParam(message, 1);
+  WriteValue(value, 0, message);
+
+  written_objects_.clear();
+  context_.Clear();
+  return true;
+}
+
+v8::Handle<v8::Value> XWalkV8ValueSerializer::ReadValueFromList(
+    const IPC::Message& message, PickleIterator* iter,
+    v8::Handle<v8::Context> context) {
+  int type;
+  int size;
+  if (!IPC::ReadParam(&message, iter, &type) ||
+      type != base::Value::TYPE_LIST ||
+      !IPC::ReadParam(&message, iter, &size) || size < 1)
+    return v8::Handle<v8::Value>();
+
+  context_ = context;
+  v8::Handle<v8::Value> value;
+  if (!ReadValue(message, iter, 0, &value))
+    value.Clear();
+
+  context_.Clear();
+  return value;
+}
+
+bool XWalkV8ValueSerializer::IsConvertible(v8::Handle<v8::Value> value,
+                                           int depth) const {
+  if (depth > kMaxRecursionDepth)
+    return false;
+
+  if (value->IsNull() || value->IsBoolean() || value->IsString())
+    return true;
+
+  // Like JSON, NaN and infinities are dropped.
+  if (value->IsNumber())
+    return value->IsInt32() || base::IsFinite(value->NumberValue());
+
+  // This also drops undefined and symbols.
+  return value->IsObject() && !value->IsFunction();
+}
+
+bool XWalkV8ValueSerializer::AddWrittenObject(
+    v8::Handle<v8::Object> object) {
+  // Different objects can have the same identity hash, so the handles are
+  // compared too.
+  int hash = object->GetIdentityHash();
+  std::pair<ObjectMap::const_iterator, ObjectMap::const_iterator> range =
+      written_objects_.equal_range(hash);
+  for (ObjectMap::const_iterator it = range.first; it != range.second; ++it) {
+    if (it->second == object)
+      return false;
+  }
+
+  written_objects_.insert(std::make_pair(hash, object));
+  return true;
+}
+
+void XWalkV8ValueSerializer::WriteValue(v8::Handle<v8::Value> value,
+                                        int depth, IPC::Message* message) {
+  if (!IsConvertible(value, depth) || value->IsNull()) {
+    WriteType(message, base::Value::TYPE_NULL);
+  } else if (value->IsBoolean()) {
+    WriteType(message, base::Value::TYPE_BOOLEAN);
+    IPC::WriteParam(message, value->BooleanValue());
+  } else if (value->IsInt32()) {
+    WriteType(message, base::Value::TYPE_INTEGER);
+    IPC::WriteParam(message, static_cast<int>(value->Int32Value()));
+  } else if (value->IsNumber()) {
+    WriteType(message, base::Value::TYPE_DOUBLE);
+    IPC::WriteParam(message, value->NumberValue());
+  } else if (value->IsString()) {
+    WriteType(message, base::Value::TYPE_STRING);
+    WriteString(message, v8::String::Utf8Value(value));
+  } else if (value->IsArray()) {
+    WriteArray(value.As<v8::Array>(), depth, message);
+  } else if (value->IsArrayBuffer() || value->IsArrayBufferView()) {
+    WriteBinary(value, message);
+  } else {
+    // Dates and regular expressions are written as plain objects.
+    WriteObject(value->ToObject(), depth, message);
+  }
+}
+
+void XWalkV8ValueSerializer::WriteArray(v8::Handle<v8::Array> array,
+                                        int depth, IPC::Message* message) {
+  if (!AddWrittenObject(array)) {
+    WriteType(message, base::Value::TYPE_NULL);
+    return;
+  }
+
+  v8::Isolate* isolate = context_->GetIsolate();
+  uint32 length = array->Length();
+  WriteType(message, base::Value::TYPE_LIST);
+  IPC::WriteParam(message, static_cast<int>(length));
+
+  for (uint32 i = 0; i < length; ++i) {
+    v8::TryCatch try_catch;
+    v8::Handle<v8::Value> child = array->Get(i);
+    if (try_catch.HasCaught()) {
+      LOG(ERROR) << "Getter for index " << i << " threw an exception.";
+      child = v8::Null(isolate);
+    }
+
+    // Holes are written as null.
+    if (!array->HasRealIndexedProperty(i))
+      child = v8::Null(isolate);
+
+    WriteValue(child, depth + 1, message);
+  }
+}
+
+void XWalkV8ValueSerializer::WriteObject(v8::Handle<v8::Object> object,
+                                         int depth, IPC::Message* message) {
+  if (!AddWrittenObject(object)) {
+    WriteType(message, base::Value::TYPE_NULL);
+    return;
+  }
+
+  WriteType(message, base::Value::TYPE_DICTIONARY);
+
+  // DOM wrappers can't be serialized, and are written as empty dictionaries.
+  if (object->InternalFieldCount()) {
+    IPC::WriteParam(message, 0);
+    return;
+  }
+
+  // The number of entries is written before them, so the values are read
+  // first to find the ones dropped.
+  v8::Isolate* isolate = context_->GetIsolate();
+  v8::Handle<v8::Array> names(object->GetOwnPropertyNames());
+  std::vector<std::pair<v8::Handle<v8::Value>, v8::Handle<v8::Value> > >
+      entries;
+  entries.reserve(names->Length());
+
+  for (uint32 i = 0; i < names->Length(); ++i) {
+    v8::Handle<v8::Value> key(names->Get(i));
+    if (!key->IsString() && !key->IsNumber()) {
+      NOTREACHED() << "Key \"" << *v8::String::Utf8Value(key)
+                   << "\" is neither a string nor a number";
+      continue;
+    }
+
+    v8::TryCatch try_catch;
+    v8::Handle<v8::Value> child = object->Get(key);
+    if (try_catch.HasCaught()) {
+      LOG(WARNING) << "Getter for property " << *v8::String::Utf8Value(key)
+                   << " threw an exception.";
+      child = v8::Null(isolate);
+    }
+
+    if (IsConvertible(child, depth + 1))
+      entries.push_back(std::make_pair(key, child));
+  }
+
+  IPC::WriteParam(message, static_cast<int>(entries.size()));
+  for (size_t i = 0; i < entries.size(); ++i) {
+    WriteString(message, v8::String::Utf8Value(entries[i].first->ToString()));
+    WriteValue(entries[i].second, depth + 1, message);
+  }
+}
+
+void XWalkV8ValueSerializer::WriteBinary(v8::Handle<v8::Value> value,
+                                         IPC::Message* message) {
+  scoped_ptr<base::Value> binary(converter_->FromV8Value(value, context_));
+  if (!binary || !binary->IsType(base::Value::TYPE_BINARY)) {
+    WriteType(message, base::Value::TYPE_NULL);
+    return;
+  }
+
+  const base::BinaryValue* binary_value =
+      static_cast<const base::BinaryValue*>(binary.get());
+  WriteType(message, base::Value::TYPE_BINARY);
+  message->WriteData(binary_value->GetBuffer(), binary_value->GetSize());
+}
+
+bool XWalkV8ValueSerializer::ReadValue(const IPC::Message& message,
+                                       PickleIterator* iter, int depth,
+                                       v8::Handle<v8::Value>* value) {
+  if (depth > kMaxRecursionDepth)
+    return false;
+
+  v8::Isolate* isolate = context_->GetIsolate();
+  int type;
+  if (!IPC::ReadParam(&message, iter, &type))
+    return false;
+
+  switch (type) {
+    case base::Value::TYPE_NULL:
+      *value = v8::Null(isolate);
+      return true;
+    case base::Value::TYPE_BOOLEAN: {
+      bool boolean;
+      if (!IPC::ReadParam(&message, iter, &boolean))
+        return false;
+      *value = v8::Boolean::New(isolate, boolean);
+      return true;
+    }
+    case base::Value::TYPE_INTEGER: {
+      int integer;
+      if (!IPC::ReadParam(&message, iter, &integer))
+        return false;
+      *value = v8::Integer::New(isolate, integer);
+      return true;
+    }
+    case base::Value::TYPE_DOUBLE: {
+      double number;
+      if (!IPC::ReadParam(&message, iter, &number))
+        return false;
+      *value = v8::Number::New(isolate, number);
+      return true;
+    }
+    case base::Value::TYPE_STRING: {
+      base::StringPiece string;
+      if (!iter->ReadStringPiece(&string))
+        return false;
+      *value = NewString(isolate, string);
+      return true;
+    }
+    case base::Value::TYPE_BINARY: {
+      const char* data;
+      int length;
+      if (!iter->ReadData(&data, &length))
+        return false;
+      scoped_ptr<base::BinaryValue> binary(
+          base::BinaryValue::CreateWithCopiedBuffer(data, length));
+      *value = converter_->ToV8Value(binary.get(), context_);
+      return true;
+    }
+    case base::Value::TYPE_DICTIONARY: {
+      int size;
+      if (!IPC::ReadParam(&message, iter, &size) || size < 0)
+        return false;
+
+      v8::Handle<v8::Object> object = v8::Object::New(isolate);
+      for (int i = 0; i < size; ++i) {
+        base::StringPiece key;
+        v8::Handle<v8::Value> child;
+        if (!iter->ReadStringPiece(&key) ||
+            !ReadValue(message, iter, depth + 1, &child))
+          return false;
+
+        v8::TryCatch try_catch;
+        object->Set(NewString(isolate, key), child);
+        if (try_catch.HasCaught())
+          LOG(ERROR) << "Setter for property " << key << " threw an exception.";
+      }
+      *value = object;
+      return true;
+    }
+    case base::Value::TYPE_LIST: {
+      int size;
+      if (!IPC::ReadParam(&message, iter, &size) || size < 0)
+        return false;
+
+      v8::Handle<v8::Array> array = v8::Array::New(isolate, size);
+      for (int i = 0; i < size; ++i) {
+        v8::Handle<v8::Value> child;
+        if (!ReadValue(message, iter, depth + 1, &child))
+          return false;
+
+        v8::TryCatch try_catch;
+        array->Set(i, child);
+        if (try_catch.HasCaught())
+          LOG(ERROR) << "Setter for index " << i << " threw an exception.";
+      }
+      *value = array;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+}  // namespace extensions
+}  // namespace xwalk
@@ -0,0 +1,85 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_EXTENSIONS_RENDERER_XWALK_V8_VALUE_SERIALIZER_H_
+#define XWALK_EXTENSIONS_RENDERER_XWALK_V8_VALUE_SERIALIZER_H_
+
+#include <map>
+
+#include "base/memory/scoped_ptr.h"
+#include "v8/include/v8.h"
+
+class PickleIterator;
+
+namespace content {
+class V8ValueConverter;
+}
+
+namespace IPC {
+class Message;
+}
+
+namespace xwalk {
+namespace extensions {
+
+// Writes JavaScript values to IPC messages and reads them back, without the
+// intermediate base::Value tree of content::V8ValueConverter.
+//
+// The values use the IPC format of a base::ListValue holding the base::Value
+// that V8ValueConverter would convert the JavaScript value to, so the
+// extension server still reads the messages as before. Values are converted
+// the same way as V8ValueConverter with its default settings, which is only
+// used for ArrayBuffers and views, since their contents belong to Blink.
+class XWalkV8ValueSerializer {
+ public:
+  XWalkV8ValueSerializer();
+  ~XWalkV8ValueSerializer();
+
+  // Writes |value| wrapped in a list to |message|. Returns false, writing
+  // nothing, if |value| has no base::Value equivalent, e.g. undefined.
+  bool WriteValueAsList(v8::Handle<v8::Value> value,
+                        v8::Handle<v8::Context> context,
+                        IPC::Message* message);
+
+  // Reads a list from |iter| and returns its first element, created in
+  // |context|. Returns an empty handle if the list is empty or malformed.
+  v8::Handle<v8::Value> ReadValueFromList(const IPC::Message& message,
+                                          PickleIterator* iter,
+                                          v8::Handle<v8::Context> context);
+
+ private:
+  typedef std::multimap<int, v8::Handle<v8::Object> > ObjectMap;
+
+  // Returns whether V8ValueConverter converts |value| at |depth|, as
+  // opposed to dropping it from dictionaries and writing null in lists.
+  bool IsConvertible(v8::Handle<v8::Value> value, int depth) const;
+
+  // Returns false if |object| was already written in the current message,
+  // in which case it is written as null like V8ValueConverter does.
+  bool AddWrittenObject(v8::Handle<v8::Object> object);
+
+  void WriteValue(v8::Handle<v8::Value> value, int depth,
+                  IPC::Message* message);
+  void WriteArray(v8::Handle<v8::Array> array, int depth,
+                  IPC::Message* message);
+  void WriteObject(v8::Handle<v8::Object> object, int depth,
+                   IPC::Message* message);
+  void WriteBinary(v8::Handle<v8::Value> value, IPC::Message* message);
+
+  bool ReadValue(const IPC::Message& message, PickleIterator* iter, int depth,
+                 v8::Handle<v8::Value>* value);
+
+  scoped_ptr<content::V8ValueConverter> converter_;
+
+  // State of the message being written or read.
+  v8::Handle<v8::Context> context_;
+  ObjectMap written_objects_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkV8ValueSerializer);
+};
+
+}  // namespace extensions
+}  // namespace xwalk
+
+#endif  // XWALK_EXTENSIONS_RENDERER_XWALK_V8_VALUE_SERIALIZER_H_
@@ -0,0 +1,217 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/renderer/xwalk_v8_value_serializer.h"
+
+#include <string>
+
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/pickle.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "content/public/renderer/v8_value_converter.h"
+#include "gin/test/v8_test.h"
+#include "ipc/ipc_message.h"
+#include "ipc/ipc_message_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using xwalk::extensions::XWalkV8ValueSerializer;
+
+namespace {
+
+// Messages as posted by the sysapps JavaScript code (see
+// xwalk/sysapps/common/common_api.js) and as replied by their native side.
+const char* kSysAppsPayloads[] = {
+  "['callObjectMethod', 12, 3, 'getCPUInfo']",
+  "['addEventListener', 0, 3, 'storageattach']",
+  "[12, { archName: 'x86_64', numOfProcessors: 4, load: 0.2532 }, null]",
+  "[13, { storages: ["
+  "  { id: '/dev/sda1', name: 'Internal', type: 'fixed',"
+  "    capacity: 250059350016 },"
+  "  { id: '/dev/sdb1', name: 'USB Disk', type: 'removable',"
+  "    capacity: 16008609792 }] }, null]",
+  "[14, { audioCodecs: [{ format: 'mp3' }, { format: 'vorbis' },"
+  "                     { format: 'aac' }],"
+  "       videoCodecs: [{ format: 'h264', hwAccel: true, encode: false },"
+  "                     { format: 'vp8', hwAccel: false, encode: true }] },"
+  " null]",
+  "[15, null, { message: 'Not found', name: 'NotFoundError', code: 8 }]",
+};
+
+// Values V8ValueConverter drops or writes as null.
+const char* kSpecialValues[] = {
+  "({ a: undefined, b: function() {}, c: NaN, d: Infinity, e: null })",
+  "[undefined, function() {}, -Infinity, null, , 1]",
+  "(function() { var o = { a: 1 }; return [o, { b: o }, o]; })()",
+  "(function() { var o = { a: 1 }; o.self = o; return o; })()",
+  "({ 1: 'number key', date: new Date(0), regexp: /a/, neg: -0 })",
+  "'\\u00e9t\\u00e9 \\u2603'",
+  "2147483648",
+  "true",
+};
+
+const int kBenchmarkIterations = 20000;
+
+}  // namespace
+
+class XWalkV8ValueSerializerTest : public gin::V8Test {
+ protected:
+  void SetUp() override {
+    gin::V8Test::SetUp();
+    converter_.reset(content::V8ValueConverter::create());
+  }
+
+  v8::Isolate* isolate() { return instance_->isolate(); }
+
+  v8::Handle<v8::Context> context() {
+    return v8::Local<v8::Context>::New(isolate(), context_);
+  }
+
+  v8::Handle<v8::Value> Eval(const std::string& source) {
+    return v8::Script::Compile(
+        v8::String::NewFromUtf8(isolate(), source.c_str()))->Run();
+  }
+
+  // Writes |value| with the serializer and reads it back with the IPC
+  // traits the extension server uses.
+  scoped_ptr<base::Value> WriteAndReadAsValue(v8::Handle<v8::Value> value) {
+    IPC::Message message;
+    if (!serializer_.WriteValueAsList(value, context(), &message))
+      return scoped_ptr<base::Value>();
+
+    PickleIterator iter(message);
+    base::ListValue list;
+    if (!IPC::ReadParam(&message, &iter, &list))
+      return scoped_ptr<base::Value>();
+
+    scoped_ptr<base::Value> result;
+    list.Remove(0, &result);
+    return result.Pass();
+  }
+
+  // Writes |value| with the IPC traits the extension server uses and reads
+  // it back with the serializer.
+  v8::Handle<v8::Value> WriteAsValueAndRead(const base::Value& value) {
+    base::ListValue list;
+    list.Append(value.DeepCopy());
+    IPC::Message message;
+    IPC::WriteParam(&message, list);
+
+    PickleIterator iter(message);
+    return serializer_.ReadValueFromList(message, &iter, context());
+  }
+
+  void ExpectSameAsConverter(const std::string& source) {
+    SCOPED_TRACE(source);
+    v8::Handle<v8::Value> value = Eval(source);
+
+    scoped_ptr<base::Value> expected(converter_->FromV8Value(value,
+                                                             context()));
+    scoped_ptr<base::Value> written(WriteAndReadAsValue(value));
+    ASSERT_TRUE(expected);
+    ASSERT_TRUE(written);
+    EXPECT_TRUE(expected->Equals(written.get()));
+
+    v8::Handle<v8::Value> read = WriteAsValueAndRead(*expected);
+    ASSERT_FALSE(read.IsEmpty());
+    scoped_ptr<base::Value> read_back(converter_->FromV8Value(read,
+                                                              context()));
+    EXPECT_TRUE(expected->Equals(read_back.get()));
+  }
+
+  scoped_ptr<content::V8ValueConverter> converter_;
+  XWalkV8ValueSerializer serializer_;
+};
+
+TEST_F(XWalkV8ValueSerializerTest, SysAppsPayloads) {
+  v8::HandleScope handle_scope(isolate());
+  for (size_t i = 0; i < arraysize(kSysAppsPayloads); ++i)
+    ExpectSameAsConverter(kSysAppsPayloads[i]);
+}
+
+TEST_F(XWalkV8ValueSerializerTest, SpecialValues) {
+  v8::HandleScope handle_scope(isolate());
+  for (size_t i = 0; i < arraysize(kSpecialValues); ++i)
+    ExpectSameAsConverter(kSpecialValues[i]);
+}
+
+TEST_F(XWalkV8ValueSerializerTest, NotConvertible) {
+  v8::HandleScope handle_scope(isolate());
+  IPC::Message message;
+  EXPECT_FALSE(serializer_.WriteValueAsList(Eval("undefined"), context(),
+                                            &message));
+  EXPECT_FALSE(serializer_.WriteValueAsList(Eval("(function() {})"),
+                                            context(), &message));
+  EXPECT_FALSE(serializer_.WriteValueAsList(Eval("NaN"), context(),
+                                            &message));
+  EXPECT_EQ(0u, message.payload_size());
+}
+
+TEST_F(XWalkV8ValueSerializerTest, MalformedMessages) {
+  v8::HandleScope handle_scope(isolate());
+
+  // Empty list.
+  IPC::Message empty;
+  IPC::WriteParam(&empty, base::ListValue());
+  PickleIterator empty_iter(empty);
+  EXPECT_TRUE(
+      serializer_.ReadValueFromList(empty, &empty_iter, context()).IsEmpty());
+
+  // Truncated dictionary.
+  IPC::Message truncated;
+  IPC::WriteParam(&truncated, static_cast<int>(base::Value::TYPE_LIST));
+  IPC::WriteParam(&truncated, 1);
+  IPC::WriteParam(&truncated, static_cast<int>(base::Value::TYPE_DICTIONARY));
+  IPC::WriteParam(&truncated, 2);
+  IPC::WriteParam(&truncated, std::string("key"));
+  PickleIterator truncated_iter(truncated);
+  EXPECT_TRUE(serializer_.ReadValueFromList(truncated, &truncated_iter,
+                                            context()).IsEmpty());
+}
+
+// Compares the serializer with the base::Value conversion it replaces. Run
+// with --gtest_also_run_disabled_tests to print the results.
+TEST_F(XWalkV8ValueSerializerTest, DISABLED_Benchmark) {
+  for (size_t i = 0; i < arraysize(kSysAppsPayloads); ++i) {
+    v8::HandleScope handle_scope(isolate());
+    v8::Handle<v8::Value> value = Eval(kSysAppsPayloads[i]);
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int j = 0; j < kBenchmarkIterations; ++j) {
+      v8::HandleScope iteration_scope(isolate());
+      scoped_ptr<base::Value> converted(
+          converter_->FromV8Value(value, context()));
+      base::ListValue list;
+      list.Append(converted.release());
+      IPC::Message message;
+      IPC::WriteParam(&message, list);
+
+      PickleIterator iter(message);
+      base::ListValue read;
+      const base::Value* read_value;
+      IPC::ReadParam(&message, &iter, &read);
+      read.Get(0, &read_value);
+      converter_->ToV8Value(read_value, context());
+    }
+    base::TimeDelta converter_time = base::TimeTicks::Now() - start;
+
+    start = base::TimeTicks::Now();
+    for (int j = 0; j < kBenchmarkIterations; ++j) {
+      v8::HandleScope iteration_scope(isolate());
+      IPC::Message message;
+      serializer_.WriteValueAsList(value, context(), &message);
+
+      PickleIterator iter(message);
+      serializer_.ReadValueFromList(message, &iter, context());
+    }
+    base::TimeDelta serializer_time = base::TimeTicks::Now() - start;
+
+    LOG(INFO) << "Payload " << i << ": converter "
+              << converter_time.InMicrosecondsF() / kBenchmarkIterations
+              << "us, serializer "
+              << serializer_time.InMicrosecondsF() / kBenchmarkIterations
+              << "us per round trip.";
+  }
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#if defined(__cplusplus)
+#error "This file is written in C to make sure the C API works as intended."
+#endif
+
+// Extension used by the XESh messaging benchmark, see
+// xwalk/extensions/xesh/xesh_benchmark.js.
+//
+// Messages have the form "<command><request id>:<body>", where the command is
+// 'e' to echo the body back or 'g' to generate a reply of the size given in
+// the body. Replies have the form "<request id>:<body>", so several requests
+// can be in flight at the same time.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "xwalk/extensions/public/XW_Extension.h"
+#include "xwalk/extensions/public/XW_Extension_SyncMessage.h"
+
+static const char* kSource_benchmark_api =
+"var callbacks = {};"
+"var nextRequestId = 1;"
+""
+"extension.setMessageListener(function(msg) {"
+"  var separator = msg.indexOf(':');"
+"  var id = msg.substring(0, separator);"
+"  var callback = callbacks[id];"
+"  delete callbacks[id];"
+"  callback(msg.length - separator - 1);"
+"});"
+""
+"function post(command, body, callback) {"
+"  var id = nextRequestId++;"
+"  callbacks[id] = callback;"
+"  extension.postMessage(command + id + ':' + body);"
+"};"
+""
+"function send(command, body) {"
+"  var reply = extension.internal.sendSyncMessage(command + '0:' + body);"
+"  return reply.length - reply.indexOf(':') - 1;"
+"};"
+""
+"exports.echo = function(payload, callback) {"
+"  post('e', payload, callback);"
+"};"
+"exports.generate = function(size, callback) {"
+"  post('g', size, callback);"
+"};"
+"exports.syncEcho = function(payload) {"
+"  return send('e', payload);"
+"};"
+"exports.syncGenerate = function(size) {"
+"  return send('g', size);"
+"};"
+;
+
+static XW_Extension g_extension = 0;
+static const XW_CoreInterface* g_core = NULL;
+static const XW_MessagingInterface* g_messaging = NULL;
+static const XW_Internal_SyncMessagingInterface* g_sync_messaging = NULL;
+
+// Returns the reply to |message|, which has to be freed by the caller, or
+// NULL if the message is malformed.
+static char* create_reply(const char* message) {
+  const char* separator = strchr(message, ':');
+  if (!separator)
+    return NULL;
+
+  size_t id_length = separator - message;
+  if (message[0] == 'e')
+    return strdup(message + 1);
+
+  if (message[0] != 'g')
+    return NULL;
+
+  int size = atoi(separator + 1);
+  if (size < 0)
+    return NULL;
+
+  char* reply = malloc(id_length + size + 1);
+  memcpy(reply, message + 1, id_length);
+  memset(reply + id_length, 'p', size);
+  reply[id_length + size] = '\0';
+  return reply;
+}
+
+static void handle_message(XW_Instance instance, const char* message) {
+  char* reply = create_reply(message);
+  if (!reply) {
+    fprintf(stderr, "Malformed benchmark message.\n");
+    return;
+  }
+
+  g_messaging->PostMessage(instance, reply);
+  free(reply);
+}
+
+static void handle_sync_message(XW_Instance instance, const char* message) {
+  char* reply = create_reply(message);
+  if (!reply) {
+    fprintf(stderr, "Malformed benchmark message.\n");
+    g_sync_messaging->SetSyncReply(instance, ":");
+    return;
+  }
+
+  g_sync_messaging->SetSyncReply(instance, reply);
+  free(reply);
+}
+
+int32_t XW_Initialize(XW_Extension extension, XW_GetInterface get_interface) {
+  g_extension = extension;
+  g_core = get_interface(XW_CORE_INTERFACE);
+  g_core->SetExtensionName(extension, "benchmark");
+  g_core->SetJavaScriptAPI(extension, kSource_benchmark_api);
+
+  g_messaging = get_interface(XW_MESSAGING_INTERFACE);
+  g_messaging->Register(extension, handle_message);
+
+  g_sync_messaging = get_interface(XW_INTERNAL_SYNC_MESSAGING_INTERFACE);
+  g_sync_messaging->Register(extension, handle_sync_message);
+
+  return XW_OK;
+}
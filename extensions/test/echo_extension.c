@@ -14,6 +14,7 @@
 XW_Extension g_extension = 0;
 const XW_CoreInterface* g_core = NULL;
 const XW_MessagingInterface* g_messaging = NULL;
+const struct XW_MessagingInterface_2* g_messaging2 = NULL;
 const XW_Internal_SyncMessagingInterface* g_sync_messaging = NULL;
 
 void instance_created(XW_Instance instance) {
@@ -28,6 +29,11 @@ void handle_message(XW_Instance instance, const char* message) {
   g_messaging->PostMessage(instance, message);
 }
 
+void handle_binary_message(XW_Instance instance, void* data, size_t size) {
+  // Echoes the received buffer back without copying it.
+  g_messaging2->PostBuffer(instance, data, size);
+}
+
 void handle_sync_message(XW_Instance instance, const char* message) {
   g_sync_messaging->SetSyncReply(instance, message);
 }
@@ -63,6 +69,9 @@ int32_t XW_Initialize(XW_Extension extension, XW_GetInterface get_interface) {
   g_messaging = get_interface(XW_MESSAGING_INTERFACE);
   g_messaging->Register(extension, handle_message);
 
+  g_messaging2 = get_interface(XW_MESSAGING_INTERFACE_2);
+  g_messaging2->RegisterBinary(extension, handle_binary_message);
+
   g_sync_messaging = get_interface(XW_INTERNAL_SYNC_MESSAGING_INTERFACE);
   g_sync_messaging->Register(extension, handle_sync_message);
 
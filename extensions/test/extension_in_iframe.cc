@@ -21,6 +21,7 @@ namespace {
 
 base::Lock g_count_lock;
 int g_count = 0;
+int g_shared_instances = 0;
 
 }
 
@@ -51,11 +52,31 @@ class CounterExtension : public XWalkExtension {
   }
 };
 
+class SharedCounterExtension : public XWalkExtension {
+ public:
+  SharedCounterExtension()
+      : XWalkExtension() {
+    set_name("sharedCounter");
+    set_shares_instances(true);
+    set_javascript_api(
+        "exports.count = function() {"
+        "  extension.postMessage('PING');"
+        "};");
+  }
+
+  XWalkExtensionInstance* CreateInstance() override {
+    base::AutoLock lock(g_count_lock);
+    g_shared_instances++;
+    return new CounterExtensionContext();
+  }
+};
+
 class XWalkExtensionsIFrameTest : public XWalkExtensionsTestBase {
  public:
   void CreateExtensionsForUIThread(
       XWalkExtensionVector* extensions) override {
     extensions->push_back(new CounterExtension);
+    extensions->push_back(new SharedCounterExtension);
   }
 };
 
@@ -69,6 +90,17 @@ IN_PROC_BROWSER_TEST_F(XWalkExtensionsIFrameTest,
   ASSERT_EQ(g_count, 3);
 }
 
+IN_PROC_BROWSER_TEST_F(XWalkExtensionsIFrameTest,
+                       SameOriginIFramesShareInstances) {
+  Runtime* runtime = CreateRuntime();
+  GURL url = GetExtensionsTestURL(base::FilePath(),
+      base::FilePath().AppendASCII("shared_counter_with_iframes.html"));
+  xwalk_test_utils::NavigateToURL(runtime, url);
+  SPIN_FOR_1_SECOND_OR_UNTIL_TRUE(g_count == 3);
+  ASSERT_EQ(g_count, 3);
+  ASSERT_EQ(g_shared_instances, 1);
+}
+
 IN_PROC_BROWSER_TEST_F(XWalkExtensionsIFrameTest,
                        ContextsAreNotCreatedForIFramesWithBlankPages) {
   Runtime* runtime = CreateRuntime();
@@ -78,6 +78,17 @@ IN_PROC_BROWSER_TEST_F(ExternalExtensionTest, ExternalExtensionSync) {
   EXPECT_EQ(kPassString, title_watcher.WaitAndGetTitle());
 }
 
+IN_PROC_BROWSER_TEST_F(ExternalExtensionTest, ExternalExtensionBinary) {
+  Runtime* runtime = CreateRuntime();
+  GURL url = GetExtensionsTestURL(
+      base::FilePath(),
+      base::FilePath().AppendASCII("binary_echo.html"));
+  content::TitleWatcher title_watcher(runtime->web_contents(), kPassString);
+  title_watcher.AlsoWaitForTitle(kFailString);
+  xwalk_test_utils::NavigateToURL(runtime, url);
+  EXPECT_EQ(kPassString, title_watcher.WaitAndGetTitle());
+}
+
 IN_PROC_BROWSER_TEST_F(RuntimeInterfaceTest, GetRuntimeVariable) {
   Runtime* runtime = CreateRuntime();
   GURL url = GetExtensionsTestURL(
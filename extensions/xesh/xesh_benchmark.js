@@ -0,0 +1,200 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Extension messaging benchmark, run by xesh_benchmark.sh with the benchmark
+// extension (xwalk/extensions/test/benchmark_extension.c) loaded.
+//
+// Every case measures the round-trip latency of a message and the throughput,
+// for a given mode:
+//   - async: extension.postMessage() and the message listener.
+//   - sync: extension.internal.sendSyncMessage().
+// and a given payload:
+//   - echo: the payload is sent in the request and echoed back.
+//   - generate: the request only carries the size, and the payload is
+//     generated by the native side.
+// The payload sizes cover both async replies sent inline in the IPC message
+// and the ones sent out of line through shared memory, above 256KB (see
+// XWalkExtensionServer::PostMessageToJSCallback). Async cases also run with
+// several requests in flight at the same time.
+//
+// The results are printed to stdout as a single JSON object.
+
+var kPayloadSizes = [16, 1024, 64 * 1024, 200 * 1024, 512 * 1024,
+                     1024 * 1024];
+var kConcurrencies = [1, 4, 16];
+
+// Async replies bigger than this are sent out of line.
+var kInlineMessageMaxSize = 256 * 1024;
+
+// Number of bytes moved by each case, bounded in number of messages so small
+// payloads don't take forever and large ones still have enough samples.
+var kBytesPerCase = 32 * 1024 * 1024;
+var kMinIterations = 20;
+var kMaxIterations = 2000;
+var kWarmUpIterations = 10;
+
+function iterationsFor(size) {
+  return Math.max(kMinIterations,
+      Math.min(kMaxIterations, Math.floor(kBytesPerCase / size)));
+}
+
+function makePayload(size) {
+  var payload = "p";
+  while (payload.length < size)
+    payload += payload;
+  return payload.substring(0, size);
+}
+
+function percentile(sorted, p) {
+  var index = Math.min(sorted.length - 1,
+                       Math.ceil(p / 100 * sorted.length) - 1);
+  return sorted[Math.max(0, index)];
+}
+
+function summarize(config, latencies, elapsed) {
+  latencies.sort(function(a, b) { return a - b; });
+
+  var total = 0;
+  for (var i = 0; i < latencies.length; ++i)
+    total += latencies[i];
+
+  var seconds = elapsed / 1000;
+  return {
+    mode: config.mode,
+    payload: config.payload,
+    transport: config.mode == "async" && config.size > kInlineMessageMaxSize ?
+        "outofline" : "inline",
+    size: config.size,
+    concurrency: config.concurrency,
+    iterations: latencies.length,
+    latency_ms: {
+      min: latencies[0],
+      mean: total / latencies.length,
+      p50: percentile(latencies, 50),
+      p90: percentile(latencies, 90),
+      p99: percentile(latencies, 99),
+      max: latencies[latencies.length - 1],
+    },
+    messages_per_second: latencies.length / seconds,
+    bytes_per_second: latencies.length * config.size / seconds,
+  };
+}
+
+function runSyncCase(config) {
+  var payload = makePayload(config.size);
+  var send = config.payload == "echo" ?
+      function() { return benchmark.syncEcho(payload); } :
+      function() { return benchmark.syncGenerate(config.size); };
+
+  for (var i = 0; i < kWarmUpIterations; ++i)
+    send();
+
+  var latencies = [];
+  var start = now();
+  for (var i = 0; i < config.iterations; ++i) {
+    var sent = now();
+    if (send() != config.size)
+      throw new Error("Unexpected reply size for " + JSON.stringify(config));
+    latencies.push(now() - sent);
+  }
+
+  return summarize(config, latencies, now() - start);
+}
+
+function runAsyncCase(config, done) {
+  var payload = makePayload(config.size);
+  var post = config.payload == "echo" ?
+      function(callback) { benchmark.echo(payload, callback); } :
+      function(callback) { benchmark.generate(config.size, callback); };
+
+  var latencies = [];
+  var warm_up = kWarmUpIterations;
+  var sent = 0;
+  var start;
+
+  function sendNext() {
+    if (warm_up > 0) {
+      warm_up--;
+      post(function() {
+        if (warm_up == 0)
+          startMeasuring();
+        else
+          sendNext();
+      });
+      return;
+    }
+
+    if (sent == config.iterations)
+      return;
+
+    sent++;
+    var sent_time = now();
+    post(function(size) {
+      if (size != config.size)
+        throw new Error("Unexpected reply size for " + JSON.stringify(config));
+
+      latencies.push(now() - sent_time);
+      if (latencies.length == config.iterations)
+        done(summarize(config, latencies, now() - start));
+      else
+        sendNext();
+    });
+  }
+
+  function startMeasuring() {
+    // Keeps |concurrency| requests in flight, each reply sends the next one.
+    start = now();
+    for (var i = 0; i < config.concurrency; ++i)
+      sendNext();
+  }
+
+  sendNext();
+}
+
+function makeCases() {
+  var cases = [];
+  var payloads = ["echo", "generate"];
+
+  for (var p = 0; p < payloads.length; ++p) {
+    for (var s = 0; s < kPayloadSizes.length; ++s) {
+      var size = kPayloadSizes[s];
+      cases.push({ mode: "sync", payload: payloads[p], size: size,
+                   concurrency: 1, iterations: iterationsFor(size) });
+
+      for (var c = 0; c < kConcurrencies.length; ++c) {
+        cases.push({ mode: "async", payload: payloads[p], size: size,
+                     concurrency: kConcurrencies[c],
+                     iterations: iterationsFor(size) });
+      }
+    }
+  }
+
+  return cases;
+}
+
+(function() {
+  var cases = makeCases();
+  var results = [];
+
+  function runNext() {
+    if (results.length == cases.length) {
+      print(JSON.stringify({ benchmark: "xesh_messaging", results: results }));
+      quit;
+    }
+
+    var config = cases[results.length];
+    if (config.mode == "sync") {
+      results.push(runSyncCase(config));
+      runNext();
+      return;
+    }
+
+    runAsyncCase(config, function(result) {
+      results.push(result);
+      runNext();
+    });
+  }
+
+  runNext();
+})();
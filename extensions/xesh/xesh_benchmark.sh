@@ -0,0 +1,56 @@
+#!/bin/bash
+# Copyright (c) 2015 Intel Corporation. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+# Runs the extension messaging benchmark in XESh and writes the results as
+# JSON to OUTPUT_FILE, or to stdout.
+
+BUILD_DIR=$1
+OUTPUT_FILE=$2
+SCRIPT_DIR=$(cd $(dirname $0) && pwd)
+
+# Upper bound for a run, in seconds.
+TIMEOUT=600
+
+if [ $# -eq 0 ]; then
+   echo -e "\nUsage: $0 PATH_TO_BUILD_DIR [OUTPUT_FILE] (i.e.: $0 ../../../out/Release/ results.json)."
+   exit 1
+fi
+
+if [ ! -x $BUILD_DIR/xesh ]; then
+   echo -e "\nPlease make sure XEsh is built in $BUILD_DIR"
+   exit 1
+fi
+
+# The replies of async messages are only delivered after the script returns,
+# so XESh must not exit because stdin is closed. It is fed by a FIFO that
+# stays open until the benchmark quits or the timeout expires.
+TEMP_DIR=$(mktemp -d)
+mkfifo $TEMP_DIR/stdin
+sleep $TIMEOUT > $TEMP_DIR/stdin &
+SLEEP_PID=$!
+
+$BUILD_DIR/xesh \
+    --external-extensions-path=$BUILD_DIR/tests/extension/benchmark_extension \
+    --input-file=$SCRIPT_DIR/xesh_benchmark.js \
+    < $TEMP_DIR/stdin 1> $TEMP_DIR/stdout 2> $TEMP_DIR/stderr
+
+kill $SLEEP_PID 2> /dev/null
+
+RESULT=`grep '^{"benchmark"' $TEMP_DIR/stdout`
+if [ -z "$RESULT" ]; then
+   echo -e "XESh Benchmark: FAIL."
+   cat $TEMP_DIR/stderr
+   rm -rf $TEMP_DIR
+   exit 1
+fi
+
+if [ -n "$OUTPUT_FILE" ]; then
+   echo "$RESULT" > $OUTPUT_FILE
+else
+   echo "$RESULT"
+fi
+
+rm -rf $TEMP_DIR
+exit 0
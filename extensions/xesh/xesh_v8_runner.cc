@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include "base/logging.h"
 #include "base/strings/stringprintf.h"
+#include "base/time/time.h"
 #include "xwalk/extensions/renderer/xwalk_extension_module.h"
 #include "xwalk/extensions/renderer/xwalk_module_system.h"
 #include "xwalk/extensions/renderer/xwalk_v8tools_module.h"
@@ -41,6 +42,9 @@ void XEShV8Runner::Shutdown() {
 
   context->Exit();
   v8_context_.Reset();
+  // |client_| outlives the isolate, its handles are released while the
+  // isolate is still alive.
+  client_.ReleaseCachedScripts();
   v8::V8::Dispose();
 }
 
@@ -152,6 +156,9 @@ void XEShV8Runner::RegisterAccessors() {
   context->Global()->Set(
       v8::String::NewFromUtf8(isolate, "print"),
       v8::FunctionTemplate::New(isolate, PrintCallback)->GetFunction());
+  context->Global()->Set(
+      v8::String::NewFromUtf8(isolate, "now"),
+      v8::FunctionTemplate::New(isolate, NowCallback)->GetFunction());
   context->Global()->SetAccessor(
       v8::String::NewFromUtf8(isolate, "quit"),
       QuitCallback);
@@ -177,6 +184,15 @@ void XEShV8Runner::PrintCallback(
   fflush(stdout);
 }
 
+// static
+void XEShV8Runner::NowCallback(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  // Monotonic time in milliseconds with microsecond resolution, Date.now()
+  // is too coarse for measuring a message round-trip.
+  const base::TimeDelta now = base::TimeTicks::Now() - base::TimeTicks();
+  args.GetReturnValue().Set(now.InMicroseconds() / 1000.0);
+}
+
 // static
 void XEShV8Runner::QuitCallback(v8::Local<v8::String> property,
     const v8::PropertyCallbackInfo<v8::Value>& info) {
@@ -58,6 +58,7 @@ class XEShV8Runner {
   std::string ReportException(v8::TryCatch* try_catch);
 
   static void PrintCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void NowCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void QuitCallback(v8::Local<v8::String> property,
       const v8::PropertyCallbackInfo<v8::Value>& info);
 
@@ -0,0 +1,120 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/directory_enumerator.h"
+
+#include "base/bind.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/location.h"
+#include "base/single_thread_task_runner.h"
+#include "base/task_runner.h"
+#include "base/thread_task_runner_handle.h"
+#include "net/base/net_errors.h"
+
+namespace xwalk {
+
+DirectoryEnumerator::DirectoryEnumerator(
+    const base::FilePath& path,
+    size_t chunk_size,
+    scoped_refptr<base::TaskRunner> task_runner,
+    const ChunkCallback& chunk_callback,
+    const DoneCallback& done_callback)
+    : path_(path),
+      chunk_size_(chunk_size),
+      task_runner_(task_runner),
+      chunk_callback_(chunk_callback),
+      done_callback_(done_callback) {
+  DCHECK_GT(chunk_size_, 0u);
+}
+
+DirectoryEnumerator::~DirectoryEnumerator() {}
+
+bool DirectoryEnumerator::Start() {
+  DCHECK(!origin_task_runner_.get());
+  origin_task_runner_ = base::ThreadTaskRunnerHandle::Get();
+  return task_runner_->PostTask(
+      FROM_HERE, base::Bind(&DirectoryEnumerator::ReadChunk, this));
+}
+
+void DirectoryEnumerator::Cancel() {
+  DCHECK(!origin_task_runner_.get() ||
+         origin_task_runner_->BelongsToCurrentThread());
+  cancelled_.Set();
+}
+
+void DirectoryEnumerator::ReadChunk() {
+  if (cancelled_.IsSet())
+    return;
+
+  if (!enumerator_.get()) {
+    if (!base::DirectoryExists(path_)) {
+      origin_task_runner_->PostTask(
+          FROM_HERE, base::Bind(&DirectoryEnumerator::RunDoneCallback, this,
+                                net::ERR_FILE_NOT_FOUND));
+      return;
+    }
+
+    enumerator_.reset(new base::FileEnumerator(
+        path_, true /* recursive */,
+        base::FileEnumerator::FILES | base::FileEnumerator::DIRECTORIES));
+  }
+
+  scoped_ptr<std::vector<base::FilePath> > paths(
+      new std::vector<base::FilePath>);
+  bool done = false;
+  while (paths->size() < chunk_size_) {
+    base::FilePath entry = enumerator_->Next();
+    if (entry.empty()) {
+      done = true;
+      break;
+    }
+
+    if (cancelled_.IsSet())
+      return;
+
+    // This only checks the flags of the entry, there is no file I/O.
+    if (enumerator_->GetInfo().IsDirectory())
+      paths->push_back(entry.Append(FILE_PATH_LITERAL(".")));
+    else
+      paths->push_back(entry);
+  }
+
+  if (done)
+    enumerator_.reset();
+
+  origin_task_runner_->PostTask(
+      FROM_HERE, base::Bind(&DirectoryEnumerator::OnChunkRead, this,
+                            base::Passed(&paths), done));
+}
+
+void DirectoryEnumerator::OnChunkRead(
+    scoped_ptr<std::vector<base::FilePath> > paths, bool done) {
+  if (cancelled_.IsSet())
+    return;
+
+  if (!paths->empty())
+    chunk_callback_.Run(*paths);
+  paths.reset();
+
+  // The enumeration can be cancelled by |chunk_callback_|.
+  if (cancelled_.IsSet())
+    return;
+
+  if (done) {
+    done_callback_.Run(net::OK);
+    return;
+  }
+
+  if (!task_runner_->PostTask(
+          FROM_HERE, base::Bind(&DirectoryEnumerator::ReadChunk, this)))
+    done_callback_.Run(net::ERR_ABORTED);
+}
+
+void DirectoryEnumerator::RunDoneCallback(int error) {
+  if (!cancelled_.IsSet())
+    done_callback_.Run(error);
+}
+
+}  // namespace xwalk
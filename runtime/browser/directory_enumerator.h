@@ -0,0 +1,84 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_DIRECTORY_ENUMERATOR_H_
+#define XWALK_RUNTIME_BROWSER_DIRECTORY_ENUMERATOR_H_
+
+#include <vector>
+
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/cancellation_flag.h"
+
+namespace base {
+class FileEnumerator;
+class SingleThreadTaskRunner;
+class TaskRunner;
+}
+
+namespace xwalk {
+
+// Enumerates a directory recursively on |task_runner|, and passes the
+// entries back to the thread it was started on in chunks of at most
+// |chunk_size| entries. The next chunk is only read once the previous one
+// was passed to |chunk_callback|, so a large directory neither keeps the
+// calling thread busy at once nor piles up in its queue, and the
+// enumeration can be stopped midway.
+//
+// Directories are listed as "<directory>/.", so that empty directories are
+// included, as directory uploads expect.
+class DirectoryEnumerator
+    : public base::RefCountedThreadSafe<DirectoryEnumerator> {
+ public:
+  typedef base::Callback<void(const std::vector<base::FilePath>&)>
+      ChunkCallback;
+  // Called with a net error code once all the chunks were passed.
+  typedef base::Callback<void(int)> DoneCallback;
+
+  DirectoryEnumerator(const base::FilePath& path,
+                      size_t chunk_size,
+                      scoped_refptr<base::TaskRunner> task_runner,
+                      const ChunkCallback& chunk_callback,
+                      const DoneCallback& done_callback);
+
+  // Returns false if the enumeration could not be started, no callback is
+  // run then.
+  bool Start();
+
+  // No callback is run after this is called on the thread the enumeration
+  // was started on.
+  void Cancel();
+
+ private:
+  friend class base::RefCountedThreadSafe<DirectoryEnumerator>;
+  ~DirectoryEnumerator();
+
+  // Called on |task_runner_|.
+  void ReadChunk();
+
+  // Called on the thread the enumeration was started on.
+  void OnChunkRead(scoped_ptr<std::vector<base::FilePath> > paths, bool done);
+  void RunDoneCallback(int error);
+
+  const base::FilePath path_;
+  const size_t chunk_size_;
+  scoped_refptr<base::TaskRunner> task_runner_;
+  scoped_refptr<base::SingleThreadTaskRunner> origin_task_runner_;
+  base::CancellationFlag cancelled_;
+
+  // Only used by ReadChunk(), which reads one chunk at a time.
+  scoped_ptr<base::FileEnumerator> enumerator_;
+
+  // Only run on the thread the enumeration was started on.
+  ChunkCallback chunk_callback_;
+  DoneCallback done_callback_;
+
+  DISALLOW_COPY_AND_ASSIGN(DirectoryEnumerator);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_DIRECTORY_ENUMERATOR_H_
@@ -0,0 +1,138 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/directory_enumerator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/message_loop/message_loop.h"
+#include "base/test/test_simple_task_runner.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using xwalk::DirectoryEnumerator;
+
+namespace {
+
+class DirectoryEnumeratorTest : public testing::Test {
+ protected:
+  DirectoryEnumeratorTest()
+      : task_runner_(new base::TestSimpleTaskRunner),
+        done_(false),
+        error_(net::OK) {}
+
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+  }
+
+  scoped_refptr<DirectoryEnumerator> CreateEnumerator(
+      const base::FilePath& path, size_t chunk_size) {
+    return new DirectoryEnumerator(
+        path, chunk_size, task_runner_,
+        base::Bind(&DirectoryEnumeratorTest::OnChunk, base::Unretained(this)),
+        base::Bind(&DirectoryEnumeratorTest::OnDone, base::Unretained(this)));
+  }
+
+  bool CreateFile(const base::FilePath& path) {
+    return base::WriteFile(path, "x", 1) == 1;
+  }
+
+  void OnChunk(const std::vector<base::FilePath>& paths) {
+    chunk_sizes_.push_back(paths.size());
+    paths_.insert(paths_.end(), paths.begin(), paths.end());
+  }
+
+  void OnDone(int error) {
+    done_ = true;
+    error_ = error;
+  }
+
+  base::MessageLoop message_loop_;
+  base::ScopedTempDir temp_dir_;
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner_;
+
+  std::vector<size_t> chunk_sizes_;
+  std::vector<base::FilePath> paths_;
+  bool done_;
+  int error_;
+};
+
+}  // namespace
+
+TEST_F(DirectoryEnumeratorTest, EnumeratesInChunks) {
+  const base::FilePath& root = temp_dir_.path();
+  ASSERT_TRUE(CreateFile(root.AppendASCII("a")));
+  ASSERT_TRUE(CreateFile(root.AppendASCII("b")));
+  ASSERT_TRUE(CreateFile(root.AppendASCII("c")));
+  ASSERT_TRUE(base::CreateDirectory(root.AppendASCII("d")));
+  ASSERT_TRUE(CreateFile(root.AppendASCII("d").AppendASCII("e")));
+  ASSERT_TRUE(base::CreateDirectory(root.AppendASCII("f")));
+
+  scoped_refptr<DirectoryEnumerator> enumerator = CreateEnumerator(root, 4);
+  ASSERT_TRUE(enumerator->Start());
+
+  // A single chunk is read until it was passed back.
+  task_runner_->RunPendingTasks();
+  EXPECT_FALSE(task_runner_->HasPendingTask());
+  EXPECT_TRUE(chunk_sizes_.empty());
+
+  message_loop_.RunUntilIdle();
+  ASSERT_EQ(1u, chunk_sizes_.size());
+  EXPECT_EQ(4u, chunk_sizes_[0]);
+  EXPECT_FALSE(done_);
+  EXPECT_TRUE(task_runner_->HasPendingTask());
+
+  task_runner_->RunPendingTasks();
+  message_loop_.RunUntilIdle();
+  ASSERT_EQ(2u, chunk_sizes_.size());
+  EXPECT_EQ(2u, chunk_sizes_[1]);
+  EXPECT_TRUE(done_);
+  EXPECT_EQ(net::OK, error_);
+  EXPECT_FALSE(task_runner_->HasPendingTask());
+
+  std::vector<base::FilePath> expected;
+  expected.push_back(root.AppendASCII("a"));
+  expected.push_back(root.AppendASCII("b"));
+  expected.push_back(root.AppendASCII("c"));
+  expected.push_back(root.AppendASCII("d").AppendASCII("."));
+  expected.push_back(root.AppendASCII("d").AppendASCII("e"));
+  expected.push_back(root.AppendASCII("f").AppendASCII("."));
+  std::sort(paths_.begin(), paths_.end());
+  EXPECT_EQ(expected, paths_);
+}
+
+TEST_F(DirectoryEnumeratorTest, CancelDropsPendingChunks) {
+  const base::FilePath& root = temp_dir_.path();
+  ASSERT_TRUE(CreateFile(root.AppendASCII("a")));
+  ASSERT_TRUE(CreateFile(root.AppendASCII("b")));
+
+  scoped_refptr<DirectoryEnumerator> enumerator = CreateEnumerator(root, 1);
+  ASSERT_TRUE(enumerator->Start());
+  task_runner_->RunPendingTasks();
+
+  enumerator->Cancel();
+  message_loop_.RunUntilIdle();
+  EXPECT_TRUE(chunk_sizes_.empty());
+  EXPECT_FALSE(done_);
+
+  // Nothing is read anymore, and the chunk released its reference.
+  EXPECT_FALSE(task_runner_->HasPendingTask());
+  EXPECT_TRUE(enumerator->HasOneRef());
+}
+
+TEST_F(DirectoryEnumeratorTest, MissingDirectory) {
+  scoped_refptr<DirectoryEnumerator> enumerator =
+      CreateEnumerator(temp_dir_.path().AppendASCII("missing"), 1);
+  ASSERT_TRUE(enumerator->Start());
+  task_runner_->RunPendingTasks();
+  message_loop_.RunUntilIdle();
+
+  EXPECT_TRUE(chunk_sizes_.empty());
+  EXPECT_TRUE(done_);
+  EXPECT_EQ(net::ERR_FILE_NOT_FOUND, error_);
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/icon_loader.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/location.h"
+#include "base/memory/singleton.h"
+#include "base/task_runner_util.h"
+#include "content/public/browser/browser_thread.h"
+#include "skia/ext/image_operations.h"
+#include "ui/gfx/image/image.h"
+#include "xwalk/runtime/browser/image_util.h"
+
+using content::BrowserThread;
+
+namespace xwalk {
+
+namespace {
+
+// Enough for the icons of the windows and of a launcher page, while bounding
+// the memory used by large icons.
+const size_t kMaxCachedIcons = 64;
+
+SkBitmap DownscaleToFit(const SkBitmap& bitmap, const gfx::Size& size) {
+  if (size.IsEmpty() ||
+      (bitmap.width() <= size.width() && bitmap.height() <= size.height()))
+    return bitmap;
+
+  // Keeps the aspect ratio.
+  const double scale =
+      std::min(static_cast<double>(size.width()) / bitmap.width(),
+               static_cast<double>(size.height()) / bitmap.height());
+  return skia::ImageOperations::Resize(
+      bitmap, skia::ImageOperations::RESIZE_BEST,
+      std::max(1, static_cast<int>(bitmap.width() * scale + 0.5)),
+      std::max(1, static_cast<int>(bitmap.height() * scale + 0.5)));
+}
+
+void RunLoadCallback(const IconLoader::LoadCallback& callback,
+                     const SkBitmap& bitmap) {
+  if (bitmap.isNull())
+    callback.Run(gfx::Image());
+  else
+    callback.Run(gfx::Image::CreateFrom1xBitmap(bitmap));
+}
+
+}  // namespace
+
+IconLoader::CacheKey::CacheKey(const base::FilePath& path,
+                               const base::Time& last_modified,
+                               const gfx::Size& size)
+    : path(path),
+      last_modified(last_modified),
+      size(size) {}
+
+bool IconLoader::CacheKey::operator<(const CacheKey& other) const {
+  if (path != other.path)
+    return path < other.path;
+  if (last_modified != other.last_modified)
+    return last_modified < other.last_modified;
+  if (size.width() != other.size.width())
+    return size.width() < other.size.width();
+  return size.height() < other.size.height();
+}
+
+// static
+IconLoader* IconLoader::GetInstance() {
+  // Leaked, since loads can still be running on the blocking pool at exit.
+  return Singleton<IconLoader, LeakySingletonTraits<IconLoader> >::get();
+}
+
+IconLoader::IconLoader()
+    : cache_(kMaxCachedIcons) {}
+
+IconLoader::~IconLoader() {}
+
+void IconLoader::LoadIcon(const base::FilePath& path,
+                          const gfx::Size& size,
+                          const LoadCallback& callback) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  base::PostTaskAndReplyWithResult(
+      BrowserThread::GetBlockingPool(),
+      FROM_HERE,
+      base::Bind(&IconLoader::LoadBitmap, base::Unretained(this), path, size),
+      base::Bind(&RunLoadCallback, callback));
+}
+
+SkBitmap IconLoader::LoadBitmap(const base::FilePath& path,
+                                const gfx::Size& size) {
+  base::File::Info info;
+  if (!base::GetFileInfo(path, &info))
+    return SkBitmap();
+
+  const CacheKey key(path, info.last_modified, size);
+  {
+    base::AutoLock lock(lock_);
+    base::MRUCache<CacheKey, SkBitmap>::iterator it = cache_.Get(key);
+    if (it != cache_.end())
+      return it->second;
+  }
+
+  // Failures are not cached, the file might be fixed without its time
+  // changing, e.g. while it is being written.
+  SkBitmap bitmap = xwalk_utils::DecodeImageFromFilePath(path);
+  if (bitmap.isNull())
+    return bitmap;
+
+  bitmap = DownscaleToFit(bitmap, size);
+  bitmap.setImmutable();
+
+  base::AutoLock lock(lock_);
+  cache_.Put(key, bitmap);
+  return bitmap;
+}
+
+}  // namespace xwalk
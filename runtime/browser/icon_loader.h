@@ -0,0 +1,73 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_ICON_LOADER_H_
+#define XWALK_RUNTIME_BROWSER_ICON_LOADER_H_
+
+#include "base/callback.h"
+#include "base/containers/mru_cache.h"
+#include "base/files/file_path.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/size.h"
+
+template <typename T> struct DefaultSingletonTraits;
+
+namespace gfx {
+class Image;
+}
+
+namespace xwalk {
+
+// Loads the icons of the applications without blocking the UI thread. The
+// files are read and decoded on the blocking pool, and the decoded icons are
+// kept in a LRU cache keyed by path, modification time and size, so an icon
+// shared by several windows, or listed again by a launcher, is only decoded
+// once.
+class IconLoader {
+ public:
+  typedef base::Callback<void(const gfx::Image&)> LoadCallback;
+
+  static IconLoader* GetInstance();
+
+  // Loads |path| downscaled to fit in |size|, or at its own size if |size| is
+  // empty. Must be called on the UI thread, |callback| is called later on the
+  // UI thread, with an empty image if the icon could not be loaded.
+  void LoadIcon(const base::FilePath& path,
+                const gfx::Size& size,
+                const LoadCallback& callback);
+
+ private:
+  friend struct DefaultSingletonTraits<IconLoader>;
+
+  struct CacheKey {
+    CacheKey(const base::FilePath& path,
+             const base::Time& last_modified,
+             const gfx::Size& size);
+
+    bool operator<(const CacheKey& other) const;
+
+    base::FilePath path;
+    base::Time last_modified;
+    gfx::Size size;
+  };
+
+  IconLoader();
+  ~IconLoader();
+
+  // Called on the blocking pool. The bitmap returned is immutable, so it can
+  // be shared with the UI thread.
+  SkBitmap LoadBitmap(const base::FilePath& path, const gfx::Size& size);
+
+  // Guards the cache, which is used by all the threads of the blocking pool.
+  base::Lock lock_;
+  base::MRUCache<CacheKey, SkBitmap> cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(IconLoader);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_ICON_LOADER_H_
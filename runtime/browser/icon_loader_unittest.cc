@@ -0,0 +1,109 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/icon_loader.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "content/public/test/test_browser_thread_bundle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/codec/png_codec.h"
+#include "ui/gfx/image/image.h"
+
+using xwalk::IconLoader;
+
+namespace {
+
+bool WritePNG(const base::FilePath& path, int width, int height) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(width, height);
+  bitmap.eraseColor(SK_ColorBLUE);
+
+  std::vector<unsigned char> data;
+  if (!gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, &data))
+    return false;
+
+  const int size = static_cast<int>(data.size());
+  return base::WriteFile(path, reinterpret_cast<const char*>(&data[0]),
+                         size) == size;
+}
+
+void OnIconLoaded(base::RunLoop* run_loop, gfx::Image* result,
+                  const gfx::Image& image) {
+  *result = image;
+  run_loop->Quit();
+}
+
+class IconLoaderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+  }
+
+  gfx::Image LoadIcon(const base::FilePath& path, const gfx::Size& size) {
+    gfx::Image image;
+    base::RunLoop run_loop;
+    IconLoader::GetInstance()->LoadIcon(
+        path, size, base::Bind(&OnIconLoaded, &run_loop, &image));
+    run_loop.Run();
+    return image;
+  }
+
+  content::TestBrowserThreadBundle thread_bundle_;
+  base::ScopedTempDir temp_dir_;
+};
+
+}  // namespace
+
+TEST_F(IconLoaderTest, Downscale) {
+  base::FilePath path = temp_dir_.path().AppendASCII("icon.png");
+  ASSERT_TRUE(WritePNG(path, 64, 32));
+
+  gfx::Image image = LoadIcon(path, gfx::Size());
+  EXPECT_EQ(64, image.Width());
+  EXPECT_EQ(32, image.Height());
+
+  // The aspect ratio is kept.
+  image = LoadIcon(path, gfx::Size(16, 16));
+  EXPECT_EQ(16, image.Width());
+  EXPECT_EQ(8, image.Height());
+
+  // Icons are never upscaled.
+  image = LoadIcon(path, gfx::Size(128, 128));
+  EXPECT_EQ(64, image.Width());
+  EXPECT_EQ(32, image.Height());
+}
+
+TEST_F(IconLoaderTest, CacheKeyedByModificationTime) {
+  base::FilePath path = temp_dir_.path().AppendASCII("icon.png");
+  ASSERT_TRUE(WritePNG(path, 32, 32));
+  base::File::Info info;
+  ASSERT_TRUE(base::GetFileInfo(path, &info));
+
+  EXPECT_EQ(32, LoadIcon(path, gfx::Size(48, 48)).Width());
+
+  // Same path, time and size, the cached icon is used.
+  ASSERT_TRUE(WritePNG(path, 40, 40));
+  ASSERT_TRUE(base::TouchFile(path, info.last_accessed, info.last_modified));
+  EXPECT_EQ(32, LoadIcon(path, gfx::Size(48, 48)).Width());
+
+  // A new size or a new time decode the file again.
+  EXPECT_EQ(40, LoadIcon(path, gfx::Size(64, 64)).Width());
+  base::Time later = info.last_modified + base::TimeDelta::FromSeconds(10);
+  ASSERT_TRUE(base::TouchFile(path, later, later));
+  EXPECT_EQ(40, LoadIcon(path, gfx::Size(48, 48)).Width());
+}
+
+TEST_F(IconLoaderTest, Failures) {
+  EXPECT_TRUE(LoadIcon(temp_dir_.path().AppendASCII("missing.png"),
+                       gfx::Size()).IsEmpty());
+
+  base::FilePath path = temp_dir_.path().AppendASCII("broken.png");
+  ASSERT_EQ(3, base::WriteFile(path, "abc", 3));
+  EXPECT_TRUE(LoadIcon(path, gfx::Size()).IsEmpty());
+}
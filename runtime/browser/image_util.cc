@@ -8,8 +8,9 @@
 
 #include "base/files/file_util.h"
 #include "base/strings/string_util.h"
+#include "ui/gfx/codec/jpeg_codec.h"
+#include "ui/gfx/codec/png_codec.h"
 #include "ui/gfx/image/image_skia.h"
-#include "ui/gfx/image/image_util.h"
 #include "ui/gfx/size.h"
 
 #if defined(OS_WIN)
@@ -19,6 +20,14 @@
 namespace xwalk_utils {
 
 gfx::Image LoadImageFromFilePath(const base::FilePath& filename) {
+  SkBitmap bitmap = DecodeImageFromFilePath(filename);
+  if (bitmap.isNull())
+    return gfx::Image();
+
+  return gfx::Image::CreateFrom1xBitmap(bitmap);
+}
+
+SkBitmap DecodeImageFromFilePath(const base::FilePath& filename) {
   const base::FilePath::StringType kPNGFormat(FILE_PATH_LITERAL(".png"));
   const base::FilePath::StringType kICOFormat(FILE_PATH_LITERAL(".ico"));
   const base::FilePath::StringType kJPGFormat(FILE_PATH_LITERAL(".jpg"));
@@ -26,19 +35,26 @@ gfx::Image LoadImageFromFilePath(const base::FilePath& filename) {
 
   if (EndsWith(filename.value(), kPNGFormat, false)) {
     std::string contents;
-    base::ReadFileToString(filename, &contents);
-    return gfx::Image::CreateFrom1xPNGBytes(
-        reinterpret_cast<const unsigned char*>(contents.data()),
-            contents.size());
+    SkBitmap bitmap;
+    if (!base::ReadFileToString(filename, &contents) ||
+        !gfx::PNGCodec::Decode(
+            reinterpret_cast<const unsigned char*>(contents.data()),
+            contents.size(), &bitmap))
+      return SkBitmap();
+
+    return bitmap;
   }
 
   if (EndsWith(filename.value(), kJPGFormat, false) ||
       EndsWith(filename.value(), kJPEGFormat, false)) {
     std::string contents;
-    base::ReadFileToString(filename, &contents);
-    return gfx::ImageFrom1xJPEGEncodedData(
+    if (!base::ReadFileToString(filename, &contents))
+      return SkBitmap();
+
+    scoped_ptr<SkBitmap> bitmap(gfx::JPEGCodec::Decode(
         reinterpret_cast<const unsigned char*>(contents.data()),
-        contents.size());
+        contents.size()));
+    return bitmap ? *bitmap : SkBitmap();
   }
 
   if (EndsWith(filename.value(), kICOFormat, false)) {
@@ -50,28 +66,26 @@ gfx::Image LoadImageFromFilePath(const base::FilePath& filename) {
                                     0,
                                     LR_LOADTRANSPARENT | LR_LOADFROMFILE));
     if (icon == NULL)
-      return gfx::Image();
-
-    gfx::Image image;
-    scoped_ptr<SkBitmap> bitmap(IconUtil::CreateSkBitmapFromHICON(icon));
-    if (bitmap.get()) {
-      gfx::ImageSkia image_skia = gfx::ImageSkia::CreateFrom1xBitmap(*bitmap);
-      image = gfx::Image(image_skia);
-    }
+      return SkBitmap();
+
+    SkBitmap bitmap;
+    scoped_ptr<SkBitmap> icon_bitmap(IconUtil::CreateSkBitmapFromHICON(icon));
+    if (icon_bitmap.get())
+      bitmap = *icon_bitmap;
     DestroyIcon(icon);
 
-    return image;
+    return bitmap;
 #elif defined(USE_AURA) && defined(OS_LINUX)
     NOTIMPLEMENTED();
-    return gfx::Image();
+    return SkBitmap();
 #else
   NOTREACHED();
-  return gfx::Image();
+  return SkBitmap();
 #endif
   }
 
   LOG(INFO) << "Only support png and ico file format.";
-  return gfx::Image();
+  return SkBitmap();
 }
 
 }  // namespace xwalk_utils
@@ -6,6 +6,7 @@
 #define XWALK_RUNTIME_BROWSER_IMAGE_UTIL_H_
 
 #include "base/files/file_path.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/gfx/image/image.h"
 
 namespace xwalk_utils {
@@ -13,6 +14,10 @@ namespace xwalk_utils {
 // Load a gfx::Image from a PNG file or ICO file.
 gfx::Image LoadImageFromFilePath(const base::FilePath& filename);
 
+// Decodes a PNG, JPEG or ICO file, returns an empty bitmap on failure. Reads
+// the file, so it must not be called on the UI thread.
+SkBitmap DecodeImageFromFilePath(const base::FilePath& filename);
+
 }  // namespace xwalk_utils
 
 #endif  // XWALK_RUNTIME_BROWSER_IMAGE_UTIL_H_
@@ -9,10 +9,11 @@
 
 #include "base/bind.h"
 #include "base/files/file.h"
-#include "base/files/file_util.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/threading/worker_pool.h"
+#include "xwalk/runtime/browser/directory_enumerator.h"
 #include "xwalk/runtime/browser/runtime_platform_util.h"
 #include "xwalk/runtime/browser/runtime_select_file_policy.h"
 #include "content/public/browser/browser_thread.h"
@@ -42,16 +43,25 @@ namespace {
 // the renderer must start at 0 and increase.
 const int kFileSelectEnumerationId = -1;
 
+// Number of entries passed at once from the worker thread to the UI thread
+// while enumerating a directory, which is also the most that can be waiting
+// in the queue of the UI thread.
+const size_t kEnumerationChunkSize = 1024;
+
+content::FileChooserFileInfo ToChooserFileInfo(
+    const ui::SelectedFileInfo& file) {
+  content::FileChooserFileInfo chooser_file;
+  chooser_file.file_path = file.local_path;
+  chooser_file.display_name = file.display_name;
+  return chooser_file;
+}
+
 void NotifyRenderViewHost(RenderViewHost* render_view_host,
                           const std::vector<ui::SelectedFileInfo>& files,
                           FileChooserParams::Mode dialog_mode) {
   std::vector<content::FileChooserFileInfo> chooser_files;
-  for (const auto& file : files) {
-    content::FileChooserFileInfo chooser_file;
-    chooser_file.file_path = file.local_path;
-    chooser_file.display_name = file.display_name;
-    chooser_files.push_back(chooser_file);
-  }
+  for (const auto& file : files)
+    chooser_files.push_back(ToChooserFileInfo(file));
   render_view_host->FilesSelectedInChooser(chooser_files, dialog_mode);
 }
 
@@ -71,9 +81,11 @@ std::vector<ui::SelectedFileInfo> FilePathListToSelectedFileInfoList(
 struct RuntimeFileSelectHelper::ActiveDirectoryEnumeration {
   ActiveDirectoryEnumeration() : render_view_host_(NULL) {}
 
-  scoped_ptr<DirectoryListerDispatchDelegate> delegate_;
-  scoped_ptr<net::DirectoryLister> lister_;
+  scoped_refptr<xwalk::DirectoryEnumerator> enumerator_;
   RenderViewHost* render_view_host_;
+  // The entries are kept in the form of the reply, so that a single list is
+  // built: |chooser_files_| for the file chooser, |results_| otherwise.
+  std::vector<content::FileChooserFileInfo> chooser_files_;
   std::vector<base::FilePath> results_;
 };
 
@@ -83,7 +95,9 @@ RuntimeFileSelectHelper::RuntimeFileSelectHelper()
       select_file_dialog_(),
       select_file_types_(),
       dialog_type_(ui::SelectFileDialog::SELECT_OPEN_FILE),
-      dialog_mode_(FileChooserParams::Open) {
+      dialog_mode_(FileChooserParams::Open),
+      enumeration_task_runner_(
+          base::WorkerPool::GetTaskRunner(true /* task_is_slow */)) {
 }
 
 RuntimeFileSelectHelper::~RuntimeFileSelectHelper() {
@@ -98,21 +112,11 @@ RuntimeFileSelectHelper::~RuntimeFileSelectHelper() {
   for (iter = directory_enumerations_.begin();
        iter != directory_enumerations_.end();
        ++iter) {
-    iter->second->lister_.reset();
+    iter->second->enumerator_->Cancel();
     delete iter->second;
   }
 }
 
-void RuntimeFileSelectHelper::DirectoryListerDispatchDelegate::OnListFile(
-    const net::DirectoryLister::DirectoryListerData& data) {
-  parent_->OnListFile(id_, data);
-}
-
-void RuntimeFileSelectHelper::DirectoryListerDispatchDelegate::OnListDone(
-    int error) {
-  parent_->OnListDone(id_, error);
-}
-
 void RuntimeFileSelectHelper::FileSelected(const base::FilePath& path,
                                            int index, void* params) {
   FileSelectedWithExtraInfo(ui::SelectedFileInfo(path, path), index, params);
@@ -185,12 +189,16 @@ void RuntimeFileSelectHelper::StartNewEnumeration(
     RenderViewHost* render_view_host) {
   scoped_ptr<ActiveDirectoryEnumeration> entry(new ActiveDirectoryEnumeration);
   entry->render_view_host_ = render_view_host;
-  entry->delegate_.reset(new DirectoryListerDispatchDelegate(this, request_id));
-  entry->lister_.reset(new net::DirectoryLister(path,
-                                                true,
-                                                net::DirectoryLister::NO_SORT,
-                                                entry->delegate_.get()));
-  if (!entry->lister_->Start()) {
+  // The enumerations are cancelled before this instance goes away.
+  entry->enumerator_ = new xwalk::DirectoryEnumerator(
+      path,
+      kEnumerationChunkSize,
+      enumeration_task_runner_,
+      base::Bind(&RuntimeFileSelectHelper::OnListChunk,
+                 base::Unretained(this), request_id),
+      base::Bind(&RuntimeFileSelectHelper::OnListDone,
+                 base::Unretained(this), request_id));
+  if (!entry->enumerator_->Start()) {
     if (request_id == kFileSelectEnumerationId)
       FileSelectionCanceled(NULL);
     else
@@ -198,46 +206,72 @@ void RuntimeFileSelectHelper::StartNewEnumeration(
                                                      entry->results_);
   } else {
     directory_enumerations_[request_id] = entry.release();
+
+    // The file chooser already watches its RenderViewHost.
+    content::Source<RenderWidgetHost> source(render_view_host);
+    if (!notification_registrar_.IsRegistered(
+            this, content::NOTIFICATION_RENDER_WIDGET_HOST_DESTROYED,
+            source)) {
+      notification_registrar_.Add(
+          this, content::NOTIFICATION_RENDER_WIDGET_HOST_DESTROYED, source);
+    }
   }
 }
 
-void RuntimeFileSelectHelper::OnListFile(
+void RuntimeFileSelectHelper::OnListChunk(
     int id,
-    const net::DirectoryLister::DirectoryListerData& data) {
+    const std::vector<base::FilePath>& paths) {
   ActiveDirectoryEnumeration* entry = directory_enumerations_[id];
-
-  // Directory upload returns directories via a "." file, so that
-  // empty directories are included.  This util call just checks
-  // the flags in the structure; there's no file I/O going on.
-  if (data.info.IsDirectory())
-    entry->results_.push_back(data.path.Append(FILE_PATH_LITERAL(".")));
-  else
-    entry->results_.push_back(data.path);
+  if (id == kFileSelectEnumerationId) {
+    for (size_t i = 0; i < paths.size(); ++i) {
+      entry->chooser_files_.push_back(
+          ToChooserFileInfo(ui::SelectedFileInfo(paths[i], paths[i])));
+    }
+  } else {
+    entry->results_.insert(entry->results_.end(), paths.begin(), paths.end());
+  }
 }
 
 void RuntimeFileSelectHelper::OnListDone(int id, int error) {
   // This entry needs to be cleaned up when this function is done.
   scoped_ptr<ActiveDirectoryEnumeration> entry(directory_enumerations_[id]);
   directory_enumerations_.erase(id);
-  if (!entry->render_view_host_)
-    return;
-  if (error) {
+  if (error && id == kFileSelectEnumerationId) {
     FileSelectionCanceled(NULL);
     return;
   }
 
-  std::vector<ui::SelectedFileInfo> selected_files =
-      FilePathListToSelectedFileInfoList(entry->results_);
-
-  if (id == kFileSelectEnumerationId)
-    NotifyRenderViewHost(
-        entry->render_view_host_, selected_files, dialog_mode_);
-  else
+  if (id == kFileSelectEnumerationId) {
+    entry->render_view_host_->FilesSelectedInChooser(entry->chooser_files_,
+                                                     dialog_mode_);
+  } else {
     entry->render_view_host_->DirectoryEnumerationFinished(id, entry->results_);
+  }
 
   EnumerateDirectoryEnd();
 }
 
+void RuntimeFileSelectHelper::CancelEnumerations(
+    RenderViewHost* render_view_host) {
+  std::vector<int> ids;
+  for (std::map<int, ActiveDirectoryEnumeration*>::const_iterator it =
+       directory_enumerations_.begin();
+       it != directory_enumerations_.end(); ++it) {
+    if (it->second->render_view_host_ == render_view_host)
+      ids.push_back(it->first);
+  }
+
+  // Each enumeration holds a reference, which might be the last one.
+  scoped_refptr<RuntimeFileSelectHelper> protect(this);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    scoped_ptr<ActiveDirectoryEnumeration> entry(
+        directory_enumerations_[ids[i]]);
+    directory_enumerations_.erase(ids[i]);
+    entry->enumerator_->Cancel();
+    EnumerateDirectoryEnd();
+  }
+}
+
 scoped_ptr<ui::SelectFileDialog::FileTypeInfo>
 RuntimeFileSelectHelper::GetFileTypesFromAcceptType(
     const std::vector<base::string16>& accept_types) {
@@ -470,9 +504,11 @@ void RuntimeFileSelectHelper::Observe(
     const content::NotificationDetails& details) {
   switch (type) {
     case content::NOTIFICATION_RENDER_WIDGET_HOST_DESTROYED: {
-      DCHECK(content::Source<RenderWidgetHost>(source).ptr() ==
-             render_view_host_);
-      render_view_host_ = NULL;
+      RenderWidgetHost* widget_host =
+          content::Source<RenderWidgetHost>(source).ptr();
+      if (widget_host == render_view_host_)
+        render_view_host_ = NULL;
+      CancelEnumerations(RenderViewHost::From(widget_host));
       break;
     }
 
@@ -11,12 +11,16 @@
 
 #include "base/compiler_specific.h"
 #include "base/gtest_prod_util.h"
+#include "base/memory/ref_counted.h"
 #include "content/public/browser/notification_observer.h"
 #include "content/public/browser/notification_registrar.h"
 #include "content/public/common/file_chooser_params.h"
-#include "net/base/directory_lister.h"
 #include "ui/shell_dialogs/select_file_dialog.h"
 
+namespace base {
+class TaskRunner;
+}
+
 namespace content {
 class RenderViewHost;
 class WebContents;
@@ -45,30 +49,11 @@ class RuntimeFileSelectHelper
 
  private:
   friend class base::RefCountedThreadSafe<RuntimeFileSelectHelper>;
+  friend class RuntimeFileSelectHelperTest;
   FRIEND_TEST_ALL_PREFIXES(RuntimeFileSelectHelperTest, IsAcceptTypeValid);
   RuntimeFileSelectHelper();
   virtual ~RuntimeFileSelectHelper();
 
-  // Utility class which can listen for directory lister events and relay
-  // them to the main object with the correct tracking id.
-  class DirectoryListerDispatchDelegate
-      : public net::DirectoryLister::DirectoryListerDelegate {
-   public:
-    DirectoryListerDispatchDelegate(RuntimeFileSelectHelper* parent, int id)
-        : parent_(parent),
-          id_(id) {}
-    virtual ~DirectoryListerDispatchDelegate() {}
-    void OnListFile(
-        const net::DirectoryLister::DirectoryListerData& data) override;
-    void OnListDone(int error) override;
-   private:
-    // This RuntimeFileSelectHelper owns this object.
-    RuntimeFileSelectHelper* parent_;
-    int id_;
-
-    DISALLOW_COPY_AND_ASSIGN(DirectoryListerDispatchDelegate);
-  };
-
   void RunFileChooser(content::RenderViewHost* render_view_host,
                       content::WebContents* web_contents,
                       const content::FileChooserParams& params);
@@ -109,12 +94,14 @@ class RuntimeFileSelectHelper
                            int request_id,
                            content::RenderViewHost* render_view_host);
 
-  // Callbacks from directory enumeration.
-  virtual void OnListFile(
-      int id,
-      const net::DirectoryLister::DirectoryListerData& data);
+  // Callbacks from directory enumeration, |paths| are the entries found
+  // since the previous callback.
+  virtual void OnListChunk(int id, const std::vector<base::FilePath>& paths);
   virtual void OnListDone(int id, int error);
 
+  // Stops the enumerations requested by |render_view_host|, which went away.
+  void CancelEnumerations(content::RenderViewHost* render_view_host);
+
   // Cleans up and releases this instance. This must be called after the last
   // callback is received from the enumeration code.
   void EnumerateDirectoryEnd();
@@ -152,6 +139,9 @@ class RuntimeFileSelectHelper
   struct ActiveDirectoryEnumeration;
   std::map<int, ActiveDirectoryEnumeration*> directory_enumerations_;
 
+  // Where the directories are enumerated, the worker pool except in tests.
+  scoped_refptr<base::TaskRunner> enumeration_task_runner_;
+
   // Registrar for notifications regarding our RenderViewHost.
   content::NotificationRegistrar notification_registrar_;
 
@@ -0,0 +1,82 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/runtime_file_select_helper.h"
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/test/test_simple_task_runner.h"
+#include "content/public/test/test_renderer_host.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+class RuntimeFileSelectHelperTest
+    : public content::RenderViewHostTestHarness {
+ protected:
+  void SetUp() override {
+    content::RenderViewHostTestHarness::SetUp();
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    ASSERT_EQ(1, base::WriteFile(temp_dir_.path().AppendASCII("a"), "x", 1));
+    task_runner_ = new base::TestSimpleTaskRunner;
+  }
+
+  scoped_refptr<RuntimeFileSelectHelper> CreateHelper() {
+    scoped_refptr<RuntimeFileSelectHelper> helper(new RuntimeFileSelectHelper);
+    helper->enumeration_task_runner_ = task_runner_;
+    return helper;
+  }
+
+  void EnumerateDirectory(RuntimeFileSelectHelper* helper, int request_id) {
+    helper->EnumerateDirectory(request_id, rvh(), temp_dir_.path());
+  }
+
+  void CancelEnumerations(RuntimeFileSelectHelper* helper) {
+    helper->CancelEnumerations(rvh());
+  }
+
+  size_t GetActiveEnumerationCount(RuntimeFileSelectHelper* helper) const {
+    return helper->directory_enumerations_.size();
+  }
+
+  // Reads the directories one chunk at a time, until there is nothing left
+  // to read.
+  void RunEnumerations() {
+    while (task_runner_->HasPendingTask()) {
+      task_runner_->RunPendingTasks();
+      base::RunLoop().RunUntilIdle();
+    }
+  }
+
+  base::ScopedTempDir temp_dir_;
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner_;
+};
+
+TEST_F(RuntimeFileSelectHelperTest, EnumerateDirectory) {
+  scoped_refptr<RuntimeFileSelectHelper> helper = CreateHelper();
+  EnumerateDirectory(helper.get(), 0);
+  EnumerateDirectory(helper.get(), 1);
+  EXPECT_EQ(2u, GetActiveEnumerationCount(helper.get()));
+  EXPECT_FALSE(helper->HasOneRef());
+
+  RunEnumerations();
+  EXPECT_EQ(0u, GetActiveEnumerationCount(helper.get()));
+  EXPECT_TRUE(helper->HasOneRef());
+}
+
+TEST_F(RuntimeFileSelectHelperTest, CancelEnumerations) {
+  scoped_refptr<RuntimeFileSelectHelper> helper = CreateHelper();
+  EnumerateDirectory(helper.get(), 0);
+
+  // A chunk is waiting on the UI thread when the enumeration is cancelled.
+  task_runner_->RunPendingTasks();
+  CancelEnumerations(helper.get());
+  EXPECT_EQ(0u, GetActiveEnumerationCount(helper.get()));
+  EXPECT_TRUE(helper->HasOneRef());
+
+  // The chunk is dropped, and nothing more is read.
+  base::RunLoop().RunUntilIdle();
+  EXPECT_FALSE(task_runner_->HasPendingTask());
+  EXPECT_EQ(0u, GetActiveEnumerationCount(helper.get()));
+  EXPECT_TRUE(helper->HasOneRef());
+}
@@ -4,6 +4,7 @@
 
 #include "xwalk/runtime/browser/runtime_network_delegate.h"
 
+#include "net/base/load_timing_info.h"
 #include "net/base/net_errors.h"
 #include "net/base/static_cookie_policy.h"
 #include "net/url_request/url_request.h"
@@ -24,6 +25,7 @@ int RuntimeNetworkDelegate::OnBeforeURLRequest(
     net::URLRequest* request,
     const net::CompletionCallback& callback,
     GURL* new_url) {
+  stats_.RecordStarted();
   return net::OK;
 }
 
@@ -50,6 +52,7 @@ int RuntimeNetworkDelegate::OnHeadersReceived(
 
 void RuntimeNetworkDelegate::OnBeforeRedirect(net::URLRequest* request,
                                               const GURL& new_location) {
+  stats_.RecordRedirect();
 }
 
 void RuntimeNetworkDelegate::OnResponseStarted(net::URLRequest* request) {
@@ -57,10 +60,30 @@ void RuntimeNetworkDelegate::OnResponseStarted(net::URLRequest* request) {
 
 void RuntimeNetworkDelegate::OnRawBytesRead(const net::URLRequest& request,
                                             int bytes_read) {
+  stats_.RecordBytesRead(bytes_read);
 }
 
 void RuntimeNetworkDelegate::OnCompleted(net::URLRequest* request,
                                          bool started) {
+  RuntimeNetworkStats::RequestInfo info;
+  info.was_cached = request->was_cached();
+  info.was_canceled =
+      request->status().status() == net::URLRequestStatus::CANCELED;
+  info.net_error = request->status().error();
+
+  net::LoadTimingInfo timing;
+  request->GetLoadTimingInfo(&timing);
+  const net::LoadTimingInfo::ConnectTiming& connect = timing.connect_timing;
+  if (!connect.dns_start.is_null() && !connect.dns_end.is_null())
+    info.dns = connect.dns_end - connect.dns_start;
+  if (!connect.connect_start.is_null() && !connect.connect_end.is_null())
+    info.connect = connect.connect_end - connect.connect_start;
+  if (!timing.send_start.is_null() && !timing.receive_headers_end.is_null())
+    info.time_to_first_byte = timing.receive_headers_end - timing.send_start;
+  if (!timing.request_start.is_null())
+    info.total = base::TimeTicks::Now() - timing.request_start;
+
+  stats_.RecordCompleted(info);
 }
 
 void RuntimeNetworkDelegate::OnURLRequestDestroyed(net::URLRequest* request) {
@@ -10,6 +10,7 @@
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "net/base/network_delegate.h"
+#include "xwalk/runtime/browser/runtime_network_stats.h"
 
 namespace xwalk {
 
@@ -18,6 +19,9 @@ class RuntimeNetworkDelegate : public net::NetworkDelegate {
   RuntimeNetworkDelegate();
   virtual ~RuntimeNetworkDelegate();
 
+  // Only used on the IO thread.
+  const RuntimeNetworkStats& stats() const { return stats_; }
+
  private:
   // net::NetworkDelegate implementation.
   int OnBeforeURLRequest(net::URLRequest* request,
@@ -61,6 +65,8 @@ class RuntimeNetworkDelegate : public net::NetworkDelegate {
       net::SocketStream* stream,
       const net::CompletionCallback& callback) override;
 
+  RuntimeNetworkStats stats_;
+
   DISALLOW_COPY_AND_ASSIGN(RuntimeNetworkDelegate);
 };
 
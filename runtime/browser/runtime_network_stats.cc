@@ -0,0 +1,146 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/runtime_network_stats.h"
+
+#include "base/values.h"
+#include "net/base/net_errors.h"
+
+namespace xwalk {
+
+namespace {
+
+// Upper bounds of the histogram buckets, in milliseconds.
+const int64 kBucketLimitsMs[] = {
+  1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 30000
+};
+
+double Ratio(int64 value, int64 total) {
+  return total ? static_cast<double>(value) / total : 0;
+}
+
+}  // namespace
+
+RuntimeNetworkStats::Histogram::Histogram()
+    : buckets_(arraysize(kBucketLimitsMs) + 1, 0),
+      count_(0) {
+}
+
+RuntimeNetworkStats::Histogram::~Histogram() {
+}
+
+// static
+size_t RuntimeNetworkStats::Histogram::GetBucket(base::TimeDelta sample) {
+  int64 ms = sample.InMilliseconds();
+  size_t bucket = 0;
+  while (bucket < arraysize(kBucketLimitsMs) && ms >= kBucketLimitsMs[bucket])
+    ++bucket;
+  return bucket;
+}
+
+void RuntimeNetworkStats::Histogram::Add(base::TimeDelta sample) {
+  buckets_[GetBucket(sample)]++;
+  count_++;
+  sum_ += sample;
+}
+
+scoped_ptr<base::DictionaryValue>
+RuntimeNetworkStats::Histogram::ToValue() const {
+  scoped_ptr<base::DictionaryValue> value(new base::DictionaryValue);
+  value->SetDouble("count", count_);
+  value->SetDouble("mean_ms",
+                   count_ ? sum_.InMillisecondsF() / count_ : 0);
+
+  // Bucket i counts the samples below limit i, and at least limit i - 1. The
+  // last bucket has no limit.
+  base::ListValue* limits = new base::ListValue;
+  for (size_t i = 0; i < arraysize(kBucketLimitsMs); ++i)
+    limits->AppendDouble(kBucketLimitsMs[i]);
+  value->Set("bucket_limits_ms", limits);
+
+  base::ListValue* counts = new base::ListValue;
+  for (size_t i = 0; i < buckets_.size(); ++i)
+    counts->AppendDouble(buckets_[i]);
+  value->Set("bucket_counts", counts);
+  return value.Pass();
+}
+
+RuntimeNetworkStats::RequestInfo::RequestInfo()
+    : was_cached(false),
+      was_canceled(false),
+      net_error(net::OK) {
+}
+
+RuntimeNetworkStats::RuntimeNetworkStats()
+    : started_(0),
+      completed_(0),
+      failed_(0),
+      canceled_(0),
+      cached_(0),
+      redirects_(0),
+      bytes_read_(0) {
+}
+
+RuntimeNetworkStats::~RuntimeNetworkStats() {
+}
+
+void RuntimeNetworkStats::RecordStarted() {
+  started_++;
+}
+
+void RuntimeNetworkStats::RecordRedirect() {
+  redirects_++;
+}
+
+void RuntimeNetworkStats::RecordBytesRead(int bytes) {
+  bytes_read_ += bytes;
+}
+
+void RuntimeNetworkStats::RecordCompleted(const RequestInfo& info) {
+  completed_++;
+  if (info.was_canceled) {
+    // Canceled requests are not errors, and their timings are partial.
+    canceled_++;
+    return;
+  }
+
+  if (info.net_error != net::OK)
+    failed_++;
+  if (info.was_cached)
+    cached_++;
+
+  if (info.dns > base::TimeDelta())
+    dns_.Add(info.dns);
+  if (info.connect > base::TimeDelta())
+    connect_.Add(info.connect);
+  if (info.time_to_first_byte > base::TimeDelta())
+    time_to_first_byte_.Add(info.time_to_first_byte);
+  total_.Add(info.total);
+}
+
+scoped_ptr<base::DictionaryValue> RuntimeNetworkStats::ToValue() const {
+  scoped_ptr<base::DictionaryValue> value(new base::DictionaryValue);
+
+  // Counts are doubles, as base::Value has no 64-bit integers.
+  value->SetDouble("requests.started", started_);
+  value->SetDouble("requests.completed", completed_);
+  value->SetDouble("requests.failed", failed_);
+  value->SetDouble("requests.canceled", canceled_);
+  value->SetDouble("requests.cached", cached_);
+  value->SetDouble("requests.redirects", redirects_);
+  value->SetDouble("bytes_read", bytes_read_);
+
+  int64 finished = completed_ - canceled_;
+  value->SetDouble("cache_hit_ratio", Ratio(cached_, finished));
+  value->SetDouble("error_rate", Ratio(failed_, finished));
+
+  value->Set("latency.dns", dns_.ToValue().release());
+  value->Set("latency.connect", connect_.ToValue().release());
+  value->Set("latency.time_to_first_byte",
+             time_to_first_byte_.ToValue().release());
+  value->Set("latency.total", total_.ToValue().release());
+  return value.Pass();
+}
+
+}  // namespace xwalk
@@ -0,0 +1,99 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_RUNTIME_NETWORK_STATS_H_
+#define XWALK_RUNTIME_BROWSER_RUNTIME_NETWORK_STATS_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/time/time.h"
+
+namespace base {
+class DictionaryValue;
+}
+
+namespace xwalk {
+
+// Aggregates the byte counts, latencies, cache hits and errors of the
+// requests of a URL request context, which is the storage partition of an
+// application. Updated by RuntimeNetworkDelegate on the IO thread only, so
+// recording is a few additions without locking.
+class RuntimeNetworkStats {
+ public:
+  // Fixed exponential buckets of milliseconds, plus an overflow bucket.
+  class Histogram {
+   public:
+    Histogram();
+    ~Histogram();
+
+    void Add(base::TimeDelta sample);
+
+    int64 count() const { return count_; }
+    int64 bucket_count(size_t bucket) const { return buckets_[bucket]; }
+    static size_t GetBucket(base::TimeDelta sample);
+
+    scoped_ptr<base::DictionaryValue> ToValue() const;
+
+   private:
+    std::vector<int64> buckets_;
+    int64 count_;
+    base::TimeDelta sum_;
+  };
+
+  // A completed request. Timings are zero when they don't apply, e.g. no DNS
+  // resolution or connection for a request on a reused socket.
+  struct RequestInfo {
+    RequestInfo();
+
+    base::TimeDelta dns;
+    base::TimeDelta connect;
+    // From sending the request to receiving the response headers.
+    base::TimeDelta time_to_first_byte;
+    base::TimeDelta total;
+
+    bool was_cached;
+    bool was_canceled;
+    // A net::Error, net::OK for successful requests.
+    int net_error;
+  };
+
+  RuntimeNetworkStats();
+  ~RuntimeNetworkStats();
+
+  void RecordStarted();
+  void RecordRedirect();
+  void RecordBytesRead(int bytes);
+  void RecordCompleted(const RequestInfo& info);
+
+  int64 started() const { return started_; }
+  int64 completed() const { return completed_; }
+  int64 failed() const { return failed_; }
+  int64 canceled() const { return canceled_; }
+  int64 cached() const { return cached_; }
+  int64 bytes_read() const { return bytes_read_; }
+
+  scoped_ptr<base::DictionaryValue> ToValue() const;
+
+ private:
+  int64 started_;
+  int64 completed_;
+  int64 failed_;
+  int64 canceled_;
+  int64 cached_;
+  int64 redirects_;
+  int64 bytes_read_;
+
+  Histogram dns_;
+  Histogram connect_;
+  Histogram time_to_first_byte_;
+  Histogram total_;
+
+  DISALLOW_COPY_AND_ASSIGN(RuntimeNetworkStats);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_RUNTIME_NETWORK_STATS_H_
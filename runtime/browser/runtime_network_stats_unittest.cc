@@ -0,0 +1,91 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/runtime_network_stats.h"
+
+#include "base/values.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::TimeDelta;
+using xwalk::RuntimeNetworkStats;
+
+TEST(RuntimeNetworkStatsTest, HistogramBuckets) {
+  typedef RuntimeNetworkStats::Histogram Histogram;
+  EXPECT_EQ(0u, Histogram::GetBucket(TimeDelta()));
+  EXPECT_EQ(1u, Histogram::GetBucket(TimeDelta::FromMilliseconds(1)));
+  EXPECT_EQ(6u, Histogram::GetBucket(TimeDelta::FromMilliseconds(99)));
+  EXPECT_EQ(7u, Histogram::GetBucket(TimeDelta::FromMilliseconds(100)));
+  EXPECT_EQ(14u, Histogram::GetBucket(TimeDelta::FromMinutes(5)));
+
+  Histogram histogram;
+  histogram.Add(TimeDelta::FromMilliseconds(10));
+  histogram.Add(TimeDelta::FromMilliseconds(30));
+  EXPECT_EQ(2, histogram.count());
+  EXPECT_EQ(1, histogram.bucket_count(4));
+  EXPECT_EQ(1, histogram.bucket_count(5));
+
+  scoped_ptr<base::DictionaryValue> value(histogram.ToValue());
+  double mean = 0;
+  EXPECT_TRUE(value->GetDouble("mean_ms", &mean));
+  EXPECT_DOUBLE_EQ(20, mean);
+  base::ListValue* limits = NULL;
+  base::ListValue* counts = NULL;
+  ASSERT_TRUE(value->GetList("bucket_limits_ms", &limits));
+  ASSERT_TRUE(value->GetList("bucket_counts", &counts));
+  EXPECT_EQ(limits->GetSize() + 1, counts->GetSize());
+}
+
+TEST(RuntimeNetworkStatsTest, Requests) {
+  RuntimeNetworkStats stats;
+
+  RuntimeNetworkStats::RequestInfo network;
+  network.dns = TimeDelta::FromMilliseconds(5);
+  network.connect = TimeDelta::FromMilliseconds(20);
+  network.time_to_first_byte = TimeDelta::FromMilliseconds(80);
+  network.total = TimeDelta::FromMilliseconds(150);
+  stats.RecordStarted();
+  stats.RecordBytesRead(1000);
+  stats.RecordBytesRead(24);
+  stats.RecordCompleted(network);
+
+  RuntimeNetworkStats::RequestInfo cached;
+  cached.was_cached = true;
+  cached.total = TimeDelta::FromMilliseconds(2);
+  stats.RecordStarted();
+  stats.RecordCompleted(cached);
+
+  RuntimeNetworkStats::RequestInfo failed;
+  failed.net_error = net::ERR_NAME_NOT_RESOLVED;
+  stats.RecordStarted();
+  stats.RecordCompleted(failed);
+
+  // Canceled requests are counted apart, and don't make the ratios lower.
+  RuntimeNetworkStats::RequestInfo canceled;
+  canceled.was_canceled = true;
+  canceled.net_error = net::ERR_ABORTED;
+  stats.RecordStarted();
+  stats.RecordCompleted(canceled);
+
+  EXPECT_EQ(4, stats.started());
+  EXPECT_EQ(4, stats.completed());
+  EXPECT_EQ(1, stats.failed());
+  EXPECT_EQ(1, stats.canceled());
+  EXPECT_EQ(1, stats.cached());
+  EXPECT_EQ(1024, stats.bytes_read());
+
+  scoped_ptr<base::DictionaryValue> value(stats.ToValue());
+  double ratio = 0;
+  EXPECT_TRUE(value->GetDouble("cache_hit_ratio", &ratio));
+  EXPECT_DOUBLE_EQ(1.0 / 3, ratio);
+  EXPECT_TRUE(value->GetDouble("error_rate", &ratio));
+  EXPECT_DOUBLE_EQ(1.0 / 3, ratio);
+
+  // Timings that don't apply are not sampled.
+  double count = 0;
+  EXPECT_TRUE(value->GetDouble("latency.dns.count", &count));
+  EXPECT_EQ(1, count);
+  EXPECT_TRUE(value->GetDouble("latency.total.count", &count));
+  EXPECT_EQ(3, count);
+}
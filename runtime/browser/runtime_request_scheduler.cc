@@ -0,0 +1,342 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/runtime_request_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/resource_controller.h"
+#include "content/public/browser/resource_throttle.h"
+#include "net/url_request/url_request.h"
+#include "url/gurl.h"
+#include "xwalk/application/common/constants.h"
+#include "xwalk/runtime/common/xwalk_switches.h"
+
+using content::BrowserThread;
+
+namespace xwalk {
+
+namespace {
+
+base::LazyInstance<RuntimeRequestScheduler>::Leaky g_lazy_instance =
+    LAZY_INSTANCE_INITIALIZER;
+
+const char* const kStateNames[] = {
+  "foreground",
+  "background",
+  "suspended"
+};
+
+const int kDefaultMaxRequests[] = {
+  RuntimeRequestScheduler::kUnlimited,  // Foreground.
+  4,  // Background.
+  0   // Suspended.
+};
+
+// The resources needed to render the page.
+bool IsCriticalResource(content::ResourceType resource_type) {
+  switch (resource_type) {
+    case content::RESOURCE_TYPE_MAIN_FRAME:
+    case content::RESOURCE_TYPE_SUB_FRAME:
+    case content::RESOURCE_TYPE_STYLESHEET:
+    case content::RESOURCE_TYPE_SCRIPT:
+    case content::RESOURCE_TYPE_FONT_RESOURCE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+class RuntimeRequestScheduler::Throttle : public content::ResourceThrottle {
+ public:
+  Throttle(RuntimeRequestScheduler* scheduler,
+           const std::string& app_id,
+           net::URLRequest* request,
+           bool is_critical)
+      : scheduler_(scheduler),
+        app_id_(app_id),
+        request_(request),
+        initial_priority_(request ? request->priority()
+                                  : net::DEFAULT_PRIORITY),
+        is_critical_(is_critical),
+        state_(NOT_STARTED) {}
+
+  ~Throttle() override {
+    scheduler_->RequestFinished(this);
+  }
+
+  // content::ResourceThrottle implementation.
+  void WillStartRequest(bool* defer) override {
+    if (!scheduler_->StartOrDefer(this))
+      *defer = true;
+  }
+
+  const char* GetNameForLogging() const override {
+    return "RuntimeRequestScheduler";
+  }
+
+  const std::string& app_id() const { return app_id_; }
+  bool is_running() const { return state_ == RUNNING; }
+  bool is_pending() const { return state_ == PENDING; }
+
+  void SetPending() {
+    state_ = PENDING;
+  }
+
+  void SetRunning(ApplicationState application_state) {
+    state_ = RUNNING;
+    UpdatePriority(application_state);
+  }
+
+  // Also called on the running requests when the state of the application
+  // changes, the priority given by the renderer comes back in the
+  // foreground.
+  void UpdatePriority(ApplicationState application_state) {
+    if (!request_)
+      return;
+
+    if (application_state != APPLICATION_FOREGROUND)
+      request_->SetPriority(net::IDLE);
+    else if (is_critical_)
+      request_->SetPriority(net::HIGHEST);
+    else
+      request_->SetPriority(initial_priority_);
+  }
+
+  void ResumeDeferred() {
+    controller()->Resume();
+  }
+
+ private:
+  enum State {
+    NOT_STARTED,
+    PENDING,
+    RUNNING
+  };
+
+  RuntimeRequestScheduler* scheduler_;
+  std::string app_id_;
+  net::URLRequest* request_;
+  net::RequestPriority initial_priority_;
+  bool is_critical_;
+  State state_;
+
+  DISALLOW_COPY_AND_ASSIGN(Throttle);
+};
+
+RuntimeRequestScheduler::Policy::Policy() {
+  for (int i = 0; i < APPLICATION_STATE_COUNT; ++i)
+    max_requests[i] = kDefaultMaxRequests[i];
+}
+
+bool RuntimeRequestScheduler::Policy::Parse(const std::string& limits) {
+  std::vector<std::pair<std::string, std::string> > pairs;
+  if (!base::SplitStringIntoKeyValuePairs(limits, '=', ',', &pairs))
+    return false;
+
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    const char* const* name = std::find(kStateNames,
+        kStateNames + APPLICATION_STATE_COUNT, pairs[i].first);
+    if (name == kStateNames + APPLICATION_STATE_COUNT)
+      return false;
+
+    int max;
+    if (pairs[i].second == "unlimited")
+      max = kUnlimited;
+    else if (!base::StringToInt(pairs[i].second, &max) || max < 0)
+      return false;
+    max_requests[name - kStateNames] = max;
+  }
+  return true;
+}
+
+RuntimeRequestScheduler::Application::Application()
+    : state(APPLICATION_FOREGROUND) {
+}
+
+RuntimeRequestScheduler::Application::~Application() {
+}
+
+// static
+RuntimeRequestScheduler* RuntimeRequestScheduler::GetInstance() {
+  return g_lazy_instance.Pointer();
+}
+
+// static
+void RuntimeRequestScheduler::SetApplicationState(const std::string& app_id,
+                                                  ApplicationState state) {
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&RuntimeRequestScheduler::SetApplicationStateOnIOThread,
+                 base::Unretained(GetInstance()), app_id, state));
+}
+
+RuntimeRequestScheduler::RuntimeRequestScheduler() {
+  CommandLine* cmd_line = CommandLine::ForCurrentProcess();
+  if (!cmd_line->HasSwitch(switches::kXWalkAppRequestLimits))
+    return;
+
+  std::string limits =
+      cmd_line->GetSwitchValueASCII(switches::kXWalkAppRequestLimits);
+  Policy policy;
+  if (policy.Parse(limits))
+    policy_ = policy;
+  else
+    LOG(WARNING) << "Ignoring invalid application request limits: " << limits;
+}
+
+RuntimeRequestScheduler::RuntimeRequestScheduler(const Policy& policy)
+    : policy_(policy) {
+}
+
+RuntimeRequestScheduler::~RuntimeRequestScheduler() {
+}
+
+scoped_ptr<content::ResourceThrottle>
+RuntimeRequestScheduler::ScheduleRequest(
+    net::URLRequest* request, content::ResourceType resource_type) {
+  const GURL& first_party = request->first_party_for_cookies();
+  if (!first_party.SchemeIs(application::kApplicationScheme) ||
+      first_party.host().empty()) {
+    return scoped_ptr<content::ResourceThrottle>();
+  }
+  return ScheduleApplicationRequest(first_party.host(), request,
+                                    resource_type);
+}
+
+scoped_ptr<content::ResourceThrottle>
+RuntimeRequestScheduler::ScheduleApplicationRequest(
+    const std::string& app_id,
+    net::URLRequest* request,
+    content::ResourceType resource_type) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  return scoped_ptr<content::ResourceThrottle>(new Throttle(
+      this, app_id, request, IsCriticalResource(resource_type)));
+}
+
+void RuntimeRequestScheduler::SetApplicationStateOnIOThread(
+    const std::string& app_id, ApplicationState state) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  Application* application = GetApplication(app_id);
+  if (application->state != state) {
+    application->state = state;
+    for (std::set<Throttle*>::iterator it = application->running.begin();
+         it != application->running.end(); ++it) {
+      (*it)->UpdatePriority(state);
+    }
+  }
+  StartPendingRequests(app_id);
+  RemoveApplicationIfIdle(app_id);
+}
+
+size_t RuntimeRequestScheduler::GetRunningRequestCount(
+    const std::string& app_id) const {
+  ApplicationMap::const_iterator it = applications_.find(app_id);
+  return it == applications_.end() ? 0 : it->second->running.size();
+}
+
+size_t RuntimeRequestScheduler::GetPendingRequestCount(
+    const std::string& app_id) const {
+  ApplicationMap::const_iterator it = applications_.find(app_id);
+  return it == applications_.end() ? 0 : it->second->pending.size();
+}
+
+RuntimeRequestScheduler::Application* RuntimeRequestScheduler::GetApplication(
+    const std::string& app_id) {
+  linked_ptr<Application>& application = applications_[app_id];
+  if (!application.get())
+    application.reset(new Application);
+  return application.get();
+}
+
+bool RuntimeRequestScheduler::CanStartRequest(
+    const Application& application) const {
+  int max_requests = policy_.max_requests[application.state];
+  return max_requests == kUnlimited ||
+         application.running.size() < static_cast<size_t>(max_requests);
+}
+
+bool RuntimeRequestScheduler::StartOrDefer(Throttle* throttle) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  Application* application = GetApplication(throttle->app_id());
+
+  // Requests are started in order, so an application whose requests are
+  // deferred doesn't get new ones started first.
+  if (application->pending.empty() && CanStartRequest(*application)) {
+    application->running.insert(throttle);
+    throttle->SetRunning(application->state);
+    return true;
+  }
+
+  application->pending.push_back(throttle);
+  throttle->SetPending();
+  return false;
+}
+
+void RuntimeRequestScheduler::RequestFinished(Throttle* throttle) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  if (!throttle->is_running() && !throttle->is_pending())
+    return;
+
+  const std::string app_id = throttle->app_id();
+  Application* application = GetApplication(app_id);
+  if (throttle->is_running()) {
+    DCHECK(application->running.count(throttle));
+    application->running.erase(throttle);
+    StartPendingRequests(app_id);
+  } else {
+    std::deque<Throttle*>::iterator it = std::find(
+        application->pending.begin(), application->pending.end(), throttle);
+    DCHECK(it != application->pending.end());
+    application->pending.erase(it);
+  }
+  RemoveApplicationIfIdle(app_id);
+}
+
+void RuntimeRequestScheduler::StartPendingRequests(const std::string& app_id) {
+  // Resuming a request may finish others, so the application is looked up
+  // again for each of them.
+  while (true) {
+    ApplicationMap::iterator it = applications_.find(app_id);
+    if (it == applications_.end())
+      return;
+
+    Application* application = it->second.get();
+    if (application->pending.empty() || !CanStartRequest(*application))
+      return;
+
+    Throttle* throttle = application->pending.front();
+    application->pending.pop_front();
+    application->running.insert(throttle);
+    throttle->SetRunning(application->state);
+    throttle->ResumeDeferred();
+  }
+}
+
+void RuntimeRequestScheduler::RemoveApplicationIfIdle(
+    const std::string& app_id) {
+  ApplicationMap::iterator it = applications_.find(app_id);
+  if (it == applications_.end())
+    return;
+
+  // The state of applications not in the foreground is kept until it
+  // changes back.
+  const Application& application = *it->second;
+  if (application.state == APPLICATION_FOREGROUND &&
+      application.running.empty() && application.pending.empty()) {
+    applications_.erase(it);
+  }
+}
+
+}  // namespace xwalk
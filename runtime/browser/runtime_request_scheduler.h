@@ -0,0 +1,129 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_RUNTIME_REQUEST_SCHEDULER_H_
+#define XWALK_RUNTIME_BROWSER_RUNTIME_REQUEST_SCHEDULER_H_
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/memory/linked_ptr.h"
+#include "base/memory/scoped_ptr.h"
+#include "content/public/common/resource_type.h"
+
+namespace content {
+class ResourceThrottle;
+}
+
+namespace net {
+class URLRequest;
+}
+
+namespace xwalk {
+
+// Schedules the network requests of the applications according to their
+// state, so background applications don't compete with the foreground one:
+//   - The requests of an application are capped to a number running at the
+//     same time for its state, the others are deferred until some finish.
+//     Suspended applications have no request running by default.
+//   - The critical resources of foreground applications (frames, scripts,
+//     style sheets and fonts) get the highest priority, and the requests of
+//     background and suspended applications get the lowest. The running
+//     requests are re-prioritized when the state changes.
+//
+// The limits are configured with the --app-request-limits switch, e.g.
+// "foreground=unlimited,background=4,suspended=0", which are the defaults.
+//
+// Requests are attached to an application by their first party URL, which
+// is app://<application id>/ for application pages. Other requests are not
+// scheduled. Only used on the IO thread, except SetApplicationState().
+class RuntimeRequestScheduler {
+ public:
+  enum ApplicationState {
+    APPLICATION_FOREGROUND = 0,
+    APPLICATION_BACKGROUND,
+    APPLICATION_SUSPENDED,
+    APPLICATION_STATE_COUNT
+  };
+
+  static const int kUnlimited = -1;
+
+  struct Policy {
+    Policy();
+
+    // Parses the value of --app-request-limits, leaving the limits not
+    // given to their defaults. Returns false for an invalid value.
+    bool Parse(const std::string& limits);
+
+    // The number of requests of an application that can run at the same
+    // time in each state, or kUnlimited.
+    int max_requests[APPLICATION_STATE_COUNT];
+  };
+
+  static RuntimeRequestScheduler* GetInstance();
+
+  // Can be called from any thread.
+  static void SetApplicationState(const std::string& app_id,
+                                  ApplicationState state);
+
+  // Uses the policy from the command line.
+  RuntimeRequestScheduler();
+  explicit RuntimeRequestScheduler(const Policy& policy);
+  ~RuntimeRequestScheduler();
+
+  // Returns the throttle scheduling |request|, or NULL for requests not
+  // made by an application.
+  scoped_ptr<content::ResourceThrottle> ScheduleRequest(
+      net::URLRequest* request, content::ResourceType resource_type);
+
+  // Same as above, for a request already attached to |app_id|. |request| is
+  // only used to change its priority and may be NULL.
+  scoped_ptr<content::ResourceThrottle> ScheduleApplicationRequest(
+      const std::string& app_id,
+      net::URLRequest* request,
+      content::ResourceType resource_type);
+
+  void SetApplicationStateOnIOThread(const std::string& app_id,
+                                     ApplicationState state);
+
+  // The requests of |app_id| running and deferred.
+  size_t GetRunningRequestCount(const std::string& app_id) const;
+  size_t GetPendingRequestCount(const std::string& app_id) const;
+
+ private:
+  class Throttle;
+
+  struct Application {
+    Application();
+    ~Application();
+
+    ApplicationState state;
+    std::set<Throttle*> running;
+    std::deque<Throttle*> pending;
+  };
+  typedef std::map<std::string, linked_ptr<Application> > ApplicationMap;
+
+  Application* GetApplication(const std::string& app_id);
+  bool CanStartRequest(const Application& application) const;
+
+  // Called by the throttles.
+  bool StartOrDefer(Throttle* throttle);
+  void RequestFinished(Throttle* throttle);
+
+  // Starts the deferred requests of |app_id| allowed by its state.
+  void StartPendingRequests(const std::string& app_id);
+  void RemoveApplicationIfIdle(const std::string& app_id);
+
+  Policy policy_;
+  ApplicationMap applications_;
+
+  DISALLOW_COPY_AND_ASSIGN(RuntimeRequestScheduler);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_RUNTIME_REQUEST_SCHEDULER_H_
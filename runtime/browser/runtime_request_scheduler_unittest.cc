@@ -0,0 +1,176 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/runtime_request_scheduler.h"
+
+#include "base/memory/scoped_vector.h"
+#include "content/public/browser/resource_controller.h"
+#include "content/public/browser/resource_throttle.h"
+#include "content/public/test/test_browser_thread_bundle.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+using content::ResourceThrottle;
+using xwalk::RuntimeRequestScheduler;
+
+namespace {
+
+const char kAppId[] = "app";
+const char kOtherAppId[] = "other";
+
+class TestResourceController : public content::ResourceController {
+ public:
+  TestResourceController() : resumed_(0) {}
+
+  void Cancel() override {}
+  void CancelAndIgnore() override {}
+  void CancelWithError(int error_code) override {}
+  void Resume() override { resumed_++; }
+
+  int resumed() const { return resumed_; }
+
+ private:
+  int resumed_;
+};
+
+class RuntimeRequestSchedulerTest : public testing::Test {
+ protected:
+  RuntimeRequestSchedulerTest() {
+    RuntimeRequestScheduler::Policy policy;
+    EXPECT_TRUE(policy.Parse("background=2,suspended=0"));
+    scheduler_.reset(new RuntimeRequestScheduler(policy));
+  }
+
+  // Returns whether the request was started right away.
+  bool StartRequest(const std::string& app_id) {
+    return StartRequest(app_id, NULL, content::RESOURCE_TYPE_IMAGE);
+  }
+
+  bool StartRequest(const std::string& app_id,
+                    net::URLRequest* request,
+                    content::ResourceType resource_type) {
+    ResourceThrottle* throttle = scheduler_->ScheduleApplicationRequest(
+        app_id, request, resource_type).release();
+    throttle->set_controller_for_testing(&controller_);
+    throttles_.push_back(throttle);
+
+    bool defer = false;
+    throttle->WillStartRequest(&defer);
+    return !defer;
+  }
+
+  void FinishRequest(size_t index) {
+    throttles_.erase(throttles_.begin() + index);
+  }
+
+  content::TestBrowserThreadBundle thread_bundle_;
+  scoped_ptr<RuntimeRequestScheduler> scheduler_;
+  TestResourceController controller_;
+  ScopedVector<ResourceThrottle> throttles_;
+};
+
+}  // namespace
+
+TEST(RuntimeRequestSchedulerPolicyTest, Parse) {
+  RuntimeRequestScheduler::Policy policy;
+  const int* max = policy.max_requests;
+  EXPECT_EQ(RuntimeRequestScheduler::kUnlimited,
+            max[RuntimeRequestScheduler::APPLICATION_FOREGROUND]);
+
+  EXPECT_TRUE(policy.Parse("foreground=8,background=unlimited"));
+  EXPECT_EQ(8, max[RuntimeRequestScheduler::APPLICATION_FOREGROUND]);
+  EXPECT_EQ(RuntimeRequestScheduler::kUnlimited,
+            max[RuntimeRequestScheduler::APPLICATION_BACKGROUND]);
+  EXPECT_EQ(0, max[RuntimeRequestScheduler::APPLICATION_SUSPENDED]);
+
+  EXPECT_FALSE(policy.Parse("hidden=1"));
+  EXPECT_FALSE(policy.Parse("background=-2"));
+  EXPECT_FALSE(policy.Parse("background"));
+}
+
+TEST_F(RuntimeRequestSchedulerTest, ForegroundIsNotLimited) {
+  for (int i = 0; i < 10; ++i)
+    EXPECT_TRUE(StartRequest(kAppId));
+  EXPECT_EQ(10u, scheduler_->GetRunningRequestCount(kAppId));
+  EXPECT_EQ(0u, scheduler_->GetPendingRequestCount(kAppId));
+
+  throttles_.clear();
+  EXPECT_EQ(0u, scheduler_->GetRunningRequestCount(kAppId));
+}
+
+TEST_F(RuntimeRequestSchedulerTest, BackgroundIsLimited) {
+  scheduler_->SetApplicationStateOnIOThread(
+      kAppId, RuntimeRequestScheduler::APPLICATION_BACKGROUND);
+
+  EXPECT_TRUE(StartRequest(kAppId));
+  EXPECT_TRUE(StartRequest(kAppId));
+  EXPECT_FALSE(StartRequest(kAppId));
+  EXPECT_FALSE(StartRequest(kAppId));
+  EXPECT_EQ(2u, scheduler_->GetPendingRequestCount(kAppId));
+
+  // Other applications are not affected.
+  EXPECT_TRUE(StartRequest(kOtherAppId));
+
+  // A finished request lets the first deferred one start.
+  FinishRequest(0);
+  EXPECT_EQ(1, controller_.resumed());
+  EXPECT_EQ(2u, scheduler_->GetRunningRequestCount(kAppId));
+  EXPECT_EQ(1u, scheduler_->GetPendingRequestCount(kAppId));
+
+  // A deferred request can be canceled.
+  FinishRequest(2);
+  EXPECT_EQ(0u, scheduler_->GetPendingRequestCount(kAppId));
+  EXPECT_EQ(1, controller_.resumed());
+}
+
+TEST_F(RuntimeRequestSchedulerTest, SuspendedUntilResumed) {
+  scheduler_->SetApplicationStateOnIOThread(
+      kAppId, RuntimeRequestScheduler::APPLICATION_SUSPENDED);
+
+  EXPECT_FALSE(StartRequest(kAppId));
+  EXPECT_FALSE(StartRequest(kAppId));
+  EXPECT_FALSE(StartRequest(kAppId));
+  EXPECT_EQ(0u, scheduler_->GetRunningRequestCount(kAppId));
+
+  scheduler_->SetApplicationStateOnIOThread(
+      kAppId, RuntimeRequestScheduler::APPLICATION_BACKGROUND);
+  EXPECT_EQ(2, controller_.resumed());
+  EXPECT_EQ(1u, scheduler_->GetPendingRequestCount(kAppId));
+
+  scheduler_->SetApplicationStateOnIOThread(
+      kAppId, RuntimeRequestScheduler::APPLICATION_FOREGROUND);
+  EXPECT_EQ(3, controller_.resumed());
+  EXPECT_EQ(3u, scheduler_->GetRunningRequestCount(kAppId));
+}
+
+TEST_F(RuntimeRequestSchedulerTest, RunningRequestsFollowState) {
+  net::TestURLRequestContext context;
+  net::TestDelegate delegate;
+  scoped_ptr<net::URLRequest> script(context.CreateRequest(
+      GURL("app://app/script.js"), net::LOW, &delegate, NULL));
+  scoped_ptr<net::URLRequest> image(context.CreateRequest(
+      GURL("app://app/image.png"), net::LOW, &delegate, NULL));
+
+  EXPECT_TRUE(StartRequest(kAppId, script.get(),
+                           content::RESOURCE_TYPE_SCRIPT));
+  EXPECT_TRUE(StartRequest(kAppId, image.get(),
+                           content::RESOURCE_TYPE_IMAGE));
+  EXPECT_EQ(net::HIGHEST, script->priority());
+  EXPECT_EQ(net::LOW, image->priority());
+
+  // The requests already running are lowered with the application.
+  scheduler_->SetApplicationStateOnIOThread(
+      kAppId, RuntimeRequestScheduler::APPLICATION_BACKGROUND);
+  EXPECT_EQ(net::IDLE, script->priority());
+  EXPECT_EQ(net::IDLE, image->priority());
+
+  scheduler_->SetApplicationStateOnIOThread(
+      kAppId, RuntimeRequestScheduler::APPLICATION_FOREGROUND);
+  EXPECT_EQ(net::HIGHEST, script->priority());
+  EXPECT_EQ(net::LOW, image->priority());
+
+  throttles_.clear();
+}
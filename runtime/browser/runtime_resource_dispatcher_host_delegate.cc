@@ -18,6 +18,7 @@
 #include "net/http/http_response_headers.h"
 #include "net/url_request/url_request.h"
 #include "xwalk/runtime/browser/runtime_platform_util.h"
+#include "xwalk/runtime/browser/runtime_request_scheduler.h"
 
 #if defined(OS_ANDROID)
 #include "xwalk/runtime/browser/runtime_resource_dispatcher_host_delegate_android.h"
@@ -50,6 +51,11 @@ void RuntimeResourceDispatcherHostDelegate::RequestBeginning(
     content::AppCacheService* appcache_service,
     content::ResourceType resource_type,
     ScopedVector<content::ResourceThrottle>* throttles) {
+  scoped_ptr<content::ResourceThrottle> throttle =
+      RuntimeRequestScheduler::GetInstance()->ScheduleRequest(
+          request, resource_type);
+  if (throttle)
+    throttles->push_back(throttle.release());
 }
 
 void RuntimeResourceDispatcherHostDelegate::DownloadStarting(
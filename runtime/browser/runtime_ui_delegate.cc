@@ -4,11 +4,12 @@
 
 #include "xwalk/runtime/browser/runtime_ui_delegate.h"
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "grit/xwalk_resources.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "ui/gfx/image/image.h"
-#include "xwalk/runtime/browser/image_util.h"
+#include "xwalk/runtime/browser/icon_loader.h"
 #include "xwalk/runtime/browser/runtime.h"
 #include "xwalk/runtime/common/xwalk_switches.h"
 
@@ -21,24 +22,17 @@ namespace {
 const int kDefaultWidth = 840;
 const int kDefaultHeight = 600;
 
+// Window icons are never shown larger than this.
+const int kMaxAppIconSize = 256;
+
 NativeAppWindow* RuntimeCreateWindow(
     Runtime* runtime, const NativeAppWindow::CreateParams& params) {
   NativeAppWindow* window = NativeAppWindow::Create(params);
   // FIXME : Pass an App icon in params.
-  // Set the app icon if it is passed from command line.
-  CommandLine* command_line = CommandLine::ForCurrentProcess();
-  gfx::Image app_icon;
-  if (command_line->HasSwitch(switches::kAppIcon)) {
-    base::FilePath icon_file =
-        command_line->GetSwitchValuePath(switches::kAppIcon);
-    app_icon = xwalk_utils::LoadImageFromFilePath(icon_file);
-  } else {
-    // Otherwise, use the default icon for Crosswalk app.
-    ui::ResourceBundle& rb = ui::ResourceBundle::GetSharedInstance();
-    app_icon = rb.GetNativeImageNamed(IDR_XWALK_ICON_48);
-  }
-
-  window->UpdateIcon(app_icon);
+  // Use the default icon for Crosswalk app, until the one passed from command
+  // line is loaded.
+  ui::ResourceBundle& rb = ui::ResourceBundle::GetSharedInstance();
+  window->UpdateIcon(rb.GetNativeImageNamed(IDR_XWALK_ICON_48));
 
   unsigned int fullscreen_options = runtime->fullscreen_options();
   if (params.state == ui::SHOW_STATE_FULLSCREEN)
@@ -62,7 +56,9 @@ DefaultRuntimeUIDelegate::DefaultRuntimeUIDelegate(
     Runtime* runtime, const NativeAppWindow::CreateParams& params)
   : runtime_(runtime),
     window_params_(params),
-    window_(nullptr) {
+    window_(nullptr),
+    icon_updated_(false),
+    weak_ptr_factory_(this) {
   DCHECK(runtime_);
 }
 
@@ -77,6 +73,17 @@ void DefaultRuntimeUIDelegate::Show() {
     window_params_.delegate = this;
     window_params_.web_contents = runtime_->web_contents();
     window_ = RuntimeCreateWindow(runtime_, window_params_);
+    icon_updated_ = false;
+
+    // Set the app icon if it is passed from command line.
+    CommandLine* command_line = CommandLine::ForCurrentProcess();
+    if (command_line->HasSwitch(switches::kAppIcon)) {
+      IconLoader::GetInstance()->LoadIcon(
+          command_line->GetSwitchValuePath(switches::kAppIcon),
+          gfx::Size(kMaxAppIconSize, kMaxAppIconSize),
+          base::Bind(&DefaultRuntimeUIDelegate::OnAppIconLoaded,
+                     weak_ptr_factory_.GetWeakPtr()));
+    }
   }
   window_->Show();
 #else
@@ -90,7 +97,14 @@ void DefaultRuntimeUIDelegate::UpdateTitle(const base::string16& text) {
 }
 
 void DefaultRuntimeUIDelegate::UpdateIcon(const gfx::Image& image) {
-  if (window_)
+  if (!window_)
+    return;
+  window_->UpdateIcon(image);
+  icon_updated_ = true;
+}
+
+void DefaultRuntimeUIDelegate::OnAppIconLoaded(const gfx::Image& image) {
+  if (window_ && !icon_updated_ && !image.IsEmpty())
     window_->UpdateIcon(image);
 }
 
@@ -6,6 +6,7 @@
 #define XWALK_RUNTIME_BROWSER_RUNTIME_UI_DELEGATE_H_
 
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
 #include "xwalk/runtime/browser/ui/native_app_window.h"
 
 namespace xwalk {
@@ -48,9 +49,17 @@ class DefaultRuntimeUIDelegate : public RuntimeUIDelegate,
   virtual void OnWindowDestroyed() override;
 
  private:
+  // Applies the icon passed on the command line, unless the window got
+  // another icon, e.g. the favicon of the page, while it was loading.
+  void OnAppIconLoaded(const gfx::Image& image);
+
   Runtime* runtime_;
   NativeAppWindow::CreateParams window_params_;
   NativeAppWindow* window_;
+  // Whether UpdateIcon() was called since the window was created.
+  bool icon_updated_;
+
+  base::WeakPtrFactory<DefaultRuntimeUIDelegate> weak_ptr_factory_;
 };
 
 
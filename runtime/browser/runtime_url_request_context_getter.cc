@@ -8,12 +8,14 @@
 #include <algorithm>
 #include <vector>
 
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/threading/sequenced_worker_pool.h"
 #include "base/threading/worker_pool.h"
+#include "base/values.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/cookie_store_factory.h"
 #include "content/public/common/content_switches.h"
@@ -54,6 +56,14 @@ using content::BrowserThread;
 
 namespace xwalk {
 
+namespace {
+
+// Contexts sharing the network infrastructure of another one are those of
+// application storage partitions, keep their disk cache small.
+const int kSharedInfrastructureCacheSize = 20 * 1024 * 1024;
+
+}  // namespace
+
 RuntimeURLRequestContextGetter::RuntimeURLRequestContextGetter(
     bool ignore_certificate_errors,
     const base::FilePath& base_path,
@@ -65,6 +75,7 @@ RuntimeURLRequestContextGetter::RuntimeURLRequestContextGetter(
       base_path_(base_path),
       io_loop_(io_loop),
       file_loop_(file_loop),
+      share_socket_pools_(false),
       request_interceptors_(request_interceptors.Pass()) {
   // Must first be created on the UI thread.
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
@@ -82,6 +93,16 @@ RuntimeURLRequestContextGetter::RuntimeURLRequestContextGetter(
 RuntimeURLRequestContextGetter::~RuntimeURLRequestContextGetter() {
 }
 
+void RuntimeURLRequestContextGetter::ShareNetworkInfrastructureWith(
+    RuntimeURLRequestContextGetter* shared_getter, bool share_socket_pools) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  DCHECK(shared_getter && shared_getter != this);
+  shared_getter_ = shared_getter;
+  share_socket_pools_ = share_socket_pools;
+  // The proxy service of |shared_getter| is used instead.
+  proxy_config_service_.reset();
+}
+
 net::URLRequestContext* RuntimeURLRequestContextGetter::GetURLRequestContext() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
 
@@ -117,59 +138,83 @@ net::URLRequestContext* RuntimeURLRequestContextGetter::GetURLRequestContext() {
     storage_->set_http_user_agent_settings(new net::StaticHttpUserAgentSettings(
         "en-us,en", xwalk::GetUserAgent()));
 
-    scoped_ptr<net::HostResolver> host_resolver(
-        net::HostResolver::CreateDefaultResolver(NULL));
-
-    storage_->set_cert_verifier(net::CertVerifier::CreateDefault());
-    storage_->set_transport_security_state(new net::TransportSecurityState);
-    storage_->set_proxy_service(
-        net::ProxyService::CreateUsingSystemProxyResolver(
-        proxy_config_service_.release(),
-        0,
-        NULL));
-    storage_->set_ssl_config_service(new net::SSLConfigServiceDefaults);
-    storage_->set_http_auth_handler_factory(
-        net::HttpAuthHandlerFactory::CreateDefault(host_resolver.get()));
-    storage_->set_http_server_properties(scoped_ptr<net::HttpServerProperties>(
-        new net::HttpServerPropertiesImpl));
-
     base::FilePath cache_path = base_path_.Append(FILE_PATH_LITERAL("Cache"));
     net::HttpCache::DefaultBackend* main_backend =
         new net::HttpCache::DefaultBackend(
             net::DISK_CACHE,
             net::CACHE_BACKEND_DEFAULT,
             cache_path,
-            0,
+            shared_getter_.get() ? kSharedInfrastructureCacheSize : 0,
             BrowserThread::GetMessageLoopProxyForThread(
                 BrowserThread::CACHE));
 
-    net::HttpNetworkSession::Params network_session_params;
-    network_session_params.cert_verifier =
-        url_request_context_->cert_verifier();
-    network_session_params.transport_security_state =
-        url_request_context_->transport_security_state();
-    network_session_params.channel_id_service =
-        url_request_context_->channel_id_service();
-    network_session_params.proxy_service =
-        url_request_context_->proxy_service();
-    network_session_params.ssl_config_service =
-        url_request_context_->ssl_config_service();
-    network_session_params.http_auth_handler_factory =
-        url_request_context_->http_auth_handler_factory();
-    network_session_params.network_delegate =
-        network_delegate_.get();
-    network_session_params.http_server_properties =
-        url_request_context_->http_server_properties();
-    network_session_params.ignore_certificate_errors =
-        ignore_certificate_errors_;
-
-    // Give |storage_| ownership at the end in case it's |mapped_host_resolver|.
-    storage_->set_host_resolver(host_resolver.Pass());
-    network_session_params.host_resolver =
-        url_request_context_->host_resolver();
-
-    net::HttpCache* main_cache = new net::HttpCache(
-        network_session_params, main_backend);
+    storage_->set_transport_security_state(new net::TransportSecurityState);
+
+    net::HttpCache* main_cache = NULL;
+    if (shared_getter_.get()) {
+      net::URLRequestContext* shared_context =
+          shared_getter_->GetURLRequestContext();
+      url_request_context_->set_host_resolver(shared_context->host_resolver());
+      url_request_context_->set_cert_verifier(shared_context->cert_verifier());
+      url_request_context_->set_proxy_service(shared_context->proxy_service());
+      url_request_context_->set_ssl_config_service(
+          shared_context->ssl_config_service());
+      url_request_context_->set_http_auth_handler_factory(
+          shared_context->http_auth_handler_factory());
+      url_request_context_->set_http_server_properties(
+          shared_context->http_server_properties());
+
+      if (share_socket_pools_) {
+        // The network session also brings the transport security state and
+        // the channel IDs of |shared_context| along with its socket pools.
+        main_cache = new net::HttpCache(
+            shared_context->http_transaction_factory()->GetSession(),
+            main_backend);
+      }
+    } else {
+      scoped_ptr<net::HostResolver> host_resolver(
+          net::HostResolver::CreateDefaultResolver(NULL));
+
+      storage_->set_cert_verifier(net::CertVerifier::CreateDefault());
+      storage_->set_proxy_service(
+          net::ProxyService::CreateUsingSystemProxyResolver(
+          proxy_config_service_.release(),
+          0,
+          NULL));
+      storage_->set_ssl_config_service(new net::SSLConfigServiceDefaults);
+      storage_->set_http_auth_handler_factory(
+          net::HttpAuthHandlerFactory::CreateDefault(host_resolver.get()));
+      storage_->set_http_server_properties(
+          scoped_ptr<net::HttpServerProperties>(
+              new net::HttpServerPropertiesImpl));
+      storage_->set_host_resolver(host_resolver.Pass());
+    }
+
+    if (!main_cache) {
+      net::HttpNetworkSession::Params network_session_params;
+      network_session_params.cert_verifier =
+          url_request_context_->cert_verifier();
+      network_session_params.transport_security_state =
+          url_request_context_->transport_security_state();
+      network_session_params.channel_id_service =
+          url_request_context_->channel_id_service();
+      network_session_params.proxy_service =
+          url_request_context_->proxy_service();
+      network_session_params.ssl_config_service =
+          url_request_context_->ssl_config_service();
+      network_session_params.http_auth_handler_factory =
+          url_request_context_->http_auth_handler_factory();
+      network_session_params.network_delegate =
+          network_delegate_.get();
+      network_session_params.http_server_properties =
+          url_request_context_->http_server_properties();
+      network_session_params.ignore_certificate_errors =
+          ignore_certificate_errors_;
+      network_session_params.host_resolver =
+          url_request_context_->host_resolver();
+
+      main_cache = new net::HttpCache(network_session_params, main_backend);
+    }
     storage_->set_http_transaction_factory(main_cache);
 
 #if defined(OS_ANDROID)
@@ -271,4 +316,52 @@ net::HostResolver* RuntimeURLRequestContextGetter::host_resolver() {
   return url_request_context_->host_resolver();
 }
 
+void RuntimeURLRequestContextGetter::ReleaseNetworkResources() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(
+          &RuntimeURLRequestContextGetter::ReleaseNetworkResourcesOnIOThread,
+          this));
+}
+
+void RuntimeURLRequestContextGetter::ReleaseNetworkResourcesOnIOThread() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  if (!url_request_context_)
+    return;
+
+  net::CookieMonster* cookie_monster =
+      url_request_context_->cookie_store()->GetCookieMonster();
+  if (cookie_monster)
+    cookie_monster->FlushStore(base::Closure());
+
+  // A shared network session also holds the connections of other contexts.
+  if (share_socket_pools_)
+    return;
+  net::HttpNetworkSession* session =
+      url_request_context_->http_transaction_factory()->GetSession();
+  if (session)
+    session->CloseAllConnections();
+}
+
+void RuntimeURLRequestContextGetter::GetNetworkStats(
+    const NetworkStatsCallback& callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&RuntimeURLRequestContextGetter::GetNetworkStatsOnIOThread,
+                 this, callback));
+}
+
+void RuntimeURLRequestContextGetter::GetNetworkStatsOnIOThread(
+    const NetworkStatsCallback& callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  // The delegate is only created once the context is first used.
+  scoped_ptr<base::DictionaryValue> stats;
+  if (network_delegate_)
+    stats = network_delegate_->stats().ToValue();
+  else
+    stats = RuntimeNetworkStats().ToValue();
+  BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
+      base::Bind(callback, base::Passed(&stats)));
+}
+
 }  // namespace xwalk
@@ -5,6 +5,7 @@
 #ifndef XWALK_RUNTIME_BROWSER_RUNTIME_URL_REQUEST_CONTEXT_GETTER_H_
 #define XWALK_RUNTIME_BROWSER_RUNTIME_URL_REQUEST_CONTEXT_GETTER_H_
 
+#include "base/callback.h"
 #include "base/compiler_specific.h"
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
@@ -14,6 +15,7 @@
 #include "net/url_request/url_request_job_factory.h"
 
 namespace base {
+class DictionaryValue;
 class MessageLoop;
 }
 
@@ -28,6 +30,8 @@ class URLRequestJobFactory;
 
 namespace xwalk {
 
+class RuntimeNetworkDelegate;
+
 class RuntimeURLRequestContextGetter : public net::URLRequestContextGetter {
  public:
   RuntimeURLRequestContextGetter(
@@ -38,6 +42,16 @@ class RuntimeURLRequestContextGetter : public net::URLRequestContextGetter {
       content::ProtocolHandlerMap* protocol_handlers,
       content::URLRequestInterceptorScopedVector request_interceptors);
 
+  // Makes the context use the host resolver, certificate verifier, proxy
+  // service and HTTP server properties of |shared_getter|. Cookies and the
+  // disk cache stay private to this context. When |share_socket_pools| is
+  // true, the HTTP network session of |shared_getter| is used as well, and
+  // with it the channel IDs of |shared_getter| for the TLS connections;
+  // otherwise channel IDs stay private too. Must be called before the
+  // context is first used.
+  void ShareNetworkInfrastructureWith(
+      RuntimeURLRequestContextGetter* shared_getter, bool share_socket_pools);
+
   // net::URLRequestContextGetter implementation.
   net::URLRequestContext* GetURLRequestContext() override;
   scoped_refptr<base::SingleThreadTaskRunner>
@@ -45,16 +59,30 @@ class RuntimeURLRequestContextGetter : public net::URLRequestContextGetter {
 
   net::HostResolver* host_resolver();
 
+  // Closes the connections of the context and flushes its cookies to disk,
+  // the context itself remains usable.
+  void ReleaseNetworkResources();
+
+  // Replies on the UI thread with the RuntimeNetworkStats of the context.
+  typedef base::Callback<void(scoped_ptr<base::DictionaryValue>)>
+      NetworkStatsCallback;
+  void GetNetworkStats(const NetworkStatsCallback& callback);
+
  private:
   virtual ~RuntimeURLRequestContextGetter();
 
+  void ReleaseNetworkResourcesOnIOThread();
+  void GetNetworkStatsOnIOThread(const NetworkStatsCallback& callback);
+
   bool ignore_certificate_errors_;
   base::FilePath base_path_;
   base::MessageLoop* io_loop_;
   base::MessageLoop* file_loop_;
+  scoped_refptr<RuntimeURLRequestContextGetter> shared_getter_;
+  bool share_socket_pools_;
 
   scoped_ptr<net::ProxyConfigService> proxy_config_service_;
-  scoped_ptr<net::NetworkDelegate> network_delegate_;
+  scoped_ptr<RuntimeNetworkDelegate> network_delegate_;
   scoped_ptr<net::URLRequestContextStorage> storage_;
   scoped_ptr<net::URLRequestContext> url_request_context_;
   content::ProtocolHandlerMap protocol_handlers_;
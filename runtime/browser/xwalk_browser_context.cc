@@ -12,7 +12,6 @@
 #include "base/command_line.h"
 #include "base/logging.h"
 #include "base/path_service.h"
-#include "base/strings/utf_string_conversions.h"
 #include "components/visitedlink/browser/visitedlink_master.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_process_host.h"
@@ -201,16 +200,45 @@ content::SSLHostStateDelegate* XWalkBrowserContext::GetSSLHostStateDelegate() {
 RuntimeURLRequestContextGetter*
 XWalkBrowserContext::GetURLRequestContextGetterById(
     const std::string& pkg_id) {
-  for (PartitionPathContextGetterMap::iterator it = context_getters_.begin();
-       it != context_getters_.end(); ++it) {
-#if defined(OS_WIN)
-    if (it->first.find(base::UTF8ToWide(pkg_id)))
-#else
-    if (it->first.find(pkg_id))
-#endif
-      return it->second.get();
-  }
-  return 0;
+  PackageIdContextGetterMap::iterator it =
+      package_context_getters_.find(pkg_id);
+  if (it == package_context_getters_.end())
+    return NULL;
+  return it->second.get();
+}
+
+void XWalkBrowserContext::ReleaseNetworkResourcesById(
+    const std::string& pkg_id) {
+  RuntimeURLRequestContextGetter* getter =
+      GetURLRequestContextGetterById(pkg_id);
+  if (getter)
+    getter->ReleaseNetworkResources();
+}
+
+std::string XWalkBrowserContext::GetPackageIdFromPartitionPath(
+    const base::FilePath& partition_path) const {
+  // Content stores the partitions of a domain, which is the application ID
+  // for applications, in "Storage/ext/<domain>/<partition>".
+  base::FilePath domains_path = GetPath().Append(FILE_PATH_LITERAL("Storage"))
+                                         .Append(FILE_PATH_LITERAL("ext"));
+  base::FilePath relative_path;
+  if (!domains_path.AppendRelativePath(partition_path, &relative_path))
+    return std::string();
+
+  std::vector<base::FilePath::StringType> components;
+  relative_path.GetComponents(&components);
+  if (components.empty())
+    return std::string();
+  return base::FilePath(components[0]).AsUTF8Unsafe();
+}
+
+void XWalkBrowserContext::AddContextGetter(
+    const base::FilePath& partition_path,
+    RuntimeURLRequestContextGetter* context_getter) {
+  context_getters_[partition_path.value()] = context_getter;
+  const std::string pkg_id = GetPackageIdFromPartitionPath(partition_path);
+  if (!pkg_id.empty())
+    package_context_getters_[pkg_id] = context_getter;
 }
 
 net::URLRequestContextGetter* XWalkBrowserContext::CreateRequestContext(
@@ -249,6 +277,15 @@ net::URLRequestContextGetter*
   if (iter != context_getters_.end())
     return iter->second.get();
 
+  // Make sure that the default url request getter has been initialized,
+  // please refer to https://crosswalk-project.org/jira/browse/XWALK-2890
+  // for more details.
+  if (!url_request_getter_.get()) {
+    content::ProtocolHandlerMap default_protocol_handlers;
+    CreateRequestContext(&default_protocol_handlers,
+                         content::URLRequestInterceptorScopedVector());
+  }
+
   application::ApplicationService* service =
       XWalkRunner::GetInstance()->app_system()->application_service();
   protocol_handlers->insert(std::pair<std::string,
@@ -264,14 +301,14 @@ net::URLRequestContextGetter*
       BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::FILE),
       protocol_handlers, request_interceptors.Pass());
 
-  context_getters_.insert(
-      std::make_pair(partition_path.value(), context_getter));
-  // Make sure that the default url request getter has been initialized,
-  // please refer to https://crosswalk-project.org/jira/browse/XWALK-2890
-  // for more details.
-  if (!url_request_getter_.get())
-    CreateRequestContext(protocol_handlers, request_interceptors.Pass());
+  CommandLine* cmd_line = CommandLine::ForCurrentProcess();
+  if (cmd_line->HasSwitch(switches::kXWalkShareNetworkInfrastructure)) {
+    context_getter->ShareNetworkInfrastructureWith(
+        url_request_getter_.get(),
+        cmd_line->HasSwitch(switches::kXWalkShareSocketPools));
+  }
 
+  AddContextGetter(partition_path, context_getter.get());
   return context_getter.get();
 #endif
 }
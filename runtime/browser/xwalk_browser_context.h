@@ -6,15 +6,14 @@
 #ifndef XWALK_RUNTIME_BROWSER_XWALK_BROWSER_CONTEXT_H_
 #define XWALK_RUNTIME_BROWSER_XWALK_BROWSER_CONTEXT_H_
 
-#if defined(OS_ANDROID)
-#include <string>
-#endif
-
 #include <map>
+#include <string>
 #include <vector>
 
 #include "base/compiler_specific.h"
+#include "base/containers/hash_tables.h"
 #include "base/files/file_path.h"
+#include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "components/visitedlink/browser/visitedlink_delegate.h"
@@ -72,8 +71,14 @@ class XWalkBrowserContext
   content::PushMessagingService* GetPushMessagingService() override;
   content::SSLHostStateDelegate* GetSSLHostStateDelegate() override;
 
+  // Returns the request context getter of the storage partition of the
+  // application with |pkg_id|, or NULL if there is none.
   RuntimeURLRequestContextGetter* GetURLRequestContextGetterById(
       const std::string& pkg_id);
+  // Releases the connections held by the storage partition of the
+  // application with |pkg_id| once it terminates. The partition is kept, it
+  // is reused if the application is launched again.
+  void ReleaseNetworkResourcesById(const std::string& pkg_id);
   net::URLRequestContextGetter* CreateRequestContext(
       content::ProtocolHandlerMap* protocol_handlers,
       content::URLRequestInterceptorScopedVector request_interceptors);
@@ -93,12 +98,27 @@ class XWalkBrowserContext
 #endif
 
  private:
+  FRIEND_TEST_ALL_PREFIXES(XWalkBrowserContextTest,
+                           GetPackageIdFromPartitionPath);
+  FRIEND_TEST_ALL_PREFIXES(XWalkBrowserContextTest,
+                           GetURLRequestContextGetterById);
+
   class RuntimeResourceContext;
 
   // Performs initialization of the XWalkBrowserContext while IO is still
   // allowed on the current thread.
   void InitWhileIOAllowed();
 
+  // Returns the ID of the application owning the storage partition at
+  // |partition_path|, or an empty string for other partitions.
+  std::string GetPackageIdFromPartitionPath(
+      const base::FilePath& partition_path) const;
+
+  // Keeps |context_getter| for |partition_path|, and for the ID of the
+  // application owning the partition if there is one.
+  void AddContextGetter(const base::FilePath& partition_path,
+                        RuntimeURLRequestContextGetter* context_getter);
+
 #if defined(OS_ANDROID)
   // Reset visitedlink master and initialize it.
   void InitVisitedLinkMaster();
@@ -117,6 +137,11 @@ class XWalkBrowserContext
       PartitionPathContextGetterMap;
   PartitionPathContextGetterMap context_getters_;
 
+  typedef base::hash_map<std::string,
+      scoped_refptr<RuntimeURLRequestContextGetter> >
+      PackageIdContextGetterMap;
+  PackageIdContextGetterMap package_context_getters_;
+
   DISALLOW_COPY_AND_ASSIGN(XWalkBrowserContext);
 };
 
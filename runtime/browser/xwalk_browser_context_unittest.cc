@@ -0,0 +1,98 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
+
+#include <string>
+
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/ref_counted.h"
+#include "base/test/scoped_path_override.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/test/test_browser_thread_bundle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/runtime/browser/runtime_url_request_context_getter.h"
+#include "xwalk/runtime/common/xwalk_paths.h"
+
+using content::BrowserThread;
+
+namespace xwalk {
+
+class XWalkBrowserContextTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_override_.reset(
+        new base::ScopedPathOverride(DIR_DATA_PATH, temp_dir_.path()));
+    browser_context_.reset(new XWalkBrowserContext);
+  }
+
+  void TearDown() override {
+    browser_context_.reset();
+    path_override_.reset();
+  }
+
+  base::FilePath PartitionPath(const std::string& domain) const {
+    return temp_dir_.path().AppendASCII("Storage").AppendASCII("ext")
+        .AppendASCII(domain).AppendASCII("def");
+  }
+
+  scoped_refptr<RuntimeURLRequestContextGetter> CreateContextGetter(
+      const base::FilePath& partition_path) {
+    content::ProtocolHandlerMap protocol_handlers;
+    return new RuntimeURLRequestContextGetter(
+        false,
+        partition_path,
+        BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::IO),
+        BrowserThread::UnsafeGetMessageLoopForThread(BrowserThread::FILE),
+        &protocol_handlers,
+        content::URLRequestInterceptorScopedVector());
+  }
+
+  content::TestBrowserThreadBundle thread_bundle_;
+  base::ScopedTempDir temp_dir_;
+  scoped_ptr<base::ScopedPathOverride> path_override_;
+  scoped_ptr<XWalkBrowserContext> browser_context_;
+};
+
+TEST_F(XWalkBrowserContextTest, GetPackageIdFromPartitionPath) {
+  EXPECT_EQ("abcdefghijklmnopabcdefghijklmnop",
+            browser_context_->GetPackageIdFromPartitionPath(
+                PartitionPath("abcdefghijklmnopabcdefghijklmnop")));
+
+  // Partitions outside of "Storage/ext" belong to no application.
+  EXPECT_EQ("", browser_context_->GetPackageIdFromPartitionPath(
+                    temp_dir_.path()));
+  EXPECT_EQ("", browser_context_->GetPackageIdFromPartitionPath(
+                    temp_dir_.path().AppendASCII("Storage")
+                                    .AppendASCII("ext")));
+  EXPECT_EQ("", browser_context_->GetPackageIdFromPartitionPath(
+                    base::FilePath(FILE_PATH_LITERAL("/other/Storage/ext/"
+                                                     "app/def"))));
+}
+
+TEST_F(XWalkBrowserContextTest, GetURLRequestContextGetterById) {
+  scoped_refptr<RuntimeURLRequestContextGetter> first =
+      CreateContextGetter(PartitionPath("first"));
+  scoped_refptr<RuntimeURLRequestContextGetter> second =
+      CreateContextGetter(PartitionPath("second"));
+  scoped_refptr<RuntimeURLRequestContextGetter> other =
+      CreateContextGetter(temp_dir_.path().AppendASCII("other"));
+  browser_context_->AddContextGetter(PartitionPath("first"), first.get());
+  browser_context_->AddContextGetter(PartitionPath("second"), second.get());
+  browser_context_->AddContextGetter(temp_dir_.path().AppendASCII("other"),
+                                     other.get());
+
+  EXPECT_EQ(first.get(),
+            browser_context_->GetURLRequestContextGetterById("first"));
+  EXPECT_EQ(second.get(),
+            browser_context_->GetURLRequestContextGetterById("second"));
+
+  // The IDs must match exactly, and other partitions are not returned.
+  EXPECT_EQ(NULL, browser_context_->GetURLRequestContextGetterById("fir"));
+  EXPECT_EQ(NULL, browser_context_->GetURLRequestContextGetterById("other"));
+  EXPECT_EQ(NULL, browser_context_->GetURLRequestContextGetterById(""));
+}
+
+}  // namespace xwalk
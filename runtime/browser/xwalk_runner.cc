@@ -161,13 +161,29 @@ void XWalkRunner::OnRenderProcessWillLaunch(content::RenderProcessHost* host) {
   main_parts->CreateInternalExtensionsForExtensionThread(
       host, &extension_thread_extensions);
 
-  scoped_ptr<base::ValueMap> runtime_variables(new base::ValueMap);
-  InitializeRuntimeVariablesForExtensions(host, runtime_variables.get());
+  // The runtime variables of a spare render process are only known once an
+  // application claims it, see OnSpareRenderProcessClaimed().
+  scoped_ptr<base::ValueMap> runtime_variables;
+  if (!app_system()->application_service()->IsSpareRenderProcess(
+          host->GetID())) {
+    runtime_variables.reset(new base::ValueMap);
+    InitializeRuntimeVariablesForExtensions(host, runtime_variables.get());
+  }
   extension_service_->OnRenderProcessWillLaunch(
       host, &ui_thread_extensions, &extension_thread_extensions,
       runtime_variables.Pass());
 }
 
+void XWalkRunner::OnSpareRenderProcessClaimed(
+    content::RenderProcessHost* host) {
+  if (!extension_service_)
+    return;
+
+  scoped_ptr<base::ValueMap> runtime_variables(new base::ValueMap);
+  InitializeRuntimeVariablesForExtensions(host, runtime_variables.get());
+  extension_service_->SetRuntimeVariables(host, runtime_variables.Pass());
+}
+
 void XWalkRunner::OnRenderProcessHostGone(content::RenderProcessHost* host) {
   if (!extension_service_)
     return;
@@ -120,6 +120,11 @@ class XWalkRunner {
   void OnRenderProcessWillLaunch(content::RenderProcessHost* host);
   void OnRenderProcessHostGone(content::RenderProcessHost* host);
 
+  // A spare render process is launched before knowing which application it
+  // will host, so the extensions depending on it are only set up when an
+  // application claims it.
+  void OnSpareRenderProcessClaimed(content::RenderProcessHost* host);
+
   // Create the XWalkRunner object. We use a factory function so that we can
   // switch the concrete class on compile time based on the platform, separating
   // the per-platform behavior and data in the subclasses.
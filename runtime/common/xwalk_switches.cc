@@ -15,6 +15,10 @@ const char kDisablePnacl[] = "disable-pnacl";
 // Disables the shared process mode
 const char kXWalkDisableSharedProcessMode[] = "disable-shared-process-mode";
 
+// Keeps an initialized render process around in shared process mode, so that
+// the next application launch does not have to wait for it to start.
+const char kXWalkEnableSpareRenderer[] = "enable-spare-renderer";
+
 // Enable all the experimental features in XWalk.
 const char kExperimentalFeatures[] = "enable-xwalk-experimental-features";
 
@@ -27,6 +31,19 @@ const char kListFeaturesFlags[] = "list-features-flags";
 const char kXWalkAllowExternalExtensionsForRemoteSources[] =
     "allow-external-extensions-for-remote-sources";
 
+// Limits the network requests each application can have running at the same
+// time, depending on its state, e.g. "background=4,suspended=0". The other
+// requests are deferred. See RuntimeRequestScheduler.
+const char kXWalkAppRequestLimits[] = "app-request-limits";
+
+// Makes the network contexts of application storage partitions use the host
+// resolver, certificate verifier and proxy service of the default one.
+const char kXWalkShareNetworkInfrastructure[] = "share-network-infrastructure";
+
+// Along with --share-network-infrastructure, also shares the socket pools of
+// the default network context with the application storage partitions.
+const char kXWalkShareSocketPools[] = "share-socket-pools";
+
 // Specifies the data path directory, which XWalk runtime will look for its
 // state, e.g. cache, localStorage etc.
 const char kXWalkDataPath[] = "data-path";
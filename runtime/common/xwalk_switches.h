@@ -16,8 +16,12 @@ extern const char kExperimentalFeatures[];
 extern const char kFullscreen[];
 extern const char kListFeaturesFlags[];
 extern const char kXWalkAllowExternalExtensionsForRemoteSources[];
+extern const char kXWalkAppRequestLimits[];
 extern const char kXWalkDataPath[];
 extern const char kXWalkDisableSharedProcessMode[];
+extern const char kXWalkEnableSpareRenderer[];
+extern const char kXWalkShareNetworkInfrastructure[];
+extern const char kXWalkShareSocketPools[];
 
 #if defined(OS_ANDROID)
 extern const char kXWalkProfileName[];
@@ -5,6 +5,8 @@
 #ifndef XWALK_SYSAPPS_COMMON_BINDING_OBJECT_H_
 #define XWALK_SYSAPPS_COMMON_BINDING_OBJECT_H_
 
+#include <vector>
+
 #include "xwalk/extensions/browser/xwalk_extension_function_handler.h"
 
 namespace xwalk {
@@ -29,8 +31,30 @@ class BindingObject {
     return handler_.HandleFunction(info.Pass());
   }
 
+  // Same as above for a function interned by the BindingObjectStore as
+  // |method_id|. The handler is only looked up by name on the first call.
+  bool HandleFunction(size_t method_id,
+                      scoped_ptr<XWalkExtensionFunctionInfo> info) {
+    if (method_id >= interned_handlers_.size())
+      interned_handlers_.resize(method_id + 1);
+
+    const XWalkExtensionFunctionHandler::FunctionHandler*& function_handler =
+        interned_handlers_[method_id];
+    if (!function_handler)
+      function_handler = handler_.GetHandler(info->name());
+    if (!function_handler)
+      return false;
+
+    function_handler->Run(info.Pass());
+    return true;
+  }
+
  protected:
   XWalkExtensionFunctionHandler handler_;
+
+ private:
+  std::vector<const XWalkExtensionFunctionHandler::FunctionHandler*>
+      interned_handlers_;
 };
 
 }  // namespace sysapps
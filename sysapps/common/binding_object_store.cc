@@ -20,6 +20,12 @@ BindingObjectStore::BindingObjectStore(XWalkExtensionFunctionHandler* handler)
   handler->Register("postMessageToObject",
       base::Bind(&BindingObjectStore::OnPostMessageToObject,
                  base::Unretained(this)));
+  handler->Register("defineMethod",
+      base::Bind(&BindingObjectStore::OnDefineMethod,
+                 base::Unretained(this)));
+  handler->Register("callObjectMethod",
+      base::Bind(&BindingObjectStore::OnCallObjectMethod,
+                 base::Unretained(this)));
 }
 
 BindingObjectStore::~BindingObjectStore() {}
@@ -95,5 +101,63 @@ void BindingObjectStore::OnPostMessageToObject(
   }
 }
 
+void BindingObjectStore::OnDefineMethod(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  scoped_ptr<DefineMethod::Params>
+      params(DefineMethod::Params::Create(*info->arguments()));
+
+  if (!params) {
+    LOG(WARNING) << "Malformed parameters passed to " << info->name();
+    return;
+  }
+
+  // IDs are allocated sequentially by the JavaScript side.
+  if (params->method_id != static_cast<int>(method_names_.size())) {
+    LOG(WARNING) << "Unexpected ID " << params->method_id << " for the "
+        "method " << params->name << ".";
+    return;
+  }
+
+  method_names_.push_back(params->name);
+}
+
+void BindingObjectStore::OnCallObjectMethod(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  // The arguments are not described in the IDL, the generated Params would
+  // copy them. They are moved instead.
+  base::ListValue* args = info->arguments();
+  std::string object_id;
+  int method_id;
+  if (!args->GetString(0, &object_id) || !args->GetInteger(1, &method_id) ||
+      method_id < 0 || method_id >= static_cast<int>(method_names_.size())) {
+    LOG(WARNING) << "Malformed parameters passed to " << info->name();
+    return;
+  }
+
+  BindingObjectMap::iterator it = objects_.find(object_id);
+  if (it == objects_.end())
+    return;
+
+  scoped_ptr<base::ListValue> new_args(new base::ListValue);
+  while (args->GetSize() > 2) {
+    scoped_ptr<base::Value> value;
+    args->Remove(2, &value);
+    new_args->Append(value.release());
+  }
+
+  const std::string& name = method_names_[method_id];
+  scoped_ptr<XWalkExtensionFunctionInfo> new_info(
+      new XWalkExtensionFunctionInfo(
+          name,
+          new_args.Pass(),
+          info->post_result_cb()));
+
+  if (!it->second->HandleFunction(method_id, new_info.Pass())) {
+    LOG(WARNING) << "The object with the ID " << object_id << " has no "
+        "handler for the function " << name << ".";
+    return;
+  }
+}
+
 }  // namespace sysapps
 }  // namespace xwalk
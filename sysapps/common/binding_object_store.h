@@ -7,6 +7,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "base/memory/scoped_ptr.h"
 #include "base/stl_util.h"
 #include "xwalk/extensions/browser/xwalk_extension_function_handler.h"
@@ -38,6 +39,13 @@ class BindingObjectStore {
   void OnJSObjectCollected(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnPostMessageToObject(scoped_ptr<XWalkExtensionFunctionInfo> info);
 
+  // Method names are interned by the JavaScript side the first time they are
+  // used, so the calls that follow only carry an integer.
+  void OnDefineMethod(scoped_ptr<XWalkExtensionFunctionInfo> info);
+  void OnCallObjectMethod(scoped_ptr<XWalkExtensionFunctionInfo> info);
+
+  std::vector<std::string> method_names_;
+
   typedef std::map<std::string, BindingObject*> BindingObjectMap;
   BindingObjectMap objects_;
   STLValueDeleter<BindingObjectMap> objects_deleter_;
@@ -182,3 +182,58 @@ TEST(XWalkSysAppsBindingObjectStoreTest, OnPostMessageToObject) {
   store.reset();
   EXPECT_EQ(BindingObjectTest::instance_count(), 0);
 }
+
+TEST(XWalkSysAppsBindingObjectStoreTest, OnCallObjectMethod) {
+  XWalkExtensionFunctionHandler handler(NULL);
+  scoped_ptr<BindingObjectStore> store(new BindingObjectStore(&handler));
+
+  BindingObjectTest* binding_object(new BindingObjectTest());
+  store->AddBindingObject("foobar1",
+                          make_scoped_ptr<BindingObject>(binding_object));
+
+  // Calling a method that was not defined is ignored.
+  scoped_ptr<base::ListValue> arguments(new base::ListValue);
+  arguments->AppendString("foobar1");
+  arguments->AppendInteger(0);
+  arguments->AppendString(kTestString);
+  EXPECT_TRUE(handler.HandleFunction(make_scoped_ptr(
+      new XWalkExtensionFunctionInfo("callObjectMethod",
+                                     arguments.Pass(),
+                                     base::Bind(&DummyCallback)))));
+  EXPECT_EQ(binding_object->call_count(), 0);
+
+  // Method IDs are expected to be sequential.
+  scoped_ptr<base::ListValue> definition(new base::ListValue);
+  definition->AppendInteger(1);
+  definition->AppendString("test");
+  EXPECT_TRUE(handler.HandleFunction(make_scoped_ptr(
+      new XWalkExtensionFunctionInfo("defineMethod",
+                                     definition.Pass(),
+                                     base::Bind(&DummyCallback)))));
+
+  definition.reset(new base::ListValue);
+  definition->AppendInteger(0);
+  definition->AppendString("test");
+  EXPECT_TRUE(handler.HandleFunction(make_scoped_ptr(
+      new XWalkExtensionFunctionInfo("defineMethod",
+                                     definition.Pass(),
+                                     base::Bind(&DummyCallback)))));
+
+  for (unsigned i = 0; i < 1000; ++i) {
+    arguments.reset(new base::ListValue);
+
+    // Object ID, interned method ID and the arguments of the method.
+    arguments->AppendString("foobar1");
+    arguments->AppendInteger(0);
+    arguments->AppendString(kTestString);
+
+    EXPECT_TRUE(handler.HandleFunction(make_scoped_ptr(
+        new XWalkExtensionFunctionInfo("callObjectMethod",
+                                       arguments.Pass(),
+                                       base::Bind(&DummyCallback)))));
+    EXPECT_EQ(binding_object->call_count(), i + 1);
+  }
+
+  store.reset();
+  EXPECT_EQ(BindingObjectTest::instance_count(), 0);
+}
@@ -13,6 +13,22 @@ function getUniqueId() {
   return (unique_id++).toString();
 }
 
+// Method names are sent only once to the native side, which maps them to
+// the integer IDs used by the following calls.
+var method_ids = {};
+var method_count = 0;
+
+function getMethodId(name) {
+  var id = method_ids[name];
+  if (id !== undefined)
+    return id;
+
+  id = method_count++;
+  method_ids[name] = id;
+  internal.postMessage("defineMethod", [id, name]);
+  return id;
+}
+
 function wrapPromiseAsCallback(promise) {
   return function(data, error) {
     if (error)
@@ -57,8 +73,8 @@ function wrapPromiseAsCallback(promise) {
 //
 var BindingObjectPrototype = function() {
   function postMessage(name, args, callback) {
-    return internal.postMessage("postMessageToObject",
-        [this._id, name, args], callback);
+    return internal.postMessage("callObjectMethod",
+        [this._id, getMethodId(name)].concat(args), callback);
   };
 
   function isEnumerable(method_name) {
@@ -211,9 +227,18 @@ var EventTargetPrototype = function() {
   // We need a reference to the calling object because
   // this function is called by the renderer process with
   // "this" equals to the global object.
+  //
+  // Events queued by the native side are delivered in a single message, as
+  // the list of the data of each event.
   function makeCallbackListener(obj, type) {
-    return function(data) {
-      obj._dispatchEventFromExtension(type, data);
+    return function(data, is_queued) {
+      if (!is_queued) {
+        obj._dispatchEventFromExtension(type, data);
+        return true;
+      }
+
+      for (var i = 0; i < data.length; ++i)
+        obj._dispatchEventFromExtension(type, data[i][0]);
       return true;
     };
   };
@@ -231,9 +256,14 @@ var EventTargetPrototype = function() {
         listeners.push(listener);
     } else {
       this._event_listeners[type] = [listener];
+
+      // Objects sharing the same native object register their listeners
+      // separately, so each one of them gets the events.
+      var listener_id = getUniqueId();
       var id = this._postMessage("addEventListener",
-          [type], makeCallbackListener(this, type));
+          [type, listener_id], makeCallbackListener(this, type));
       this._callback_listeners_id[type] = id;
+      this._native_listeners_id[type] = listener_id;
     }
   };
 
@@ -252,8 +282,10 @@ var EventTargetPrototype = function() {
     if (listeners.length == 1) {
       internal.removeCallback(this._callback_listeners_id[type]);
       delete this._event_listeners[type];
+      this._postMessage("removeEventListener",
+          [type, this._native_listeners_id[type]]);
       delete this._callback_listeners_id[type];
-      this._postMessage("removeEventListener", [type]);
+      delete this._native_listeners_id[type];
     } else {
       listeners.splice(index, 1);
     }
@@ -289,6 +321,9 @@ var EventTarget = function(object_id) {
     "_callback_listeners_id": {
       value: {},
     },
+    "_native_listeners_id": {
+      value: {},
+    },
     "_event_synthesizers": {
       value: {},
     },
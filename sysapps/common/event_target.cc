@@ -4,6 +4,10 @@
 
 #include "xwalk/sysapps/common/event_target.h"
 
+#include <algorithm>
+
+#include "base/location.h"
+#include "base/thread_task_runner_handle.h"
 #include "xwalk/sysapps/common/common.h"
 
 using namespace xwalk::jsapi::common; // NOLINT
@@ -11,7 +15,13 @@ using namespace xwalk::jsapi::common; // NOLINT
 namespace xwalk {
 namespace sysapps {
 
-EventTarget::EventTarget() {
+EventTarget::DispatchState::DispatchState()
+    : policy(DISPATCH_IMMEDIATELY) {}
+
+EventTarget::DispatchState::~DispatchState() {}
+
+EventTarget::EventTarget()
+    : weak_factory_(this) {
   handler_.Register("addEventListener",
       base::Bind(&EventTarget::OnAddEventListener, base::Unretained(this)));
   handler_.Register("removeEventListener",
@@ -26,17 +36,51 @@ void EventTarget::DispatchEvent(const std::string& type) {
 
 void EventTarget::DispatchEvent(const std::string& type,
                                 scoped_ptr<base::ListValue> data) {
-  EventMap::iterator it = events_.find(type);
-  if (it == events_.end())
+  if (!IsEventActive(type))
     return;
 
-  it->second.Run(data.Pass());
+  DispatchStateMap::iterator it = dispatch_states_.find(type);
+  if (it == dispatch_states_.end() ||
+      it->second->policy == DISPATCH_IMMEDIATELY) {
+    FlushPendingEvents();
+    SendEvent(type, data.Pass());
+    return;
+  }
+
+  DispatchState* state = it->second.get();
+  if (!state->pending) {
+    pending_types_.push_back(type);
+    if (state->policy == DISPATCH_QUEUED)
+      state->pending.reset(new base::ListValue);
+  }
+
+  if (state->policy == DISPATCH_QUEUED)
+    state->pending->Append(data.release());
+  else
+    state->pending = data.Pass();
+
+  ScheduleFlush(state->last_sent + state->interval);
 }
 
 bool EventTarget::IsEventActive(const std::string& type) const {
   return events_.find(type) != events_.end();
 }
 
+void EventTarget::SetDispatchPolicy(const std::string& type,
+                                    DispatchPolicy policy,
+                                    base::TimeDelta interval) {
+  linked_ptr<DispatchState>& state = dispatch_states_[type];
+  if (!state.get())
+    state.reset(new DispatchState);
+
+  // Events pending with the previous policy are sent before switching.
+  if (state->pending)
+    FlushPendingEvents();
+
+  state->policy = policy;
+  state->interval = interval;
+}
+
 void EventTarget::OnAddEventListener(
     scoped_ptr<XWalkExtensionFunctionInfo> info) {
   scoped_ptr<AddEventListener::Params>
@@ -47,15 +91,22 @@ void EventTarget::OnAddEventListener(
     return;
   }
 
-  if (events_.find(params->type) != events_.end()) {
+  const std::string listener_id =
+      params->listener_id ? *params->listener_id : std::string();
+
+  EventMap::iterator it = events_.find(params->type);
+  if (it != events_.end() && it->second.count(listener_id)) {
     LOG(WARNING) << "Trying to re-add the event '" << params->type << "'. "
         "This should be optized in the JavaScript side so this message is sent "
         "only once.";
     return;
   }
 
-  events_[params->type] = info->post_result_cb();
-  StartEvent(params->type);
+  const bool is_first_listener = it == events_.end();
+  events_[params->type][listener_id] = info->post_result_cb();
+
+  if (is_first_listener)
+    StartEvent(params->type);
 }
 
 void EventTarget::OnRemoveEventListener(
@@ -68,16 +119,106 @@ void EventTarget::OnRemoveEventListener(
     return;
   }
 
+  const std::string listener_id =
+      params->listener_id ? *params->listener_id : std::string();
+
   EventMap::iterator it = events_.find(params->type);
-  if (it == events_.end()) {
+  if (it == events_.end() || !it->second.erase(listener_id)) {
     LOG(WARNING) << "Attempt to remove the event '" << params->type << "' but "
         "this event was not previously added.";
     return;
   }
 
+  if (!it->second.empty())
+    return;
+
   events_.erase(it);
   StopEvent(params->type);
 }
 
+void EventTarget::SendEvent(const std::string& type,
+                            scoped_ptr<base::ListValue> data) {
+  EventMap::iterator it = events_.find(type);
+  if (it == events_.end())
+    return;
+
+  // The last listener takes the data, the others get a copy.
+  ListenerMap& listeners = it->second;
+  ListenerMap::iterator last = --listeners.end();
+  for (ListenerMap::iterator listener = listeners.begin();
+       listener != last; ++listener)
+    listener->second.Run(make_scoped_ptr(data->DeepCopy()));
+
+  last->second.Run(data.Pass());
+}
+
+void EventTarget::SendPendingEvent(const std::string& type,
+                                   DispatchState* state) {
+  state->last_sent = base::TimeTicks::Now();
+
+  if (state->policy == DISPATCH_LATEST) {
+    SendEvent(type, state->pending.Pass());
+    return;
+  }
+
+  // Queued events are sent as a list of the data of each event, flagged so
+  // the JavaScript side can dispatch them one by one.
+  scoped_ptr<base::ListValue> data(new base::ListValue);
+  data->Append(state->pending.release());
+  data->AppendBoolean(true);
+  SendEvent(type, data.Pass());
+}
+
+void EventTarget::FlushPendingEvents() {
+  std::vector<std::string> pending_types;
+  pending_types.swap(pending_types_);
+
+  for (size_t i = 0; i < pending_types.size(); ++i) {
+    DispatchState* state = dispatch_states_[pending_types[i]].get();
+    if (state->pending)
+      SendPendingEvent(pending_types[i], state);
+  }
+}
+
+void EventTarget::FlushDueEvents() {
+  next_flush_ = base::TimeTicks();
+
+  const base::TimeTicks now = base::TimeTicks::Now();
+  base::TimeTicks next_flush;
+
+  std::vector<std::string> pending_types;
+  pending_types.swap(pending_types_);
+
+  for (size_t i = 0; i < pending_types.size(); ++i) {
+    DispatchState* state = dispatch_states_[pending_types[i]].get();
+    if (!state->pending)
+      continue;
+
+    const base::TimeTicks due = state->last_sent + state->interval;
+    if (due <= now) {
+      SendPendingEvent(pending_types[i], state);
+      continue;
+    }
+
+    pending_types_.push_back(pending_types[i]);
+    if (next_flush.is_null() || due < next_flush)
+      next_flush = due;
+  }
+
+  if (!next_flush.is_null())
+    ScheduleFlush(next_flush);
+}
+
+void EventTarget::ScheduleFlush(base::TimeTicks time) {
+  if (!next_flush_.is_null() && next_flush_ <= time)
+    return;
+
+  next_flush_ = time;
+  base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE,
+      base::Bind(&EventTarget::FlushDueEvents, weak_factory_.GetWeakPtr()),
+      std::max(base::TimeDelta(), time - base::TimeTicks::Now()));
+}
+
 }  // namespace sysapps
 }  // namespace xwalk
@@ -7,6 +7,11 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+#include "base/memory/linked_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "xwalk/sysapps/common/binding_object.h"
 
 namespace xwalk {
@@ -19,6 +24,18 @@ using extensions::XWalkExtensionFunctionInfo;
 // It has convenience methods and signals to make dispatching of events simple.
 class EventTarget : public BindingObject {
  public:
+  // How the events of a given type are sent to the JavaScript side.
+  enum DispatchPolicy {
+    // Every event is sent as soon as it is dispatched. This is the default.
+    DISPATCH_IMMEDIATELY,
+    // Only the latest event is sent, for state events where the intermediate
+    // values are not relevant.
+    DISPATCH_LATEST,
+    // All the events are queued and sent together in a single message, for
+    // data events where nothing can be dropped.
+    DISPATCH_QUEUED,
+  };
+
   EventTarget();
   virtual ~EventTarget();
 
@@ -37,16 +54,57 @@ class EventTarget : public BindingObject {
   void DispatchEvent(const std::string& type);
   void DispatchEvent(const std::string& type, scoped_ptr<base::ListValue> data);
 
+  // Returns false when nobody is listening to |type| in the JavaScript side,
+  // in which case building the data of the event can be skipped.
   bool IsEventActive(const std::string& type) const;
 
+  // Coalesces the events of |type| according to |policy|. They are sent on
+  // the next iteration of the message loop, but no sooner than |interval|
+  // after the previous message, and always before an event of another type
+  // sent immediately so the ordering is kept.
+  void SetDispatchPolicy(const std::string& type,
+                         DispatchPolicy policy,
+                         base::TimeDelta interval);
+
  private:
+  struct DispatchState {
+    DispatchState();
+    ~DispatchState();
+
+    DispatchPolicy policy;
+    base::TimeDelta interval;
+    base::TimeTicks last_sent;
+
+    // The latest event for DISPATCH_LATEST, or the list of the queued events
+    // for DISPATCH_QUEUED. NULL if nothing is pending.
+    scoped_ptr<base::ListValue> pending;
+  };
+
   void OnAddEventListener(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnRemoveEventListener(scoped_ptr<XWalkExtensionFunctionInfo> info);
 
+  void SendEvent(const std::string& type, scoped_ptr<base::ListValue> data);
+  void SendPendingEvent(const std::string& type, DispatchState* state);
+  void FlushPendingEvents();
+  void FlushDueEvents();
+  void ScheduleFlush(base::TimeTicks time);
+
+  // Several JavaScript objects sharing the same native object can listen to
+  // the same event, each one of them registering with its own id.
   typedef std::map<std::string,
-      XWalkExtensionFunctionInfo::PostResultCallback> EventMap;
+      XWalkExtensionFunctionInfo::PostResultCallback> ListenerMap;
+  typedef std::map<std::string, ListenerMap> EventMap;
+
+  typedef std::map<std::string, linked_ptr<DispatchState> > DispatchStateMap;
 
   EventMap events_;
+  DispatchStateMap dispatch_states_;
+
+  // Types with pending events, in the order they were first dispatched.
+  std::vector<std::string> pending_types_;
+  base::TimeTicks next_flush_;
+
+  base::WeakPtrFactory<EventTarget> weak_factory_;
 };
 
 }  // namespace sysapps
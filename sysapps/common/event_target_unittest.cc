@@ -4,6 +4,11 @@
 
 #include "xwalk/sysapps/common/event_target.h"
 
+#include <string>
+#include <vector>
+
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "xwalk/extensions/browser/xwalk_extension_function_handler.h"
 
@@ -28,6 +33,41 @@ scoped_ptr<XWalkExtensionFunctionInfo> CreateFunctionInfo(
       base::Bind(&DummyCallback)));
 }
 
+scoped_ptr<XWalkExtensionFunctionInfo> CreateListenerInfo(
+    const std::string& name,
+    const std::string& type,
+    const std::string& listener_id,
+    const XWalkExtensionFunctionInfo::PostResultCallback& callback) {
+  scoped_ptr<base::ListValue> arguments(new base::ListValue);
+  arguments->AppendString(type);
+  arguments->AppendString(listener_id);
+
+  return make_scoped_ptr(new XWalkExtensionFunctionInfo(
+      name, arguments.Pass(), callback));
+}
+
+void StoreResult(std::vector<int>* results,
+                 scoped_ptr<base::ListValue> result) {
+  // Queued events are received as a list of the data of each event.
+  bool is_queued = false;
+  base::ListValue* events;
+  if (result->GetBoolean(1, &is_queued) && is_queued &&
+      result->GetList(0, &events)) {
+    for (size_t i = 0; i < events->GetSize(); ++i) {
+      base::ListValue* event;
+      int value;
+      if (events->GetList(i, &event) && event->GetInteger(0, &value))
+        results->push_back(value);
+    }
+    results->push_back(-1);
+    return;
+  }
+
+  int value;
+  if (result->GetInteger(0, &value))
+    results->push_back(value);
+}
+
 void DispatchResult(int* message_count, scoped_ptr<base::ListValue> result) {
   std::string test_string;
   result->GetString(0, &test_string);
@@ -49,6 +89,17 @@ class EventTargetTest : public EventTarget {
     DispatchEvent(type, data.Pass());
   }
 
+  void InjectValue(const std::string& type, int value) {
+    scoped_ptr<base::ListValue> data(new base::ListValue());
+    data->AppendInteger(value);
+
+    DispatchEvent(type, data.Pass());
+  }
+
+  void SetPolicy(const std::string& type, DispatchPolicy policy) {
+    SetDispatchPolicy(type, policy, base::TimeDelta());
+  }
+
   bool is_event1_active() const {
     return event1_count_ == 1;
   }
@@ -162,3 +213,96 @@ TEST(XWalkSysAppsEventTargetTest, DispatchEvent) {
     EXPECT_EQ(message_count, i + 1);
   }
 }
+
+TEST(XWalkSysAppsEventTargetTest, ListenerFanOut) {
+  scoped_ptr<EventTargetTest> target(new EventTargetTest());
+
+  // JavaScript objects sharing the same native object register their
+  // listeners separately and all of them get the events.
+  std::vector<int> results1;
+  std::vector<int> results2;
+  EXPECT_TRUE(target->HandleFunction(CreateListenerInfo(
+      "addEventListener", "event1", "1", base::Bind(&StoreResult, &results1))));
+  EXPECT_TRUE(target->HandleFunction(CreateListenerInfo(
+      "addEventListener", "event1", "2", base::Bind(&StoreResult, &results2))));
+  EXPECT_TRUE(target->is_event1_active());
+
+  target->InjectValue("event1", 42);
+  ASSERT_EQ(1u, results1.size());
+  ASSERT_EQ(1u, results2.size());
+  EXPECT_EQ(42, results1[0]);
+  EXPECT_EQ(42, results2[0]);
+
+  // The event is only stopped when the last listener is removed.
+  EXPECT_TRUE(target->HandleFunction(CreateListenerInfo(
+      "removeEventListener", "event1", "1", base::Bind(&DummyCallback))));
+  EXPECT_TRUE(target->is_event1_active());
+
+  target->InjectValue("event1", 43);
+  EXPECT_EQ(1u, results1.size());
+  ASSERT_EQ(2u, results2.size());
+  EXPECT_EQ(43, results2[1]);
+
+  EXPECT_TRUE(target->HandleFunction(CreateListenerInfo(
+      "removeEventListener", "event1", "2", base::Bind(&DummyCallback))));
+  EXPECT_FALSE(target->is_event1_active());
+}
+
+TEST(XWalkSysAppsEventTargetTest, DispatchPolicy) {
+  base::MessageLoop message_loop;
+  scoped_ptr<EventTargetTest> target(new EventTargetTest());
+  target->SetPolicy("event1", EventTarget::DISPATCH_LATEST);
+  target->SetPolicy("event2", EventTarget::DISPATCH_QUEUED);
+
+  std::vector<int> results;
+  EXPECT_TRUE(target->HandleFunction(CreateListenerInfo(
+      "addEventListener", "event1", "1", base::Bind(&StoreResult, &results))));
+  EXPECT_TRUE(target->HandleFunction(CreateListenerInfo(
+      "addEventListener", "event2", "1", base::Bind(&StoreResult, &results))));
+  EXPECT_TRUE(target->HandleFunction(CreateListenerInfo(
+      "addEventListener", "event3", "1", base::Bind(&StoreResult, &results))));
+
+  // Only the latest value of a state event is sent.
+  target->InjectValue("event1", 1);
+  target->InjectValue("event1", 2);
+  target->InjectValue("event1", 3);
+  EXPECT_TRUE(results.empty());
+  base::RunLoop().RunUntilIdle();
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(3, results[0]);
+
+  // Data events are sent together in a single message.
+  results.clear();
+  target->InjectValue("event2", 1);
+  target->InjectValue("event2", 2);
+  target->InjectValue("event2", 3);
+  EXPECT_TRUE(results.empty());
+  base::RunLoop().RunUntilIdle();
+  ASSERT_EQ(4u, results.size());
+  EXPECT_EQ(1, results[0]);
+  EXPECT_EQ(2, results[1]);
+  EXPECT_EQ(3, results[2]);
+  EXPECT_EQ(-1, results[3]);
+
+  // Pending events are sent before an event dispatched immediately, so the
+  // ordering is kept.
+  results.clear();
+  target->InjectValue("event2", 1);
+  target->InjectValue("event1", 2);
+  target->InjectValue("event3", 3);
+  ASSERT_EQ(4u, results.size());
+  EXPECT_EQ(1, results[0]);
+  EXPECT_EQ(-1, results[1]);
+  EXPECT_EQ(2, results[2]);
+  EXPECT_EQ(3, results[3]);
+
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(4u, results.size());
+
+  // Nothing is queued when nobody is listening.
+  EXPECT_TRUE(target->HandleFunction(CreateListenerInfo(
+      "removeEventListener", "event2", "1", base::Bind(&DummyCallback))));
+  target->InjectValue("event2", 1);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(4u, results.size());
+}
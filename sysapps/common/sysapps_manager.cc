@@ -5,15 +5,24 @@
 #include "xwalk/sysapps/common/sysapps_manager.h"
 
 #include "base/basictypes.h"
+#include "xwalk/sysapps/device_capabilities/av_codecs_provider.h"
 #include "xwalk/sysapps/device_capabilities/cpu_info_provider.h"
 #include "xwalk/sysapps/device_capabilities/device_capabilities_extension.h"
 #include "xwalk/sysapps/device_capabilities/display_info_provider.h"
 #include "xwalk/sysapps/device_capabilities/memory_info_provider.h"
+#include "xwalk/sysapps/device_capabilities/storage_capacity_monitor.h"
+#include "xwalk/sysapps/device_capabilities/system_sampler.h"
 #include "xwalk/sysapps/raw_socket/raw_socket_extension.h"
 
 namespace xwalk {
 namespace sysapps {
 
+namespace {
+
+const int kStorageSamplingIntervalSec = 5;
+
+}  // namespace
+
 SysAppsManager::SysAppsManager()
     : device_capabilities_enabled_(true),
       raw_sockets_enabled_(true) {}
@@ -34,8 +43,10 @@ void SysAppsManager::CreateExtensionsForUIThread(
   // it uses Chromium's StorageMonitor, which requires that. We can move it back
   // to the ExtensionThread if we make StorageMonitor a truly self-contained
   // module on Chromium upstream.
-  if (device_capabilities_enabled_)
+  if (device_capabilities_enabled_) {
     extensions->push_back(new experimental::DeviceCapabilitiesExtension());
+    GetAVCodecsProvider()->StartProbing();
+  }
 }
 
 void SysAppsManager::CreateExtensionsForExtensionThread(
@@ -65,5 +76,21 @@ MemoryInfoProvider* SysAppsManager::GetMemoryInfoProvider() {
   return &provider;
 }
 
+// static
+StorageCapacityMonitor* SysAppsManager::GetStorageCapacityMonitor() {
+  CR_DEFINE_STATIC_LOCAL(StorageCapacityMonitor, monitor,
+      (GetStorageInfoProvider(),
+       base::TimeDelta::FromSeconds(kStorageSamplingIntervalSec)));
+
+  return &monitor;
+}
+
+// static
+SystemSampler* SysAppsManager::GetSystemSampler() {
+  CR_DEFINE_STATIC_LOCAL(SystemSampler, sampler, ());
+
+  return &sampler;
+}
+
 }  // namespace sysapps
 }  // namespace xwalk
@@ -16,7 +16,9 @@ class AVCodecsProvider;
 class CPUInfoProvider;
 class DisplayInfoProvider;
 class MemoryInfoProvider;
+class StorageCapacityMonitor;
 class StorageInfoProvider;
+class SystemSampler;
 
 // This class manages the registration of the SysApps APIs. It will append
 // to the list of extensions the SysApps APIs, taking the features flags into
@@ -38,6 +40,8 @@ class SysAppsManager {
   static DisplayInfoProvider* GetDisplayInfoProvider();
   static MemoryInfoProvider* GetMemoryInfoProvider();
   static StorageInfoProvider* GetStorageInfoProvider();
+  static StorageCapacityMonitor* GetStorageCapacityMonitor();
+  static SystemSampler* GetSystemSampler();
 
  private:
   bool device_capabilities_enabled_;
@@ -0,0 +1,64 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/sysapps/device_capabilities/av_codecs_provider.h"
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/threading/worker_pool.h"
+#include "base/values.h"
+
+namespace xwalk {
+namespace sysapps {
+
+using jsapi::device_capabilities::GetAVCodecs::Results::Create;
+
+AVCodecsProvider::AVCodecsProvider()
+    : probing_started_(false) {}
+
+AVCodecsProvider::~AVCodecsProvider() {}
+
+void AVCodecsProvider::StartProbing() {
+  {
+    base::AutoLock lock(lock_);
+    if (probing_started_ || codecs_)
+      return;
+    probing_started_ = true;
+  }
+
+  // The providers are never destroyed, see SysAppsManager.
+  base::WorkerPool::PostTask(
+      FROM_HERE,
+      base::Bind(&AVCodecsProvider::EnsureProbed, base::Unretained(this)),
+      false);
+}
+
+scoped_ptr<SystemAVCodecs> AVCodecsProvider::GetSupportedCodecs() const {
+  EnsureProbed();
+
+  scoped_ptr<SystemAVCodecs> codecs(new SystemAVCodecs);
+  SystemAVCodecs::Populate(*codecs_->ToValue(), codecs.get());
+  return codecs.Pass();
+}
+
+scoped_ptr<base::ListValue> AVCodecsProvider::GetSupportedCodecsResults()
+    const {
+  EnsureProbed();
+  return make_scoped_ptr(results_->DeepCopy());
+}
+
+void AVCodecsProvider::EnsureProbed() const {
+  base::AutoLock lock(lock_);
+  if (codecs_)
+    return;
+
+  scoped_ptr<SystemAVCodecs> codecs(ProbeSupportedCodecs());
+  results_.reset(Create(*codecs, std::string()).release());
+  codecs_.reset(codecs.release());
+}
+
+}  // namespace sysapps
+}  // namespace xwalk
@@ -6,8 +6,13 @@
 #define XWALK_SYSAPPS_DEVICE_CAPABILITIES_AV_CODECS_PROVIDER_H_
 
 #include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
 #include "xwalk/sysapps/device_capabilities/device_capabilities.h"
 
+namespace base {
+class ListValue;
+}
+
 namespace xwalk {
 namespace sysapps {
 
@@ -15,14 +20,39 @@ using jsapi::device_capabilities::AudioCodec;
 using jsapi::device_capabilities::VideoCodec;
 using jsapi::device_capabilities::SystemAVCodecs;
 
+// The supported codecs don't change while running, so they are probed only
+// once, and kept in a snapshot shared by all the extension instances of all
+// the render processes.
 class AVCodecsProvider {
  public:
-  AVCodecsProvider() {}
-  virtual ~AVCodecsProvider() {}
+  AVCodecsProvider();
+  virtual ~AVCodecsProvider();
+
+  // Probes the codecs on a worker thread, so they are usually ready by the
+  // time they are first requested. Does nothing if already started.
+  void StartProbing();
+
+  scoped_ptr<SystemAVCodecs> GetSupportedCodecs() const;
 
-  virtual scoped_ptr<SystemAVCodecs> GetSupportedCodecs() const = 0;
+  // Returns the results of getAVCodecs(), copied from the snapshot instead
+  // of being serialized again for every request.
+  scoped_ptr<base::ListValue> GetSupportedCodecsResults() const;
+
+ protected:
+  // Enumerates the codecs, called once on any thread.
+  virtual scoped_ptr<SystemAVCodecs> ProbeSupportedCodecs() const = 0;
 
  private:
+  // Probes the codecs if not done yet, waiting for the probe in progress on
+  // the worker thread if there is one.
+  void EnsureProbed() const;
+
+  // Guards the members below, which are not modified once probed.
+  mutable base::Lock lock_;
+  bool probing_started_;
+  mutable scoped_ptr<const SystemAVCodecs> codecs_;
+  mutable scoped_ptr<const base::ListValue> results_;
+
   DISALLOW_COPY_AND_ASSIGN(AVCodecsProvider);
 };
 
@@ -11,7 +11,8 @@ AVCodecsProviderAndroid::AVCodecsProviderAndroid() {}
 
 AVCodecsProviderAndroid::~AVCodecsProviderAndroid() {}
 
-scoped_ptr<SystemAVCodecs> AVCodecsProviderAndroid::GetSupportedCodecs() const {
+scoped_ptr<SystemAVCodecs>
+AVCodecsProviderAndroid::ProbeSupportedCodecs() const {
   NOTIMPLEMENTED();
   return make_scoped_ptr(new SystemAVCodecs);
 }
@@ -15,9 +15,10 @@ class AVCodecsProviderAndroid : public AVCodecsProvider {
   AVCodecsProviderAndroid();
   virtual ~AVCodecsProviderAndroid();
 
-  scoped_ptr<SystemAVCodecs> GetSupportedCodecs() const override;
-
  private:
+  // AVCodecsProvider implementation.
+  scoped_ptr<SystemAVCodecs> ProbeSupportedCodecs() const override;
+
   DISALLOW_COPY_AND_ASSIGN(AVCodecsProviderAndroid);
 };
 
@@ -27,7 +27,8 @@ AVCodecsProviderFFmpeg::AVCodecsProviderFFmpeg() {
 
 AVCodecsProviderFFmpeg::~AVCodecsProviderFFmpeg() {}
 
-scoped_ptr<SystemAVCodecs> AVCodecsProviderFFmpeg::GetSupportedCodecs() const {
+scoped_ptr<SystemAVCodecs>
+AVCodecsProviderFFmpeg::ProbeSupportedCodecs() const {
   scoped_ptr<SystemAVCodecs> av_codecs(new SystemAVCodecs);
 
   // Get a list of supported codecs.
@@ -16,9 +16,10 @@ class AVCodecsProviderFFmpeg : public AVCodecsProvider {
   AVCodecsProviderFFmpeg();
   virtual ~AVCodecsProviderFFmpeg();
 
-  scoped_ptr<SystemAVCodecs> GetSupportedCodecs() const override;
-
  private:
+  // AVCodecsProvider implementation.
+  scoped_ptr<SystemAVCodecs> ProbeSupportedCodecs() const override;
+
   DISALLOW_COPY_AND_ASSIGN(AVCodecsProviderFFmpeg);
 };
 
@@ -5,8 +5,12 @@
 
 #include "xwalk/sysapps/device_capabilities/av_codecs_provider.h"
 
+#include <string>
 #include <vector>
 
+#include "base/debug/leak_annotations.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/values.h"
 #include "media/base/media.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "xwalk/sysapps/common/sysapps_manager.h"
@@ -17,6 +21,41 @@ using xwalk::jsapi::device_capabilities::VideoCodec;
 using xwalk::jsapi::device_capabilities::SystemAVCodecs;
 using xwalk::sysapps::AVCodecsProvider;
 
+namespace {
+
+// Provider whose probe blocks until released, counting the probes.
+class FakeAVCodecsProvider : public AVCodecsProvider {
+ public:
+  FakeAVCodecsProvider()
+      : probes_(0),
+        release_probe_(true, false) {}
+
+  int probes() const { return probes_; }
+  void ReleaseProbe() { release_probe_.Signal(); }
+
+ private:
+  scoped_ptr<SystemAVCodecs> ProbeSupportedCodecs() const override {
+    release_probe_.Wait();
+    probes_++;
+
+    scoped_ptr<SystemAVCodecs> codecs(new SystemAVCodecs);
+    linked_ptr<AudioCodec> audio_codec(new AudioCodec);
+    audio_codec->format = "vorbis";
+    codecs->audio_codecs.push_back(audio_codec);
+    linked_ptr<VideoCodec> video_codec(new VideoCodec);
+    video_codec->format = "vp8";
+    video_codec->hw_accel = false;
+    video_codec->encode = true;
+    codecs->video_codecs.push_back(video_codec);
+    return codecs.Pass();
+  }
+
+  mutable int probes_;
+  mutable base::WaitableEvent release_probe_;
+};
+
+}  // namespace
+
 TEST(XWalkSysAppsDeviceCapabilitiesTest, AVCodecsProvider) {
   media::InitializeMediaLibraryForTesting();
   xwalk::sysapps::SysAppsManager manager;
@@ -33,3 +72,43 @@ TEST(XWalkSysAppsDeviceCapabilitiesTest, AVCodecsProvider) {
   for (size_t i = 0; i < video_codecs.size(); ++i)
     EXPECT_FALSE(video_codecs[i]->format.empty());
 }
+
+TEST(XWalkSysAppsDeviceCapabilitiesTest, AVCodecsSnapshot) {
+  // Leaked like the providers of SysAppsManager, since the probe task can
+  // run after the test.
+  FakeAVCodecsProvider* provider = new FakeAVCodecsProvider;
+  ANNOTATE_LEAKING_OBJECT_PTR(provider);
+
+  // Requests made while the background probe is in progress wait for it
+  // instead of probing again.
+  provider->StartProbing();
+  provider->StartProbing();
+  provider->ReleaseProbe();
+
+  scoped_ptr<SystemAVCodecs> codecs(provider->GetSupportedCodecs());
+  scoped_ptr<base::ListValue> results(provider->GetSupportedCodecsResults());
+  EXPECT_EQ(1, provider->probes());
+
+  ASSERT_EQ(1u, codecs->audio_codecs.size());
+  EXPECT_EQ("vorbis", codecs->audio_codecs[0]->format);
+  ASSERT_EQ(1u, codecs->video_codecs.size());
+  EXPECT_EQ("vp8", codecs->video_codecs[0]->format);
+  EXPECT_TRUE(codecs->video_codecs[0]->encode);
+
+  // The results are the arguments of the getAVCodecs() callback, the codecs
+  // followed by an empty error.
+  base::DictionaryValue* codecs_value;
+  std::string error;
+  ASSERT_EQ(2u, results->GetSize());
+  ASSERT_TRUE(results->GetDictionary(0, &codecs_value));
+  EXPECT_TRUE(codecs_value->Equals(codecs->ToValue().get()));
+  EXPECT_TRUE(results->GetString(1, &error));
+  EXPECT_TRUE(error.empty());
+
+  // Each request gets its own copy of the snapshot.
+  scoped_ptr<base::ListValue> other_results(
+      provider->GetSupportedCodecsResults());
+  EXPECT_NE(results.get(), other_results.get());
+  EXPECT_TRUE(results->Equals(other_results.get()));
+  EXPECT_EQ(1, provider->probes());
+}
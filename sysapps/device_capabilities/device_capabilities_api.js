@@ -24,12 +24,19 @@ var DeviceCapabilities = function() {
   this._addEvent("displaydisconnect");
   this._addEvent("storageattach");
   this._addEvent("storagedetach");
+  this._addEvent("cpuload");
+  this._addEvent("memorypressure");
+  this._addEvent("storagepressure");
 
   this._addMethodWithPromise("getAVCodecs", Promise);
   this._addMethodWithPromise("getCPUInfo", Promise);
   this._addMethodWithPromise("getDisplayInfo", Promise);
   this._addMethodWithPromise("getMemoryInfo", Promise);
   this._addMethodWithPromise("getStorageInfo", Promise);
+  this._addMethodWithPromise("getLoadHistory", Promise);
+
+  this._addMethod("setSamplingInterval");
+  this._addMethod("setStorageQuota");
 };
 
 DeviceCapabilities.prototype = new common.EventTargetPrototype();
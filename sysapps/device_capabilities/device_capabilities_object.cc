@@ -5,20 +5,68 @@
 #include "xwalk/sysapps/device_capabilities/device_capabilities_object.h"
 
 #include <string>
+#include <vector>
 
+#include "base/logging.h"
 #include "xwalk/sysapps/common/sysapps_manager.h"
 #include "xwalk/sysapps/device_capabilities/av_codecs_provider.h"
 #include "xwalk/sysapps/device_capabilities/cpu_info_provider.h"
 #include "xwalk/sysapps/device_capabilities/display_info_provider.h"
 #include "xwalk/sysapps/device_capabilities/memory_info_provider.h"
+#include "xwalk/sysapps/device_capabilities/storage_capacity_monitor.h"
 #include "xwalk/sysapps/device_capabilities/storage_info_provider.h"
+#include "xwalk/sysapps/device_capabilities/system_sampler.h"
 
 namespace xwalk {
 namespace sysapps {
 
 using namespace jsapi::device_capabilities; // NOLINT
 
-DeviceCapabilitiesObject::DeviceCapabilitiesObject() {
+namespace {
+
+const int kDefaultSamplingIntervalMs = 1000;
+
+// Thresholds of available memory, relative to the capacity, for the memory
+// pressure levels.
+const double kModerateMemoryPressure = 0.15;
+const double kCriticalMemoryPressure = 0.05;
+
+linked_ptr<SystemLoad> MakeSystemLoad(const SystemSampler::Sample& sample) {
+  linked_ptr<SystemLoad> load(new SystemLoad);
+  load->timestamp = sample.timestamp;
+  load->load = sample.cpu_load;
+  load->core_loads = sample.core_loads;
+  load->memory_capacity = sample.memory_capacity;
+  load->memory_avail_capacity = sample.memory_avail_capacity;
+
+  return load;
+}
+
+MemoryPressureLevel GetMemoryPressureLevel(
+    const SystemSampler::Sample& sample) {
+  if (sample.memory_capacity <= 0)
+    return MEMORY_PRESSURE_LEVEL_NONE;
+
+  const double available =
+      sample.memory_avail_capacity / sample.memory_capacity;
+  if (available < kCriticalMemoryPressure)
+    return MEMORY_PRESSURE_LEVEL_CRITICAL;
+  if (available < kModerateMemoryPressure)
+    return MEMORY_PRESSURE_LEVEL_MODERATE;
+  return MEMORY_PRESSURE_LEVEL_NONE;
+}
+
+}  // namespace
+
+DeviceCapabilitiesObject::DeviceCapabilitiesObject()
+    : sampling_interval_(
+          base::TimeDelta::FromMilliseconds(kDefaultSamplingIntervalMs)),
+      memory_pressure_level_(MEMORY_PRESSURE_LEVEL_NONE),
+      storage_quota_(0) {
+  // The sampler is shared and runs at the shortest interval requested, so the
+  // load is rate limited to the interval requested by this object.
+  SetDispatchPolicy("cpuload", DISPATCH_LATEST, sampling_interval_);
+
   handler_.Register("getAVCodecs",
                     base::Bind(&DeviceCapabilitiesObject::OnGetAVCodecs,
                                base::Unretained(this)));
@@ -34,9 +82,24 @@ DeviceCapabilitiesObject::DeviceCapabilitiesObject() {
   handler_.Register("getStorageInfo",
                     base::Bind(&DeviceCapabilitiesObject::OnGetStorageInfo,
                                base::Unretained(this)));
+  handler_.Register("getLoadHistory",
+                    base::Bind(&DeviceCapabilitiesObject::OnGetLoadHistory,
+                               base::Unretained(this)));
+  handler_.Register("setSamplingInterval",
+                    base::Bind(&DeviceCapabilitiesObject::OnSetSamplingInterval,
+                               base::Unretained(this)));
+  handler_.Register("setStorageQuota",
+                    base::Bind(&DeviceCapabilitiesObject::OnSetStorageQuota,
+                               base::Unretained(this)));
 }
 
 DeviceCapabilitiesObject::~DeviceCapabilitiesObject() {
+  if (SysAppsManager::GetSystemSampler()->HasObserver(this))
+    SysAppsManager::GetSystemSampler()->RemoveObserver(this);
+
+  if (SysAppsManager::GetStorageCapacityMonitor()->HasObserver(this))
+    SysAppsManager::GetStorageCapacityMonitor()->RemoveObserver(this);
+
   if (SysAppsManager::GetStorageInfoProvider()->HasObserver(this))
     SysAppsManager::GetStorageInfoProvider()->RemoveObserver(this);
 
@@ -48,9 +111,17 @@ void DeviceCapabilitiesObject::StartEvent(const std::string& type) {
   if (type == "storageattach" || type == "storagedetach") {
     if (!SysAppsManager::GetStorageInfoProvider()->HasObserver(this))
       SysAppsManager::GetStorageInfoProvider()->AddObserver(this);
+  } else if (type == "storagepressure") {
+    SysAppsManager::GetStorageCapacityMonitor()->AddObserver(this,
+                                                             storage_quota_);
   } else if (type == "displayconnect" || type == "displaydisconnect") {
     if (!SysAppsManager::GetDisplayInfoProvider()->HasObserver(this))
       SysAppsManager::GetDisplayInfoProvider()->AddObserver(this);
+  } else if (type == "cpuload" || type == "memorypressure") {
+    if (!SysAppsManager::GetSystemSampler()->HasObserver(this)) {
+      SysAppsManager::GetSystemSampler()->AddObserver(this,
+                                                      sampling_interval_);
+    }
   }
 }
 
@@ -58,9 +129,17 @@ void DeviceCapabilitiesObject::StopEvent(const std::string& type) {
   if (type == "storageattach" || type == "storagedetach") {
     if (!IsEventActive("storageattach") && !IsEventActive("storagedetach"))
       SysAppsManager::GetStorageInfoProvider()->RemoveObserver(this);
+  } else if (type == "storagepressure") {
+    SysAppsManager::GetStorageCapacityMonitor()->RemoveObserver(this);
   } else if (type == "displayconnect" || type == "displaydisconnect") {
     if (!IsEventActive("displayconnect") && !IsEventActive("displaydisconnect"))
       SysAppsManager::GetDisplayInfoProvider()->RemoveObserver(this);
+  } else if (type == "cpuload" || type == "memorypressure") {
+    // A new listener is told about the current level if it is not "none".
+    if (type == "memorypressure")
+      memory_pressure_level_ = MEMORY_PRESSURE_LEVEL_NONE;
+    if (!IsEventActive("cpuload") && !IsEventActive("memorypressure"))
+      SysAppsManager::GetSystemSampler()->RemoveObserver(this);
   }
 }
 
@@ -79,6 +158,14 @@ void DeviceCapabilitiesObject::OnDisplayDisconnected(
   DispatchEvent("displaydisconnect", eventData.Pass());
 }
 
+void DeviceCapabilitiesObject::OnStoragePressureChanged(
+    const StoragePressure& pressure) {
+  scoped_ptr<base::ListValue> eventData(new base::ListValue);
+  eventData->Append(pressure.ToValue().release());
+
+  DispatchEvent("storagepressure", eventData.Pass());
+}
+
 void DeviceCapabilitiesObject::OnStorageAttached(const StorageUnit& storage) {
   scoped_ptr<base::ListValue> eventData(new base::ListValue);
   eventData->Append(storage.ToValue().release());
@@ -93,17 +180,53 @@ void DeviceCapabilitiesObject::OnStorageDetached(const StorageUnit& storage) {
   DispatchEvent("storagedetach", eventData.Pass());
 }
 
+void DeviceCapabilitiesObject::OnSystemSampled(
+    const SystemSampler::Sample& sample) {
+  if (IsEventActive("cpuload")) {
+    scoped_ptr<base::ListValue> eventData(new base::ListValue);
+    eventData->Append(MakeSystemLoad(sample)->ToValue().release());
+
+    DispatchEvent("cpuload", eventData.Pass());
+  }
+
+  // The memory pressure is only tracked while it is listened to, and only
+  // reported when its level changes.
+  if (!IsEventActive("memorypressure"))
+    return;
+
+  MemoryPressureLevel level = GetMemoryPressureLevel(sample);
+  if (level == memory_pressure_level_)
+    return;
+
+  memory_pressure_level_ = level;
+
+  MemoryPressure pressure;
+  pressure.level = level;
+  pressure.capacity = sample.memory_capacity;
+  pressure.avail_capacity = sample.memory_avail_capacity;
+
+  scoped_ptr<base::ListValue> eventData(new base::ListValue);
+  eventData->Append(pressure.ToValue().release());
+
+  DispatchEvent("memorypressure", eventData.Pass());
+}
+
 void DeviceCapabilitiesObject::OnGetAVCodecs(
     scoped_ptr<XWalkExtensionFunctionInfo> info) {
-  scoped_ptr<SystemAVCodecs> av_codecs(
-      SysAppsManager::GetAVCodecsProvider()->GetSupportedCodecs());
-  info->PostResult(GetAVCodecs::Results::Create(*av_codecs, std::string()));
+  info->PostResult(
+      SysAppsManager::GetAVCodecsProvider()->GetSupportedCodecsResults());
 }
 
 void DeviceCapabilitiesObject::OnGetCPUInfo(
     scoped_ptr<XWalkExtensionFunctionInfo> info) {
   scoped_ptr<SystemCPU> cpu_info(
       SysAppsManager::GetCPUInfoProvider()->cpu_info());
+
+  // While sampling, the latest sample is more accurate than the provider.
+  SystemSampler::Sample sample;
+  if (SysAppsManager::GetSystemSampler()->GetLatestSample(&sample))
+    cpu_info->load = sample.cpu_load;
+
   info->PostResult(GetCPUInfo::Results::Create(*cpu_info, std::string()));
 }
 
@@ -117,8 +240,17 @@ void DeviceCapabilitiesObject::OnGetDisplayInfo(
 
 void DeviceCapabilitiesObject::OnGetMemoryInfo(
     scoped_ptr<XWalkExtensionFunctionInfo> info) {
-  scoped_ptr<SystemMemory> memory_info(
-      SysAppsManager::GetMemoryInfoProvider()->memory_info());
+  // While sampling, the system is not queried again.
+  SystemSampler::Sample sample;
+  scoped_ptr<SystemMemory> memory_info;
+  if (SysAppsManager::GetSystemSampler()->GetLatestSample(&sample)) {
+    memory_info.reset(new SystemMemory);
+    memory_info->capacity = sample.memory_capacity;
+    memory_info->avail_capacity = sample.memory_avail_capacity;
+  } else {
+    memory_info = SysAppsManager::GetMemoryInfoProvider()->memory_info();
+  }
+
   info->PostResult(GetMemoryInfo::Results::Create(*memory_info, std::string()));
 }
 
@@ -136,9 +268,67 @@ void DeviceCapabilitiesObject::OnGetStorageInfo(
   }
 
   scoped_ptr<SystemStorage> storage_info(provider->storage_info());
+
+  // While monitoring, the latest sample tells the available capacity without
+  // querying the file systems on this thread.
+  StorageCapacityMonitor* monitor(SysAppsManager::GetStorageCapacityMonitor());
+  for (size_t i = 0; i < storage_info->storages.size(); ++i) {
+    StorageUnit* storage = storage_info->storages[i].get();
+    double avail_capacity;
+    if (monitor->GetLatestAvailCapacity(storage->id, &avail_capacity))
+      storage->avail_capacity.reset(new double(avail_capacity));
+  }
+
   info->PostResult(GetStorageInfo::Results::Create(
       *storage_info, std::string()));
 }
 
+void DeviceCapabilitiesObject::OnGetLoadHistory(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  std::vector<SystemSampler::Sample> samples =
+      SysAppsManager::GetSystemSampler()->GetSamples();
+
+  SystemLoadHistory history;
+  for (size_t i = 0; i < samples.size(); ++i)
+    history.samples.push_back(MakeSystemLoad(samples[i]));
+
+  info->PostResult(GetLoadHistory::Results::Create(history, std::string()));
+}
+
+void DeviceCapabilitiesObject::OnSetSamplingInterval(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  scoped_ptr<SetSamplingInterval::Params>
+      params(SetSamplingInterval::Params::Create(*info->arguments()));
+  if (!params) {
+    LOG(WARNING) << "Malformed parameters passed to " << info->name();
+    return;
+  }
+
+  sampling_interval_ = base::TimeDelta::FromMilliseconds(params->interval);
+  SetDispatchPolicy("cpuload", DISPATCH_LATEST, sampling_interval_);
+
+  // Observing again updates the interval.
+  SystemSampler* sampler = SysAppsManager::GetSystemSampler();
+  if (sampler->HasObserver(this))
+    sampler->AddObserver(this, sampling_interval_);
+}
+
+void DeviceCapabilitiesObject::OnSetStorageQuota(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  scoped_ptr<SetStorageQuota::Params>
+      params(SetStorageQuota::Params::Create(*info->arguments()));
+  if (!params) {
+    LOG(WARNING) << "Malformed parameters passed to " << info->name();
+    return;
+  }
+
+  storage_quota_ = params->quota;
+
+  // Observing again updates the quota.
+  StorageCapacityMonitor* monitor = SysAppsManager::GetStorageCapacityMonitor();
+  if (monitor->HasObserver(this))
+    monitor->AddObserver(this, storage_quota_);
+}
+
 }  // namespace sysapps
 }  // namespace xwalk
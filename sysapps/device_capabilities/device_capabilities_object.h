@@ -6,16 +6,21 @@
 #define XWALK_SYSAPPS_DEVICE_CAPABILITIES_DEVICE_CAPABILITIES_OBJECT_H_
 
 #include <string>
+#include "base/time/time.h"
 #include "xwalk/sysapps/common/event_target.h"
 #include "xwalk/sysapps/device_capabilities/display_info_provider.h"
+#include "xwalk/sysapps/device_capabilities/storage_capacity_monitor.h"
 #include "xwalk/sysapps/device_capabilities/storage_info_provider.h"
+#include "xwalk/sysapps/device_capabilities/system_sampler.h"
 
 namespace xwalk {
 namespace sysapps {
 
 class DeviceCapabilitiesObject : public EventTarget,
                                  public DisplayInfoProvider::Observer,
-                                 public StorageInfoProvider::Observer {
+                                 public StorageCapacityMonitor::Observer,
+                                 public StorageInfoProvider::Observer,
+                                 public SystemSampler::Observer {
  public:
   DeviceCapabilitiesObject();
   virtual ~DeviceCapabilitiesObject();
@@ -28,16 +33,29 @@ class DeviceCapabilitiesObject : public EventTarget,
   void OnDisplayConnected(const DisplayUnit& display) override;
   void OnDisplayDisconnected(const DisplayUnit& display) override;
 
+  // StorageCapacityMonitor::Observer implementation.
+  void OnStoragePressureChanged(const StoragePressure& pressure) override;
+
   // StorageInfoProvider::Observer implementation.
   void OnStorageAttached(const StorageUnit& storage) override;
   void OnStorageDetached(const StorageUnit& storage) override;
 
+  // SystemSampler::Observer implementation.
+  void OnSystemSampled(const SystemSampler::Sample& sample) override;
+
  private:
   void OnGetAVCodecs(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnGetCPUInfo(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnGetDisplayInfo(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnGetMemoryInfo(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnGetStorageInfo(scoped_ptr<XWalkExtensionFunctionInfo> info);
+  void OnGetLoadHistory(scoped_ptr<XWalkExtensionFunctionInfo> info);
+  void OnSetSamplingInterval(scoped_ptr<XWalkExtensionFunctionInfo> info);
+  void OnSetStorageQuota(scoped_ptr<XWalkExtensionFunctionInfo> info);
+
+  base::TimeDelta sampling_interval_;
+  jsapi::device_capabilities::MemoryPressureLevel memory_pressure_level_;
+  double storage_quota_;
 };
 
 }  // namespace sysapps
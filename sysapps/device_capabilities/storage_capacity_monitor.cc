@@ -0,0 +1,202 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/sysapps/device_capabilities/storage_capacity_monitor.h"
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/sys_info.h"
+#include "base/task_runner_util.h"
+#include "base/threading/worker_pool.h"
+#include "xwalk/sysapps/device_capabilities/storage_info_provider.h"
+
+namespace xwalk {
+namespace sysapps {
+
+using namespace jsapi::device_capabilities; // NOLINT
+
+namespace {
+
+// Thresholds of available capacity, relative to the capacity, for the
+// storage pressure levels.
+const double kModerateStoragePressure = 0.15;
+const double kCriticalStoragePressure = 0.05;
+
+}  // namespace
+
+StorageCapacityMonitor::Sample::Sample()
+    : capacity(0),
+      avail_capacity(-1) {}
+
+StorageCapacityMonitor::ObserverState::ObserverState()
+    : quota(0) {}
+
+StorageCapacityMonitor::ObserverState::~ObserverState() {}
+
+StorageCapacityMonitor::StorageCapacityMonitor(StorageInfoProvider* provider,
+                                               base::TimeDelta interval)
+    : provider_(provider),
+      interval_(interval),
+      sampling_(false),
+      weak_factory_(this) {}
+
+StorageCapacityMonitor::~StorageCapacityMonitor() {}
+
+void StorageCapacityMonitor::AddObserver(Observer* observer, double quota) {
+  observers_[observer].quota = quota;
+
+  if (timer_.IsRunning())
+    return;
+
+  timer_.Start(FROM_HERE, interval_, this, &StorageCapacityMonitor::TakeSample);
+  TakeSample();
+}
+
+void StorageCapacityMonitor::RemoveObserver(Observer* observer) {
+  observers_.erase(observer);
+  if (!observers_.empty())
+    return;
+
+  // A sample in progress is dropped, the next observer starts from scratch.
+  timer_.Stop();
+  weak_factory_.InvalidateWeakPtrs();
+  sampling_ = false;
+  latest_samples_.clear();
+}
+
+bool StorageCapacityMonitor::HasObserver(Observer* observer) const {
+  return observers_.find(observer) != observers_.end();
+}
+
+bool StorageCapacityMonitor::GetLatestAvailCapacity(
+    const std::string& id, double* avail_capacity) const {
+  SampleMap::const_iterator it = latest_samples_.find(id);
+  if (it == latest_samples_.end() || it->second.avail_capacity < 0)
+    return false;
+
+  *avail_capacity = it->second.avail_capacity;
+  return true;
+}
+
+// static
+StoragePressureLevel StorageCapacityMonitor::GetPressureLevel(
+    double capacity, double avail_capacity, double quota) {
+  if (avail_capacity < quota)
+    return STORAGE_PRESSURE_LEVEL_CRITICAL;
+  if (capacity <= 0)
+    return STORAGE_PRESSURE_LEVEL_NONE;
+
+  const double available = avail_capacity / capacity;
+  if (available < kCriticalStoragePressure)
+    return STORAGE_PRESSURE_LEVEL_CRITICAL;
+  if (available < kModerateStoragePressure)
+    return STORAGE_PRESSURE_LEVEL_MODERATE;
+  return STORAGE_PRESSURE_LEVEL_NONE;
+}
+
+void StorageCapacityMonitor::TakeSample() {
+  if (sampling_ || !provider_->IsInitialized())
+    return;
+
+  // The storages are listed here, since the provider is not thread safe, and
+  // only the file system is queried on the worker thread.
+  std::map<std::string, base::FilePath> locations(
+      provider_->storage_locations());
+  scoped_ptr<SystemStorage> storage_info(provider_->storage_info());
+
+  SampleMap samples;
+  for (size_t i = 0; i < storage_info->storages.size(); ++i) {
+    const StorageUnit& storage = *storage_info->storages[i];
+    std::map<std::string, base::FilePath>::const_iterator it =
+        locations.find(storage.id);
+    if (it == locations.end())
+      continue;
+
+    Sample& sample = samples[storage.id];
+    sample.location = it->second;
+    sample.capacity = storage.capacity;
+  }
+
+  if (samples.empty())
+    return;
+
+  sampling_ = true;
+  base::PostTaskAndReplyWithResult(
+      base::WorkerPool::GetTaskRunner(true /* task_is_slow */).get(),
+      FROM_HERE,
+      base::Bind(&StorageCapacityMonitor::ReadAvailCapacities, samples),
+      base::Bind(&StorageCapacityMonitor::OnSampled,
+                 weak_factory_.GetWeakPtr()));
+}
+
+// static
+StorageCapacityMonitor::SampleMap StorageCapacityMonitor::ReadAvailCapacities(
+    SampleMap samples) {
+  for (SampleMap::iterator it = samples.begin(); it != samples.end(); ++it) {
+    int64 free_space =
+        base::SysInfo::AmountOfFreeDiskSpace(it->second.location);
+    if (free_space >= 0)
+      it->second.avail_capacity = static_cast<double>(free_space);
+  }
+
+  return samples;
+}
+
+void StorageCapacityMonitor::OnSampled(const SampleMap& samples) {
+  sampling_ = false;
+  latest_samples_ = samples;
+
+  // Observers can remove themselves when notified.
+  std::vector<Observer*> observers;
+  for (std::map<Observer*, ObserverState>::const_iterator it =
+       observers_.begin(); it != observers_.end(); ++it) {
+    observers.push_back(it->first);
+  }
+
+  for (size_t i = 0; i < observers.size(); ++i) {
+    std::map<Observer*, ObserverState>::iterator state =
+        observers_.find(observers[i]);
+    if (state == observers_.end())
+      continue;
+
+    // The levels of the storages that went away are forgotten.
+    std::map<std::string, StoragePressureLevel> levels;
+    levels.swap(state->second.levels);
+
+    for (SampleMap::const_iterator it = samples.begin(); it != samples.end();
+         ++it) {
+      const Sample& sample = it->second;
+      std::map<std::string, StoragePressureLevel>::const_iterator previous =
+          levels.find(it->first);
+      if (sample.avail_capacity < 0) {
+        if (previous != levels.end())
+          state->second.levels.insert(*previous);
+        continue;
+      }
+
+      StoragePressureLevel level = GetPressureLevel(
+          sample.capacity, sample.avail_capacity, state->second.quota);
+      if (level != STORAGE_PRESSURE_LEVEL_NONE)
+        state->second.levels[it->first] = level;
+
+      const StoragePressureLevel previous_level = previous == levels.end() ?
+          STORAGE_PRESSURE_LEVEL_NONE : previous->second;
+      if (level == previous_level)
+        continue;
+
+      StoragePressure pressure;
+      pressure.id = it->first;
+      pressure.level = level;
+      pressure.capacity = sample.capacity;
+      pressure.avail_capacity = sample.avail_capacity;
+      observers[i]->OnStoragePressureChanged(pressure);
+
+      if (!HasObserver(observers[i]))
+        break;
+    }
+  }
+}
+
+}  // namespace sysapps
+}  // namespace xwalk
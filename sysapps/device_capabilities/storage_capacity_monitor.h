@@ -0,0 +1,112 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_SYSAPPS_DEVICE_CAPABILITIES_STORAGE_CAPACITY_MONITOR_H_
+#define XWALK_SYSAPPS_DEVICE_CAPABILITIES_STORAGE_CAPACITY_MONITOR_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "xwalk/sysapps/device_capabilities/device_capabilities.h"
+
+namespace xwalk {
+namespace sysapps {
+
+using jsapi::device_capabilities::StoragePressure;
+using jsapi::device_capabilities::StoragePressureLevel;
+
+class StorageInfoProvider;
+
+// Samples the available capacity of the mounted storages on a worker thread,
+// at a regular interval while there are observers. Observers are only
+// notified when the pressure level of a storage changes for them, so they
+// don't have to poll the storages to throttle their writes.
+//
+// Each observer declares a quota, the free space in bytes its application
+// needs, below which a storage is at the critical level for this observer.
+class StorageCapacityMonitor {
+ public:
+  class Observer {
+   public:
+    Observer() {}
+    virtual ~Observer() {}
+
+    virtual void OnStoragePressureChanged(const StoragePressure& pressure) = 0;
+  };
+
+  StorageCapacityMonitor(StorageInfoProvider* provider,
+                         base::TimeDelta interval);
+  ~StorageCapacityMonitor();
+
+  // Adding an observer again updates its quota, which is taken into account
+  // from the next sample.
+  void AddObserver(Observer* observer, double quota);
+  void RemoveObserver(Observer* observer);
+  bool HasObserver(Observer* observer) const;
+
+  // Returns false if the storage was not sampled yet or if sampling is
+  // stopped.
+  bool GetLatestAvailCapacity(const std::string& id,
+                              double* avail_capacity) const;
+
+  // Critical below 5% of the capacity or below the quota, moderate below
+  // 15% of the capacity. Only the quota is used for storages of unknown
+  // capacity.
+  static StoragePressureLevel GetPressureLevel(double capacity,
+                                               double avail_capacity,
+                                               double quota);
+
+ private:
+  // In bytes, a negative |avail_capacity| when it could not be read.
+  struct Sample {
+    Sample();
+
+    base::FilePath location;
+    double capacity;
+    double avail_capacity;
+  };
+
+  typedef std::map<std::string, Sample> SampleMap;
+
+  struct ObserverState {
+    ObserverState();
+    ~ObserverState();
+
+    double quota;
+
+    // Storages that are not in the map are at the "none" level.
+    std::map<std::string, StoragePressureLevel> levels;
+  };
+
+  void TakeSample();
+
+  // Called on a worker thread.
+  static SampleMap ReadAvailCapacities(SampleMap samples);
+
+  void OnSampled(const SampleMap& samples);
+
+  StorageInfoProvider* provider_;
+  base::TimeDelta interval_;
+
+  std::map<Observer*, ObserverState> observers_;
+  base::RepeatingTimer<StorageCapacityMonitor> timer_;
+
+  // Only one sample is taken at a time, a slow storage delays the next one.
+  bool sampling_;
+  SampleMap latest_samples_;
+
+  base::WeakPtrFactory<StorageCapacityMonitor> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(StorageCapacityMonitor);
+};
+
+}  // namespace sysapps
+}  // namespace xwalk
+
+#endif  // XWALK_SYSAPPS_DEVICE_CAPABILITIES_STORAGE_CAPACITY_MONITOR_H_
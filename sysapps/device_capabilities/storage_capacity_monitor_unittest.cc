@@ -0,0 +1,151 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/sysapps/device_capabilities/storage_capacity_monitor.h"
+
+#include <map>
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/sysapps/device_capabilities/storage_info_provider.h"
+
+using namespace xwalk::jsapi::device_capabilities; // NOLINT
+using xwalk::sysapps::StorageCapacityMonitor;
+using xwalk::sysapps::StorageInfoProvider;
+
+namespace {
+
+const char kStorageId[] = "test-storage";
+
+// Far more than any disk can have available.
+const double kHugeQuota = 1e18;
+
+// A single storage mounted in |location|, of unknown capacity.
+class FakeStorageInfoProvider : public StorageInfoProvider {
+ public:
+  explicit FakeStorageInfoProvider(const base::FilePath& location)
+      : location_(location) {
+    MarkInitialized();
+  }
+
+  scoped_ptr<SystemStorage> storage_info() const override {
+    scoped_ptr<SystemStorage> info(new SystemStorage);
+    linked_ptr<StorageUnit> storage(new StorageUnit);
+    storage->id = kStorageId;
+    storage->capacity = 0;
+    info->storages.push_back(storage);
+
+    return info.Pass();
+  }
+
+  std::map<std::string, base::FilePath> storage_locations() const override {
+    std::map<std::string, base::FilePath> locations;
+    locations[kStorageId] = location_;
+
+    return locations;
+  }
+
+ private:
+  void StartStorageMonitoring() override {}
+  void StopStorageMonitoring() override {}
+
+  base::FilePath location_;
+};
+
+class PressureWaiter : public StorageCapacityMonitor::Observer {
+ public:
+  PressureWaiter()
+      : run_loop_(NULL),
+        count_(0),
+        level_(STORAGE_PRESSURE_LEVEL_NONE) {}
+
+  void OnStoragePressureChanged(const StoragePressure& pressure) override {
+    EXPECT_EQ(kStorageId, pressure.id);
+    EXPECT_GE(pressure.avail_capacity, 0);
+
+    count_++;
+    level_ = pressure.level;
+    if (run_loop_)
+      run_loop_->Quit();
+  }
+
+  void Wait() {
+    base::RunLoop run_loop;
+    run_loop_ = &run_loop;
+    run_loop.Run();
+    run_loop_ = NULL;
+  }
+
+  int count() const { return count_; }
+  StoragePressureLevel level() const { return level_; }
+
+ private:
+  base::RunLoop* run_loop_;
+  int count_;
+  StoragePressureLevel level_;
+};
+
+}  // namespace
+
+TEST(XWalkSysAppsDeviceCapabilitiesTest, StoragePressureLevel) {
+  EXPECT_EQ(STORAGE_PRESSURE_LEVEL_NONE,
+            StorageCapacityMonitor::GetPressureLevel(100, 50, 0));
+  EXPECT_EQ(STORAGE_PRESSURE_LEVEL_NONE,
+            StorageCapacityMonitor::GetPressureLevel(100, 15, 0));
+  EXPECT_EQ(STORAGE_PRESSURE_LEVEL_MODERATE,
+            StorageCapacityMonitor::GetPressureLevel(100, 14, 0));
+  EXPECT_EQ(STORAGE_PRESSURE_LEVEL_CRITICAL,
+            StorageCapacityMonitor::GetPressureLevel(100, 4, 0));
+
+  // The quota applies whatever the capacity.
+  EXPECT_EQ(STORAGE_PRESSURE_LEVEL_CRITICAL,
+            StorageCapacityMonitor::GetPressureLevel(100, 50, 60));
+  EXPECT_EQ(STORAGE_PRESSURE_LEVEL_NONE,
+            StorageCapacityMonitor::GetPressureLevel(0, 50, 40));
+  EXPECT_EQ(STORAGE_PRESSURE_LEVEL_CRITICAL,
+            StorageCapacityMonitor::GetPressureLevel(0, 50, 60));
+}
+
+TEST(XWalkSysAppsDeviceCapabilitiesTest, StorageCapacityMonitor) {
+  base::MessageLoop message_loop;
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  FakeStorageInfoProvider provider(temp_dir.path());
+  StorageCapacityMonitor monitor(&provider,
+                                 base::TimeDelta::FromMilliseconds(10));
+
+  // Without a quota, a storage of unknown capacity is never under pressure,
+  // so |relaxed| is not notified.
+  PressureWaiter relaxed;
+  PressureWaiter demanding;
+  monitor.AddObserver(&relaxed, 0);
+  monitor.AddObserver(&demanding, kHugeQuota);
+  EXPECT_TRUE(monitor.HasObserver(&demanding));
+
+  demanding.Wait();
+  EXPECT_EQ(1, demanding.count());
+  EXPECT_EQ(STORAGE_PRESSURE_LEVEL_CRITICAL, demanding.level());
+
+  double avail_capacity;
+  EXPECT_TRUE(monitor.GetLatestAvailCapacity(kStorageId, &avail_capacity));
+  EXPECT_FALSE(monitor.GetLatestAvailCapacity("unknown", &avail_capacity));
+
+  // Lowering the quota is a change of level, the samples taken in between
+  // are not.
+  monitor.AddObserver(&demanding, 0);
+  demanding.Wait();
+  EXPECT_EQ(2, demanding.count());
+  EXPECT_EQ(STORAGE_PRESSURE_LEVEL_NONE, demanding.level());
+  EXPECT_EQ(0, relaxed.count());
+
+  monitor.RemoveObserver(&demanding);
+  monitor.RemoveObserver(&relaxed);
+  EXPECT_FALSE(monitor.HasObserver(&demanding));
+  EXPECT_FALSE(monitor.GetLatestAvailCapacity(kStorageId, &avail_capacity));
+}
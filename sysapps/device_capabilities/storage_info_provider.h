@@ -5,8 +5,11 @@
 #ifndef XWALK_SYSAPPS_DEVICE_CAPABILITIES_STORAGE_INFO_PROVIDER_H_
 #define XWALK_SYSAPPS_DEVICE_CAPABILITIES_STORAGE_INFO_PROVIDER_H_
 
+#include <map>
+#include <string>
 #include <vector>
 #include "base/callback_forward.h"
+#include "base/files/file_path.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/observer_list.h"
 #include "xwalk/sysapps/device_capabilities/device_capabilities.h"
@@ -30,6 +33,10 @@ class StorageInfoProvider {
 
   virtual scoped_ptr<SystemStorage> storage_info() const = 0;
 
+  // Returns where the storages are mounted, by storage id. Storages that are
+  // not mounted are left out.
+  virtual std::map<std::string, base::FilePath> storage_locations() const = 0;
+
   class Observer {
    public:
     Observer() {}
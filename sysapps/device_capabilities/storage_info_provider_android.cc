@@ -18,6 +18,12 @@ scoped_ptr<SystemStorage> StorageInfoProviderAndroid::storage_info() const {
   return make_scoped_ptr(new SystemStorage);
 }
 
+std::map<std::string, base::FilePath>
+StorageInfoProviderAndroid::storage_locations() const {
+  NOTIMPLEMENTED();
+  return std::map<std::string, base::FilePath>();
+}
+
 void StorageInfoProviderAndroid::StartStorageMonitoring() {
   NOTIMPLEMENTED();
 }
@@ -16,6 +16,7 @@ class StorageInfoProviderAndroid : public StorageInfoProvider {
   virtual ~StorageInfoProviderAndroid();
 
   scoped_ptr<SystemStorage> storage_info() const override;
+  std::map<std::string, base::FilePath> storage_locations() const override;
 
  private:
   // StorageInfoProvider implementation.
@@ -68,6 +68,23 @@ scoped_ptr<SystemStorage> StorageInfoProviderChromium::storage_info() const {
   return info.Pass();
 }
 
+std::map<std::string, base::FilePath>
+StorageInfoProviderChromium::storage_locations() const {
+  std::map<std::string, base::FilePath> locations;
+
+  StorageMonitor* monitor = StorageMonitor::GetInstance();
+  DCHECK(monitor->IsInitialized());
+
+  std::vector<StorageInfo> storages = monitor->GetAllAvailableStorages();
+  for (std::vector<StorageInfo>::const_iterator it = storages.begin();
+      it != storages.end(); ++it) {
+    if (!it->location().empty())
+      locations[it->device_id()] = base::FilePath(it->location());
+  }
+
+  return locations;
+}
+
 void StorageInfoProviderChromium::OnRemovableStorageAttached(
     const StorageInfo& info) {
   NotifyStorageAttached(*makeStorageUnit(info));
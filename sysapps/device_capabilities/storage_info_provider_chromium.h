@@ -24,6 +24,7 @@ class StorageInfoProviderChromium
   virtual ~StorageInfoProviderChromium();
 
   scoped_ptr<SystemStorage> storage_info() const override;
+  std::map<std::string, base::FilePath> storage_locations() const override;
 
   // RemovableStorageObserver implementation.
   void OnRemovableStorageAttached(
@@ -0,0 +1,309 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/sysapps/device_capabilities/system_sampler.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/location.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/sys_info.h"
+#include "base/thread_task_runner_handle.h"
+#include "base/threading/thread.h"
+#include "xwalk/sysapps/device_capabilities/cpu_info_provider.h"
+
+namespace xwalk {
+namespace sysapps {
+
+namespace {
+
+const char kProcStat[] = "/proc/stat";
+const char kProcMeminfo[] = "/proc/meminfo";
+
+// Number of samples kept in the ring buffer.
+const size_t kMaxSamples = 60;
+
+const int64 kMinIntervalMs = 100;
+const int64 kMaxIntervalMs = 60 * 1000;
+
+// Returns the value of a "Key:   1234 kB" line of /proc/meminfo, in bytes.
+bool GetMeminfoValue(const std::vector<std::string>& fields, double* value) {
+  uint64 kilobytes;
+  if (fields.size() < 2 || !base::StringToUint64(fields[1], &kilobytes))
+    return false;
+
+  *value = static_cast<double>(kilobytes) * 1024;
+  return true;
+}
+
+}  // namespace
+
+SystemSampler::Sample::Sample()
+    : timestamp(0),
+      cpu_load(0),
+      memory_capacity(0),
+      memory_avail_capacity(0) {}
+
+SystemSampler::Sample::~Sample() {}
+
+SystemSampler::CPUTimes::CPUTimes()
+    : idle(0),
+      total(0) {}
+
+SystemSampler::SystemSampler()
+    : generation_(0),
+      next_sample_(0) {}
+
+SystemSampler::~SystemSampler() {
+  // Outstanding samples are dropped, and the thread is joined before the
+  // members it uses are destroyed.
+  {
+    base::AutoLock lock(lock_);
+    generation_++;
+  }
+  thread_.reset();
+}
+
+void SystemSampler::AddObserver(Observer* observer,
+                                base::TimeDelta interval) {
+  if (!HasObserver(observer))
+    observer_list_.AddObserver(observer);
+
+  intervals_[observer] = std::max(
+      base::TimeDelta::FromMilliseconds(kMinIntervalMs),
+      std::min(interval, base::TimeDelta::FromMilliseconds(kMaxIntervalMs)));
+  UpdateInterval();
+}
+
+void SystemSampler::RemoveObserver(Observer* observer) {
+  observer_list_.RemoveObserver(observer);
+  intervals_.erase(observer);
+  UpdateInterval();
+}
+
+bool SystemSampler::HasObserver(Observer* observer) const {
+  return observer_list_.HasObserver(observer);
+}
+
+bool SystemSampler::GetLatestSample(Sample* sample) const {
+  base::AutoLock lock(lock_);
+  if (samples_.empty() || interval_ == base::TimeDelta())
+    return false;
+
+  *sample = samples_[(next_sample_ + samples_.size() - 1) % samples_.size()];
+  return true;
+}
+
+std::vector<SystemSampler::Sample> SystemSampler::GetSamples() const {
+  base::AutoLock lock(lock_);
+  std::vector<Sample> samples;
+  samples.reserve(samples_.size());
+
+  // Once the buffer is full, |next_sample_| is the oldest sample.
+  for (size_t i = 0; i < samples_.size(); ++i)
+    samples.push_back(samples_[(next_sample_ + i) % samples_.size()]);
+
+  return samples;
+}
+
+// static
+bool SystemSampler::ParseProcStat(const std::string& content,
+                                  std::vector<CPUTimes>* times) {
+  times->clear();
+
+  std::vector<std::string> lines;
+  base::SplitString(content, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (!StartsWithASCII(lines[i], "cpu", true))
+      continue;
+
+    // cpu user nice system idle iowait irq softirq steal [guest guest_nice]
+    // The guest times are already accounted in the user time.
+    std::vector<std::string> fields;
+    base::SplitStringAlongWhitespace(lines[i], &fields);
+    if (fields.size() < 5)
+      return false;
+
+    CPUTimes cpu_times;
+    for (size_t field = 1; field < fields.size() && field <= 8; ++field) {
+      uint64 value;
+      if (!base::StringToUint64(fields[field], &value))
+        return false;
+
+      cpu_times.total += value;
+      // idle and iowait.
+      if (field == 4 || field == 5)
+        cpu_times.idle += value;
+    }
+    times->push_back(cpu_times);
+  }
+
+  return !times->empty();
+}
+
+// static
+bool SystemSampler::ParseProcMeminfo(const std::string& content,
+                                     double* capacity,
+                                     double* avail_capacity) {
+  bool has_capacity = false;
+  bool has_available = false;
+  double free = 0;
+  double buffers = 0;
+  double cached = 0;
+
+  std::vector<std::string> lines;
+  base::SplitString(content, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    std::vector<std::string> fields;
+    base::SplitStringAlongWhitespace(lines[i], &fields);
+    if (fields.empty())
+      continue;
+
+    if (fields[0] == "MemTotal:")
+      has_capacity = GetMeminfoValue(fields, capacity);
+    else if (fields[0] == "MemAvailable:")
+      has_available = GetMeminfoValue(fields, avail_capacity);
+    else if (fields[0] == "MemFree:")
+      GetMeminfoValue(fields, &free);
+    else if (fields[0] == "Buffers:")
+      GetMeminfoValue(fields, &buffers);
+    else if (fields[0] == "Cached:")
+      GetMeminfoValue(fields, &cached);
+  }
+
+  // MemAvailable is only provided by Linux 3.14 and later.
+  if (!has_available)
+    *avail_capacity = free + buffers + cached;
+
+  return has_capacity;
+}
+
+// static
+double SystemSampler::ComputeLoad(const CPUTimes& previous,
+                                  const CPUTimes& current) {
+  if (current.total <= previous.total || current.idle < previous.idle)
+    return 0;
+
+  const double total = current.total - previous.total;
+  const double idle = current.idle - previous.idle;
+  return std::max(0.0, std::min(1.0, 1 - idle / total));
+}
+
+void SystemSampler::UpdateInterval() {
+  base::TimeDelta interval;
+  for (std::map<Observer*, base::TimeDelta>::const_iterator it =
+       intervals_.begin(); it != intervals_.end(); ++it) {
+    if (interval == base::TimeDelta() || it->second < interval)
+      interval = it->second;
+  }
+
+  int generation;
+  {
+    base::AutoLock lock(lock_);
+    if (interval == interval_)
+      return;
+
+    interval_ = interval;
+    generation = ++generation_;
+  }
+
+  // Sampling stops when there are no observers left.
+  if (interval == base::TimeDelta())
+    return;
+
+  if (!thread_) {
+    owner_task_runner_ = base::ThreadTaskRunnerHandle::Get();
+    thread_.reset(new base::Thread("SystemSampler"));
+    thread_->Start();
+  }
+
+  thread_->message_loop_proxy()->PostTask(
+      FROM_HERE,
+      base::Bind(&SystemSampler::TakeSample,
+                 base::Unretained(this), generation));
+}
+
+void SystemSampler::TakeSample(int generation) {
+  base::TimeDelta interval;
+  {
+    base::AutoLock lock(lock_);
+    if (generation != generation_)
+      return;
+    interval = interval_;
+  }
+
+  Sample sample;
+  sample.timestamp = base::Time::Now().ToJsTime();
+
+  std::string content;
+  std::vector<CPUTimes> times;
+  if (base::ReadFileToString(base::FilePath(kProcStat), &content) &&
+      ParseProcStat(content, &times)) {
+    // The load is measured between two readings, the first one is only
+    // used as a reference.
+    const bool has_reference = previous_times_.size() == times.size();
+    if (has_reference) {
+      sample.cpu_load = ComputeLoad(previous_times_[0], times[0]);
+      for (size_t i = 1; i < times.size(); ++i)
+        sample.core_loads.push_back(ComputeLoad(previous_times_[i], times[i]));
+    }
+    previous_times_.swap(times);
+
+    if (!has_reference) {
+      base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+          FROM_HERE,
+          base::Bind(&SystemSampler::TakeSample,
+                     base::Unretained(this), generation),
+          interval);
+      return;
+    }
+  } else {
+    // No /proc/stat on this platform.
+    CPUInfoProvider provider;
+    sample.cpu_load = provider.cpu_info()->load;
+  }
+
+  if (!base::ReadFileToString(base::FilePath(kProcMeminfo), &content) ||
+      !ParseProcMeminfo(content, &sample.memory_capacity,
+                        &sample.memory_avail_capacity)) {
+    sample.memory_capacity = base::SysInfo::AmountOfPhysicalMemory();
+    sample.memory_avail_capacity =
+        base::SysInfo::AmountOfAvailablePhysicalMemory();
+  }
+
+  {
+    base::AutoLock lock(lock_);
+    if (generation != generation_)
+      return;
+
+    if (samples_.size() < kMaxSamples)
+      samples_.push_back(sample);
+    else
+      samples_[next_sample_] = sample;
+    next_sample_ = (next_sample_ + 1) % kMaxSamples;
+  }
+
+  owner_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&SystemSampler::NotifyObservers,
+                 base::Unretained(this), sample));
+
+  base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE,
+      base::Bind(&SystemSampler::TakeSample,
+                 base::Unretained(this), generation),
+      interval);
+}
+
+void SystemSampler::NotifyObservers(const Sample& sample) {
+  FOR_EACH_OBSERVER(Observer, observer_list_, OnSystemSampled(sample));
+}
+
+}  // namespace sysapps
+}  // namespace xwalk
@@ -0,0 +1,123 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_SYSAPPS_DEVICE_CAPABILITIES_SYSTEM_SAMPLER_H_
+#define XWALK_SYSAPPS_DEVICE_CAPABILITIES_SYSTEM_SAMPLER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/observer_list.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+namespace base {
+class SingleThreadTaskRunner;
+class Thread;
+}
+
+namespace xwalk {
+namespace sysapps {
+
+// Samples the CPU load, per core, and the memory usage at a regular interval
+// on a background thread, while there are observers. The last samples are
+// kept in a ring buffer shared by all the observers, so the latest values can
+// be read without querying the system again.
+class SystemSampler {
+ public:
+  struct Sample {
+    Sample();
+    ~Sample();
+
+    // Wall clock time of the sample, in milliseconds since the epoch.
+    double timestamp;
+
+    // Load between 0 and 1, of all the cores and of each one of them.
+    double cpu_load;
+    std::vector<double> core_loads;
+
+    // In bytes.
+    double memory_capacity;
+    double memory_avail_capacity;
+  };
+
+  // Time spent by a CPU since boot, in the units of /proc/stat.
+  struct CPUTimes {
+    CPUTimes();
+
+    uint64 idle;
+    uint64 total;
+  };
+
+  class Observer {
+   public:
+    Observer() {}
+    virtual ~Observer() {}
+
+    virtual void OnSystemSampled(const Sample& sample) = 0;
+  };
+
+  SystemSampler();
+  ~SystemSampler();
+
+  // The sampling interval is the shortest of the intervals requested by the
+  // observers. Adding an observer again updates its interval.
+  void AddObserver(Observer* observer, base::TimeDelta interval);
+  void RemoveObserver(Observer* observer);
+  bool HasObserver(Observer* observer) const;
+
+  // Returns false if nothing was sampled yet or if sampling is stopped, in
+  // which case the latest sample might be outdated.
+  bool GetLatestSample(Sample* sample) const;
+
+  // Returns the samples of the ring buffer, the oldest first.
+  std::vector<Sample> GetSamples() const;
+
+  // Parses the content of /proc/stat into the times of all the CPUs,
+  // followed by the times of each core.
+  static bool ParseProcStat(const std::string& content,
+                            std::vector<CPUTimes>* times);
+
+  // Parses the content of /proc/meminfo, the values are returned in bytes.
+  static bool ParseProcMeminfo(const std::string& content,
+                               double* capacity,
+                               double* avail_capacity);
+
+  // Returns the load of a CPU between two readings of its times.
+  static double ComputeLoad(const CPUTimes& previous, const CPUTimes& current);
+
+ private:
+  void UpdateInterval();
+
+  // Called on the sampling thread, samples are dropped once |generation|
+  // is outdated, which happens when the interval changes or sampling stops.
+  void TakeSample(int generation);
+  void NotifyObservers(const Sample& sample);
+
+  ObserverList<Observer> observer_list_;
+  std::map<Observer*, base::TimeDelta> intervals_;
+
+  scoped_ptr<base::Thread> thread_;
+  scoped_refptr<base::SingleThreadTaskRunner> owner_task_runner_;
+
+  // Only used on the sampling thread.
+  std::vector<CPUTimes> previous_times_;
+
+  // Guards the members below, which are shared with the sampling thread.
+  mutable base::Lock lock_;
+  int generation_;
+  base::TimeDelta interval_;
+  std::vector<Sample> samples_;
+  size_t next_sample_;
+
+  DISALLOW_COPY_AND_ASSIGN(SystemSampler);
+};
+
+}  // namespace sysapps
+}  // namespace xwalk
+
+#endif  // XWALK_SYSAPPS_DEVICE_CAPABILITIES_SYSTEM_SAMPLER_H_
@@ -0,0 +1,129 @@
+// Copyright (c) 2015 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/sysapps/device_capabilities/system_sampler.h"
+
+#include <string>
+#include <vector>
+
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using xwalk::sysapps::SystemSampler;
+
+namespace {
+
+const char kProcStat[] =
+    "cpu  100 0 100 700 100 0 0 0 0 0\n"
+    "cpu0 50 0 50 350 50 0 0 0 0 0\n"
+    "cpu1 50 0 50 350 50 0 0 0 0 0\n"
+    "intr 12345 0 0\n"
+    "ctxt 6789\n";
+
+const char kProcStatLater[] =
+    "cpu  300 0 100 800 100 0 0 0 0 0\n"
+    "cpu0 250 0 50 350 50 0 0 0 0 0\n"
+    "cpu1 50 0 50 450 50 0 0 0 0 0\n";
+
+class SampleWaiter : public SystemSampler::Observer {
+ public:
+  explicit SampleWaiter(base::RunLoop* run_loop)
+      : run_loop_(run_loop),
+        count_(0) {}
+
+  void OnSystemSampled(const SystemSampler::Sample& sample) override {
+    sample_ = sample;
+    if (++count_ == 2)
+      run_loop_->Quit();
+  }
+
+  const SystemSampler::Sample& sample() const { return sample_; }
+
+ private:
+  base::RunLoop* run_loop_;
+  int count_;
+  SystemSampler::Sample sample_;
+};
+
+}  // namespace
+
+TEST(XWalkSysAppsDeviceCapabilitiesTest, SystemSamplerParseProcStat) {
+  std::vector<SystemSampler::CPUTimes> before;
+  ASSERT_TRUE(SystemSampler::ParseProcStat(kProcStat, &before));
+  ASSERT_EQ(3u, before.size());
+  EXPECT_EQ(1000u, before[0].total);
+  EXPECT_EQ(800u, before[0].idle);
+
+  std::vector<SystemSampler::CPUTimes> after;
+  ASSERT_TRUE(SystemSampler::ParseProcStat(kProcStatLater, &after));
+  ASSERT_EQ(3u, after.size());
+
+  EXPECT_DOUBLE_EQ(2.0 / 3, SystemSampler::ComputeLoad(before[0], after[0]));
+  EXPECT_DOUBLE_EQ(1, SystemSampler::ComputeLoad(before[1], after[1]));
+  EXPECT_DOUBLE_EQ(0, SystemSampler::ComputeLoad(before[2], after[2]));
+
+  // No time elapsed, or counters going backwards.
+  EXPECT_DOUBLE_EQ(0, SystemSampler::ComputeLoad(after[0], after[0]));
+  EXPECT_DOUBLE_EQ(0, SystemSampler::ComputeLoad(after[0], before[0]));
+
+  EXPECT_FALSE(SystemSampler::ParseProcStat("", &after));
+  EXPECT_FALSE(SystemSampler::ParseProcStat("cpu 1 2 a 4 5\n", &after));
+}
+
+TEST(XWalkSysAppsDeviceCapabilitiesTest, SystemSamplerParseProcMeminfo) {
+  double capacity = 0;
+  double avail_capacity = 0;
+
+  ASSERT_TRUE(SystemSampler::ParseProcMeminfo(
+      "MemTotal:        2048 kB\n"
+      "MemFree:          256 kB\n"
+      "MemAvailable:    1024 kB\n"
+      "Buffers:          128 kB\n"
+      "Cached:           128 kB\n",
+      &capacity, &avail_capacity));
+  EXPECT_DOUBLE_EQ(2048 * 1024, capacity);
+  EXPECT_DOUBLE_EQ(1024 * 1024, avail_capacity);
+
+  // Older kernels don't have MemAvailable.
+  ASSERT_TRUE(SystemSampler::ParseProcMeminfo(
+      "MemTotal:        2048 kB\n"
+      "MemFree:          256 kB\n"
+      "Buffers:          128 kB\n"
+      "Cached:           128 kB\n",
+      &capacity, &avail_capacity));
+  EXPECT_DOUBLE_EQ(512 * 1024, avail_capacity);
+
+  EXPECT_FALSE(SystemSampler::ParseProcMeminfo("MemFree: 256 kB\n",
+                                               &capacity, &avail_capacity));
+}
+
+TEST(XWalkSysAppsDeviceCapabilitiesTest, SystemSamplerSamples) {
+  base::MessageLoop message_loop;
+  base::RunLoop run_loop;
+  SampleWaiter waiter(&run_loop);
+
+  SystemSampler sampler;
+  SystemSampler::Sample sample;
+  EXPECT_FALSE(sampler.GetLatestSample(&sample));
+
+  sampler.AddObserver(&waiter, base::TimeDelta::FromMilliseconds(100));
+  EXPECT_TRUE(sampler.HasObserver(&waiter));
+  run_loop.Run();
+
+  EXPECT_GE(waiter.sample().cpu_load, 0);
+  EXPECT_LE(waiter.sample().cpu_load, 1);
+  EXPECT_GE(waiter.sample().memory_capacity,
+            waiter.sample().memory_avail_capacity);
+
+  ASSERT_TRUE(sampler.GetLatestSample(&sample));
+  std::vector<SystemSampler::Sample> samples = sampler.GetSamples();
+  ASSERT_LE(2u, samples.size());
+  for (size_t i = 1; i < samples.size(); ++i)
+    EXPECT_LE(samples[i - 1].timestamp, samples[i].timestamp);
+
+  sampler.RemoveObserver(&waiter);
+  EXPECT_FALSE(sampler.HasObserver(&waiter));
+  EXPECT_FALSE(sampler.GetLatestSample(&sample));
+}
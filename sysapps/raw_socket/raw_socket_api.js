@@ -13,6 +13,22 @@ internal.setupInternalExtension(extension);
 var common = requireNative('sysapps_common');
 common.setupSysAppsCommon(internal, v8tools);
 
+var Promise = requireNative('sysapps_promise').Promise;
+
+// Returns the list of ArrayBuffers or ArrayBufferViews in |data|, which can be
+// one of them or an Array of them, or null if |data| is of another type.
+function toBufferList(data) {
+  function isBuffer(value) {
+    return value instanceof ArrayBuffer || ArrayBuffer.isView(value);
+  };
+
+  if (isBuffer(data))
+    return [data];
+  if (Array.isArray(data) && data.every(isBuffer))
+    return data;
+  return null;
+};
+
 // The ReadyStateObserver is a proxy object that will
 // subscribe to the parent's |readystate| event. An object
 // cannot subscribe to its own events otherwise it will
@@ -37,6 +53,45 @@ var ReadyStateObserver = function(object_id, initial_state) {
 
 ReadyStateObserver.prototype = new common.EventTargetPrototype();
 
+// Returns the number of bytes of |data| once encoded as UTF-8, which is how
+// strings are written to the socket. Each half of a surrogate pair counts
+// for 2 bytes, so that a pair counts for 4.
+function utf8Length(data) {
+  var length = data.length;
+  for (var i = 0; i < data.length; ++i) {
+    var code = data.charCodeAt(i);
+    if (code >= 0x800 && (code < 0xd800 || code > 0xdfff))
+      length += 2;
+    else if (code >= 0x80)
+      length += 1;
+  }
+  return length;
+};
+
+// The BufferedAmountObserver is a proxy object subscribing to the parent's
+// |bufferedamount| event, which reports the number of bytes written to the
+// socket so far. See ReadyStateObserver for why a proxy is needed.
+//
+var BufferedAmountObserver = function(object_id) {
+  common.BindingObject.call(this, object_id);
+  common.EventTarget.call(this);
+
+  this._addEvent("bufferedamount");
+  this.bytesSent = 0;
+  this.bytesWritten = 0;
+
+  var that = this;
+  this.onbufferedamount = function(event) {
+    that.bytesWritten = event.data;
+  };
+
+  this.destructor = function() {
+    this.onbufferedamount = null;
+  };
+};
+
+BufferedAmountObserver.prototype = new common.EventTargetPrototype();
+
 // TCPSocket interface.
 //
 // TODO(tmpsantos): We are currently not throwing any exceptions
@@ -59,16 +114,21 @@ var TCPSocket = function(remoteAddress, remotePort, options, object_id) {
     options.localPort = 0;
   if (!options.addressReuse)
     options.addressReuse = true;
-  if (!options.noDelay)
+  if (options.noDelay === undefined)
     options.noDelay = true;
   if (!options.useSecureTransport)
     options.useSecureTransport = false;
+  if (options.highWaterMark === undefined)
+    options.highWaterMark = 1024 * 1024;
+  if (options.lowWaterMark === undefined)
+    options.lowWaterMark = Math.floor(options.highWaterMark / 4);
 
   this._addMethod("_close");
   this._addMethod("_halfclose");
   this._addMethod("suspend");
   this._addMethod("resume");
   this._addMethod("_sendString");
+  this._addMethod("_waitForDrain");
 
   this._addEvent("drain");
   this._addEvent("open");
@@ -76,15 +136,33 @@ var TCPSocket = function(remoteAddress, remotePort, options, object_id) {
   this._addEvent("error");
   this._addEvent("data");
 
+  // The data is always queued, but send() returns false once more than
+  // |highWaterMark| bytes are waiting to be written. A "drain" event is
+  // then fired when the queue goes below |lowWaterMark|.
+  //
+  // The data is dropped if the socket is not open, since it would never be
+  // written and would be counted in |bufferedAmount| forever.
   function sendWrapper(data) {
-    this._sendString(data);
-
-    // FIXME(tmpsantos): The spec says that send() should always
-    // return if you can keep sending data. This can only be
-    // verified in the native implementation, which makes this
-    // call sync. We are returning always true here to keep the
-    // implementation async.
-    return true;
+    if (this._readyStateObserver.readyState != "open")
+      return false;
+
+    var observer = this._bufferedAmountObserver;
+    var buffers = toBufferList(data);
+    if (buffers) {
+      for (var i = 0; i < buffers.length; ++i)
+        observer.bytesSent += buffers[i].byteLength;
+      this._postMessage("_sendArrayBuffer", buffers);
+    } else {
+      data = String(data);
+      observer.bytesSent += utf8Length(data);
+      this._sendString(data);
+    }
+
+    if (this.bufferedAmount < options.highWaterMark)
+      return true;
+
+    this._waitForDrain();
+    return false;
   };
 
   function closeWrapper(data) {
@@ -111,6 +189,9 @@ var TCPSocket = function(remoteAddress, remotePort, options, object_id) {
     "_readyStateObserverDeleter": {
       value: v8tools.lifecycleTracker(),
     },
+    "_bufferedAmountObserver": {
+      value: new BufferedAmountObserver(this._id),
+    },
     "send": {
       value: sendWrapper,
       enumerable: true,
@@ -148,7 +229,10 @@ var TCPSocket = function(remoteAddress, remotePort, options, object_id) {
       enumerable: true,
     },
     "bufferedAmount": {
-      value: 0,
+      get: function() {
+        var observer = this._bufferedAmountObserver;
+        return observer.bytesSent - observer.bytesWritten;
+      },
       enumerable: true,
     },
     "readyState": {
@@ -158,8 +242,10 @@ var TCPSocket = function(remoteAddress, remotePort, options, object_id) {
   });
 
   var watcher = this._readyStateObserver;
+  var bufferedAmountWatcher = this._bufferedAmountObserver;
   this._readyStateObserverDeleter.destructor = function() {
     watcher.destructor();
+    bufferedAmountWatcher.destructor();
   };
 
   // This is needed, otherwise events like "error" can get fired before
@@ -200,16 +286,28 @@ var TCPServerSocket = function(options) {
   this._addMethod("_close");
   this._addMethod("suspend");
   this._addMethod("resume");
+  this._addMethodWithPromise("getStats", Promise);
 
-  // FIXME(tmpsantos): Get the real remote IP and port
-  // from the native backend.
+  // Each connection is described by its object ID, its TCPOptions and the
+  // remote address and port. When options.acceptBatchSize is greater than
+  // one, a single event is dispatched for up to acceptBatchSize connections,
+  // which are available in the |connectedSockets| array.
   function ConnectEvent(type, data) {
-    var object_id = data[0];
-    var options = data[1];
+    function createSocket(connection) {
+      var object_id = connection[0];
+      var options = connection[1];
+
+      return new TCPSocket(connection[2], connection[3], options, object_id);
+    }
 
     this.type = type;
-    this.connectedSocket = new TCPSocket(
-        options.localAddress, options.localPort, {}, object_id);
+
+    if (Array.isArray(data[0])) {
+      this.connectedSockets = data.map(createSocket);
+      this.connectedSocket = this.connectedSockets[0];
+    } else {
+      this.connectedSocket = createSocket(data);
+    }
   }
 
   this._addEvent("open");
@@ -303,8 +401,17 @@ var UDPSocket = function(options) {
   this._addMethod("leaveMulticast");
   this._addMethod("_sendString");
 
+  // When options.receiveBatchSize is greater than one, a single event is
+  // dispatched for up to receiveBatchSize datagrams, which are available in
+  // the |datagrams| array. The other attributes refer to the first datagram.
   function MessageEvent(type, data) {
     this.type = type;
+
+    if (data.datagrams) {
+      this.datagrams = data.datagrams;
+      data = data.datagrams[0];
+    }
+
     this.data = data.data;
     this.remotePort = data.remotePort;
     this.remoteAddress = data.remoteAddress;
@@ -316,7 +423,13 @@ var UDPSocket = function(options) {
   this._addEvent("message", MessageEvent);
 
   function sendWrapper(data, remoteAddress, remotePort) {
-    this._sendString(data, remoteAddress, remotePort);
+    var buffers = toBufferList(data);
+    if (buffers) {
+      this._postMessage("_sendArrayBuffer",
+          [buffers, remoteAddress, remotePort]);
+    } else {
+      this._sendString(data, remoteAddress, remotePort);
+    }
 
     // FIXME(tmpsantos): The spec says that send() should always
     // return if you can keep sending data. This can only be
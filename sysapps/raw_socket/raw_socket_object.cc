@@ -4,13 +4,37 @@
 
 #include "xwalk/sysapps/raw_socket/raw_socket_object.h"
 
-#include "base/memory/scoped_ptr.h"
+#include <algorithm>
+
 #include "base/values.h"
 
+namespace {
+
+const int kDefaultBufferSize = 4096;
+const int kMinBufferSize = 1024;
+const int kMaxBufferSize = 1024 * 1024;
+
+// Keeps the BinaryValue received from JavaScript alive for as long as the
+// socket needs its bytes.
+class BinaryValueIOBuffer : public net::WrappedIOBuffer {
+ public:
+  explicit BinaryValueIOBuffer(scoped_ptr<base::BinaryValue> value)
+      : net::WrappedIOBuffer(value->GetBuffer()),
+        value_(value.Pass()) {}
+
+ private:
+  ~BinaryValueIOBuffer() override {}
+
+  scoped_ptr<base::BinaryValue> value_;
+};
+
+}  // namespace
+
 namespace xwalk {
 namespace sysapps {
 
-RawSocketObject::RawSocketObject() {}
+RawSocketObject::RawSocketObject()
+    : read_buffer_size_(kDefaultBufferSize) {}
 
 RawSocketObject::~RawSocketObject() {}
 
@@ -21,5 +45,45 @@ void RawSocketObject::setReadyState(ReadyState state) {
   DispatchEvent("readystate", eventData.Pass());
 }
 
+void RawSocketObject::SetReadBufferSize(int size) {
+  size = std::max(kMinBufferSize, std::min(size, kMaxBufferSize));
+  if (size == read_buffer_size_)
+    return;
+
+  read_buffer_size_ = size;
+  read_buffer_ = NULL;
+  read_data_.reset();
+}
+
+net::IOBuffer* RawSocketObject::GetReadBuffer() {
+  if (!read_buffer_.get()) {
+    read_data_.reset(new char[read_buffer_size_]);
+    read_buffer_ = new net::WrappedIOBuffer(read_data_.get());
+  }
+  return read_buffer_.get();
+}
+
+scoped_ptr<base::BinaryValue> RawSocketObject::TakeReadData(int size) {
+  DCHECK(read_data_);
+  DCHECK_GT(size, 0);
+  DCHECK_LE(size, read_buffer_size_);
+
+  // Copying a small read is cheaper than keeping a mostly empty buffer
+  // alive until the message is sent.
+  if (size < read_buffer_size_ / 2) {
+    return make_scoped_ptr(
+        base::BinaryValue::CreateWithCopiedBuffer(read_data_.get(), size));
+  }
+
+  read_buffer_ = NULL;
+  return make_scoped_ptr(new base::BinaryValue(read_data_.Pass(), size));
+}
+
+// static
+scoped_refptr<net::IOBuffer> RawSocketObject::WrapBinaryValue(
+    scoped_ptr<base::BinaryValue> value) {
+  return new BinaryValueIOBuffer(value.Pass());
+}
+
 }  // namespace sysapps
 }  // namespace xwalk
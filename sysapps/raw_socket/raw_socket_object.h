@@ -5,11 +5,18 @@
 #ifndef XWALK_SYSAPPS_RAW_SOCKET_RAW_SOCKET_OBJECT_H_
 #define XWALK_SYSAPPS_RAW_SOCKET_RAW_SOCKET_OBJECT_H_
 
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/io_buffer.h"
 #include "xwalk/sysapps/raw_socket/raw_socket.h"
 #include "xwalk/sysapps/common/event_target.h"
 
 using xwalk::jsapi::raw_socket::ReadyState; // NOLINT
 
+namespace base {
+class BinaryValue;
+}
+
 namespace xwalk {
 namespace sysapps {
 
@@ -22,6 +29,29 @@ class RawSocketObject : public EventTarget {
   RawSocketObject();
 
   void setReadyState(ReadyState state);
+
+  // Sets the size of the buffer used for reading from the socket, clamped to
+  // a sane range. Must not be called while a read is pending.
+  void SetReadBufferSize(int size);
+  int read_buffer_size() const { return read_buffer_size_; }
+
+  // Returns the buffer to read at most read_buffer_size() bytes into.
+  net::IOBuffer* GetReadBuffer();
+
+  // Returns the first |size| bytes read into the read buffer. Large reads
+  // hand the buffer itself over to the returned value instead of copying it,
+  // a new buffer is then allocated by the next GetReadBuffer().
+  scoped_ptr<base::BinaryValue> TakeReadData(int size);
+
+  // Returns an IOBuffer pointing to the bytes of |value|, which it owns,
+  // so that data sent from JavaScript is written without being copied.
+  static scoped_refptr<net::IOBuffer> WrapBinaryValue(
+      scoped_ptr<base::BinaryValue> value);
+
+ private:
+  int read_buffer_size_;
+  scoped_ptr<char[]> read_data_;
+  scoped_refptr<net::IOBuffer> read_buffer_;
 };
 
 }  // namespace sysapps
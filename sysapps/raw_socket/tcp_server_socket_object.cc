@@ -5,8 +5,14 @@
 #include "xwalk/sysapps/raw_socket/tcp_server_socket_object.h"
 
 #include <string.h>
+
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/guid.h"
 #include "base/logging.h"
+#include "base/message_loop/message_loop.h"
+#include "base/time/time.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_util.h"
@@ -22,10 +28,26 @@ using namespace xwalk::jsapi::raw_socket; // NOLINT
 namespace xwalk {
 namespace sysapps {
 
+namespace {
+
+const int kDefaultBacklog = 128;
+const int kMaxBacklog = 1024;
+const int kMaxAcceptBatchSize = 256;
+
+// Accepting again right away after an error like running out of file
+// descriptors would most likely fail the same way.
+const int kAcceptRetryDelayMs = 100;
+
+}  // namespace
+
 TCPServerSocketObject::TCPServerSocketObject(RawSocketInstance* instance)
   : is_suspended_(false),
     is_accepting_(false),
-    instance_(instance) {
+    accept_batch_size_(1),
+    accepted_connections_(new base::ListValue),
+    stats_(new TCPServerSocketStats),
+    instance_(instance),
+    weak_factory_(this) {
   handler_.Register("init",
       base::Bind(&TCPServerSocketObject::OnInit, base::Unretained(this)));
   handler_.Register("_close",
@@ -34,14 +56,104 @@ TCPServerSocketObject::TCPServerSocketObject(RawSocketInstance* instance)
       base::Bind(&TCPServerSocketObject::OnSuspend, base::Unretained(this)));
   handler_.Register("resume",
       base::Bind(&TCPServerSocketObject::OnResume, base::Unretained(this)));
+  handler_.Register("getStats",
+      base::Bind(&TCPServerSocketObject::OnGetStats, base::Unretained(this)));
 }
 
 TCPServerSocketObject::~TCPServerSocketObject() {}
 
 void TCPServerSocketObject::DoAccept() {
-  socket_->Accept(&accepted_socket_,
-                  base::Bind(&TCPServerSocketObject::OnAccept,
-                             base::Unretained(this)));
+  if (!socket_)
+    return;
+
+  // Accept the connections already waiting in the backlog, up to one
+  // batch, before going back to the message loop.
+  for (size_t i = 0; i < accept_batch_size_; ++i) {
+    int ret = socket_->Accept(&accepted_socket_,
+                              base::Bind(&TCPServerSocketObject::OnAccept,
+                                         base::Unretained(this)));
+
+    if (ret == net::ERR_IO_PENDING) {
+      DispatchAcceptedConnections();
+      return;
+    }
+
+    if (!DidAccept(ret))
+      return;
+  }
+
+  DispatchAcceptedConnections();
+  base::MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&TCPServerSocketObject::DoAccept,
+                 weak_factory_.GetWeakPtr()));
+}
+
+bool TCPServerSocketObject::DidAccept(int status) {
+  if (status != net::OK) {
+    DispatchAcceptedConnections();
+    LOG(WARNING) << "Failed to accept a connection: "
+                 << net::ErrorToString(status);
+    DispatchEvent("connecterror");
+    base::MessageLoop::current()->PostDelayedTask(
+        FROM_HERE,
+        base::Bind(&TCPServerSocketObject::DoAccept,
+                   weak_factory_.GetWeakPtr()),
+        base::TimeDelta::FromMilliseconds(kAcceptRetryDelayMs));
+    return false;
+  }
+
+  if (!is_accepting_ || is_suspended_) {
+    // The spec is not really clear about what to do when we get a incoming
+    // connection but nobody is listening. We are just closing the socket in
+    // this case.
+    accepted_socket_.reset();
+    return true;
+  }
+
+  net::IPEndPoint local_address;
+  accepted_socket_->GetLocalAddress(&local_address);
+  net::IPEndPoint peer_address;
+  accepted_socket_->GetPeerAddress(&peer_address);
+
+  jsapi::tcp_socket::TCPOptions options;
+  options.local_address = local_address.ToStringWithoutPort();
+  options.local_port = local_address.port();
+  options.address_reuse = false;
+  options.no_delay = true;
+  options.use_secure_transport = false;
+
+  std::string object_id = base::GenerateGUID();
+  scoped_ptr<BindingObject> obj(
+      new TCPSocketObject(accepted_socket_.Pass(), stats_.get()));
+  instance_->AddBindingObject(object_id, obj.Pass());
+
+  scoped_ptr<base::ListValue> connection(new base::ListValue);
+  connection->AppendString(object_id);
+  connection->Append(options.ToValue().release());
+  connection->AppendString(peer_address.ToStringWithoutPort());
+  connection->AppendInteger(peer_address.port());
+  accepted_connections_->Append(connection.release());
+
+  return true;
+}
+
+void TCPServerSocketObject::DispatchAcceptedConnections() {
+  if (accepted_connections_->empty())
+    return;
+
+  scoped_ptr<base::ListValue> eventData(new base::ListValue);
+  if (accept_batch_size_ == 1) {
+    scoped_ptr<base::Value> connection;
+    accepted_connections_->Remove(0, &connection);
+    eventData->Append(connection.release());
+  } else {
+    // In batch mode the event carries the list of all the connections.
+    eventData->Append(accepted_connections_.release());
+    accepted_connections_.reset(new base::ListValue);
+  }
+
+  DispatchEvent("connect", eventData.Pass());
 }
 
 void TCPServerSocketObject::StartEvent(const std::string& type) {
@@ -72,10 +184,18 @@ void TCPServerSocketObject::OnInit(
     return;
   }
 
+  int backlog = kDefaultBacklog;
+  if (params->options.backlog)
+    backlog = std::max(1, std::min(*params->options.backlog, kMaxBacklog));
+  if (params->options.accept_batch_size) {
+    accept_batch_size_ = std::max(
+        1, std::min(*params->options.accept_batch_size, kMaxAcceptBatchSize));
+  }
+
   socket_.reset(new net::TCPServerSocket(NULL, net::NetLog::Source()));
   net::IPEndPoint address(ip_number, params->options.local_port);
 
-  if (socket_->Listen(address, 5) != net::OK) {
+  if (socket_->Listen(address, backlog) != net::OK) {
     LOG(WARNING) << "Failed to listen on " << params->options.local_address
         << " port " << params->options.local_port;
     setReadyState(READY_STATE_CLOSED);
@@ -92,6 +212,7 @@ void TCPServerSocketObject::OnClose(
     scoped_ptr<XWalkExtensionFunctionInfo> info) {
   if (socket_)
     socket_.reset();
+  accepted_connections_->Clear();
 
   setReadyState(READY_STATE_CLOSED);
   DispatchEvent("close");
@@ -107,38 +228,20 @@ void TCPServerSocketObject::OnResume(
   is_suspended_ = false;
 }
 
-void TCPServerSocketObject::OnAccept(int status) {
-  if (is_accepting_ && !is_suspended_) {
-    net::IPEndPoint local_address;
-    accepted_socket_->GetLocalAddress(&local_address);
-
-    jsapi::tcp_socket::TCPOptions options;
-    options.local_address = local_address.ToStringWithoutPort();
-    options.local_port = local_address.port();
-    options.address_reuse = false;
-    options.no_delay = true;
-    options.use_secure_transport = false;
-
-    std::string object_id = base::GenerateGUID();
-    scoped_ptr<BindingObject> obj(new TCPSocketObject(accepted_socket_.Pass()));
-    instance_->AddBindingObject(object_id, obj.Pass());
-
-    scoped_ptr<base::ListValue> dataList(new base::ListValue);
-    dataList->AppendString(object_id);
-    dataList->Append(options.ToValue().release());
-
-    scoped_ptr<base::ListValue> eventData(new base::ListValue);
-    eventData->Append(dataList.release());
+void TCPServerSocketObject::OnGetStats(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  TCPServerStats stats;
+  stats.accepted_connections = stats_->accepted_connections;
+  stats.open_connections = stats_->open_connections;
+  stats.bytes_received = stats_->bytes_received;
+  stats.bytes_sent = stats_->bytes_sent;
 
-    DispatchEvent("connect", eventData.Pass());
-  } else {
-    // The spec is not really clear about what to do when we get a incoming
-    // connection but nobody is listening. We are just closing the socket in
-    // this case.
-    accepted_socket_.reset();
-  }
+  info->PostResult(GetStats::Results::Create(stats, std::string()));
+}
 
-  DoAccept();
+void TCPServerSocketObject::OnAccept(int status) {
+  if (DidAccept(status))
+    DoAccept();
 }
 
 }  // namespace sysapps
@@ -6,6 +6,9 @@
 #define XWALK_SYSAPPS_RAW_SOCKET_TCP_SERVER_SOCKET_OBJECT_H_
 
 #include <string>
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/values.h"
 #include "net/socket/tcp_server_socket.h"
 #include "xwalk/sysapps/common/event_target.h"
 #include "xwalk/sysapps/raw_socket/raw_socket_extension.h"
@@ -15,6 +18,7 @@ namespace xwalk {
 namespace sysapps {
 
 class BindingObjectStore;
+class TCPServerSocketStats;
 
 class TCPServerSocketObject : public RawSocketObject {
  public:
@@ -23,6 +27,10 @@ class TCPServerSocketObject : public RawSocketObject {
 
  private:
   void DoAccept();
+  // Handles a completed accept, returns false if no other connection should
+  // be accepted for now.
+  bool DidAccept(int status);
+  void DispatchAcceptedConnections();
 
   // EventTarget implementation.
   void StartEvent(const std::string& type) override;
@@ -33,6 +41,7 @@ class TCPServerSocketObject : public RawSocketObject {
   void OnClose(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnSuspend(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnResume(scoped_ptr<XWalkExtensionFunctionInfo> info);
+  void OnGetStats(scoped_ptr<XWalkExtensionFunctionInfo> info);
 
   // net::TCPServerSocket callbacks.
   void OnAccept(int status);
@@ -40,10 +49,19 @@ class TCPServerSocketObject : public RawSocketObject {
   bool is_suspended_;
   bool is_accepting_;
 
+  // Maximum number of connections delivered by a single "connect" event.
+  // Connections already pending in the backlog are accepted in a row and
+  // sent to JavaScript together.
+  size_t accept_batch_size_;
+  scoped_ptr<base::ListValue> accepted_connections_;
+
   scoped_ptr<net::TCPServerSocket> socket_;
   scoped_ptr<net::StreamSocket> accepted_socket_;
+  scoped_refptr<TCPServerSocketStats> stats_;
 
   RawSocketInstance* instance_;
+
+  base::WeakPtrFactory<TCPServerSocketObject> weak_factory_;
 };
 
 }  // namespace sysapps
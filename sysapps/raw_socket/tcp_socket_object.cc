@@ -5,47 +5,91 @@
 #include "xwalk/sysapps/raw_socket/tcp_socket_object.h"
 
 #include <string.h>
+
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/logging.h"
+#include "base/message_loop/message_loop.h"
+#include "base/values.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_util.h"
+#include "net/socket/tcp_client_socket.h"
 #include "xwalk/sysapps/raw_socket/tcp_socket.h"
 
 using namespace xwalk::jsapi::tcp_socket; // NOLINT
 using namespace xwalk::jsapi::raw_socket; // NOLINT
 
+namespace xwalk {
+namespace sysapps {
+
 namespace {
 
-const unsigned kBufferSize = 4096;
+// Buffers queued for writing are merged as long as the result is smaller
+// than this size.
+const int kMaxCoalescedWriteSize = 64 * 1024;
 
 }  // namespace
 
-namespace xwalk {
-namespace sysapps {
+TCPServerSocketStats::TCPServerSocketStats()
+    : accepted_connections(0),
+      open_connections(0),
+      bytes_received(0),
+      bytes_sent(0) {}
+
+TCPServerSocketStats::~TCPServerSocketStats() {}
 
 TCPSocketObject::TCPSocketObject()
     : has_write_pending_(false),
       is_suspended_(false),
       is_half_closed_(false),
-      read_buffer_(new net::IOBuffer(kBufferSize)),
-      write_buffer_(new net::IOBuffer(kBufferSize)),
+      needs_drain_(false),
+      write_report_scheduled_(false),
+      receive_buffer_size_(0),
+      send_buffer_size_(0),
+      no_delay_(true),
+      keep_alive_delay_(0),
+      low_water_mark_(0),
+      queued_bytes_(0),
+      written_bytes_(0),
+      reported_written_bytes_(0),
       resolver_(net::HostResolver::CreateDefaultResolver(NULL)),
-      single_resolver_(new net::SingleRequestHostResolver(resolver_.get())) {
+      single_resolver_(new net::SingleRequestHostResolver(resolver_.get())),
+      weak_factory_(this) {
   RegisterHandlers();
 }
 
-TCPSocketObject::TCPSocketObject(scoped_ptr<net::StreamSocket> socket)
+TCPSocketObject::TCPSocketObject(scoped_ptr<net::StreamSocket> socket,
+                                 TCPServerSocketStats* server_stats)
     : has_write_pending_(false),
       is_suspended_(false),
       is_half_closed_(false),
-      read_buffer_(new net::IOBuffer(kBufferSize)),
-      write_buffer_(new net::IOBuffer(kBufferSize)),
-      socket_(socket.release()) {
+      needs_drain_(false),
+      write_report_scheduled_(false),
+      receive_buffer_size_(0),
+      send_buffer_size_(0),
+      no_delay_(true),
+      keep_alive_delay_(0),
+      low_water_mark_(0),
+      queued_bytes_(0),
+      written_bytes_(0),
+      reported_written_bytes_(0),
+      socket_(socket.release()),
+      server_stats_(server_stats),
+      weak_factory_(this) {
   RegisterHandlers();
+  server_stats_->accepted_connections++;
+  server_stats_->open_connections++;
 }
 
-TCPSocketObject::~TCPSocketObject() {}
+TCPSocketObject::~TCPSocketObject() {
+  ReleaseServerStats();
+}
 
 void TCPSocketObject::RegisterHandlers() {
+  // Reads completing in a burst are sent to JavaScript in a single message.
+  SetDispatchPolicy("data", DISPATCH_QUEUED, base::TimeDelta());
+
   handler_.Register("init",
       base::Bind(&TCPSocketObject::OnInit, base::Unretained(this)));
   handler_.Register("_close",
@@ -58,21 +102,163 @@ void TCPSocketObject::RegisterHandlers() {
       base::Bind(&TCPSocketObject::OnResume, base::Unretained(this)));
   handler_.Register("_sendString",
       base::Bind(&TCPSocketObject::OnSendString, base::Unretained(this)));
+  handler_.Register("_sendArrayBuffer",
+      base::Bind(&TCPSocketObject::OnSendArrayBuffer, base::Unretained(this)));
+  handler_.Register("_waitForDrain",
+      base::Bind(&TCPSocketObject::OnWaitForDrain, base::Unretained(this)));
 }
 
 void TCPSocketObject::DoRead() {
   if (!socket_->IsConnected())
     return;
 
-  int ret = socket_->Read(read_buffer_.get(),
-                          kBufferSize,
+  int ret = socket_->Read(GetReadBuffer(),
+                          read_buffer_size(),
                           base::Bind(&TCPSocketObject::OnRead,
                                      base::Unretained(this)));
 
-  if (ret > 0)
+  if (ret != net::ERR_IO_PENDING)
     OnRead(ret);
 }
 
+void TCPSocketObject::DoWrite() {
+  while (!has_write_pending_ && !write_queue_.empty()) {
+    CoalesceWrites();
+    net::DrainableIOBuffer* buffer = write_queue_.front().get();
+    int ret = socket_->Write(buffer,
+                             buffer->BytesRemaining(),
+                             base::Bind(&TCPSocketObject::OnWrite,
+                                        base::Unretained(this)));
+
+    if (ret == net::ERR_IO_PENDING) {
+      has_write_pending_ = true;
+      return;
+    }
+
+    if (ret < 0) {
+      DidFailWrite();
+      return;
+    }
+
+    DidWrite(ret);
+  }
+}
+
+void TCPSocketObject::DidWrite(int bytes) {
+  DCHECK(!write_queue_.empty());
+  net::DrainableIOBuffer* buffer = write_queue_.front().get();
+  buffer->DidConsume(bytes);
+  if (!buffer->BytesRemaining())
+    write_queue_.pop_front();
+
+  queued_bytes_ -= bytes;
+  written_bytes_ += bytes;
+  if (server_stats_.get())
+    server_stats_->bytes_sent += bytes;
+  ScheduleWriteReport();
+}
+
+void TCPSocketObject::DidFailWrite() {
+  write_queue_.clear();
+  queued_bytes_ = 0;
+  needs_drain_ = false;
+  socket_->Disconnect();
+
+  ReleaseServerStats();
+  setReadyState(READY_STATE_CLOSED);
+  DispatchEvent("error");
+}
+
+void TCPSocketObject::QueueWrite(net::IOBuffer* buffer, int size) {
+  if (!size)
+    return;
+
+  write_queue_.push_back(new net::DrainableIOBuffer(buffer, size));
+  queued_bytes_ += size;
+  DoWrite();
+}
+
+void TCPSocketObject::CoalesceWrites() {
+  int size = 0;
+  size_t count = 0;
+  for (; count < write_queue_.size(); ++count) {
+    int remaining = write_queue_[count]->BytesRemaining();
+    if (size + remaining > kMaxCoalescedWriteSize)
+      break;
+    size += remaining;
+  }
+
+  if (count < 2)
+    return;
+
+  scoped_refptr<net::IOBuffer> coalesced(new net::IOBuffer(size));
+  int offset = 0;
+  for (size_t i = 0; i < count; ++i) {
+    net::DrainableIOBuffer* buffer = write_queue_.front().get();
+    memcpy(coalesced->data() + offset, buffer->data(),
+           buffer->BytesRemaining());
+    offset += buffer->BytesRemaining();
+    write_queue_.pop_front();
+  }
+
+  write_queue_.push_front(new net::DrainableIOBuffer(coalesced.get(), size));
+}
+
+void TCPSocketObject::ApplyBufferSizes() {
+  if (receive_buffer_size_)
+    socket_->SetReceiveBufferSize(receive_buffer_size_);
+  if (send_buffer_size_)
+    socket_->SetSendBufferSize(send_buffer_size_);
+}
+
+void TCPSocketObject::ApplyConnectionOptions() {
+  // Only the sockets connected by this object are known to be
+  // TCPClientSocket, accepted sockets keep the server settings.
+  net::TCPClientSocket* socket =
+      static_cast<net::TCPClientSocket*>(socket_.get());
+  socket->SetNoDelay(no_delay_);
+  socket->SetKeepAlive(keep_alive_delay_ > 0, keep_alive_delay_);
+}
+
+void TCPSocketObject::ScheduleWriteReport() {
+  if (write_report_scheduled_)
+    return;
+
+  // Writes completing in a row are reported together.
+  write_report_scheduled_ = true;
+  base::MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&TCPSocketObject::ReportWrites, weak_factory_.GetWeakPtr()));
+}
+
+void TCPSocketObject::ReportWrites() {
+  write_report_scheduled_ = false;
+
+  if (written_bytes_ != reported_written_bytes_) {
+    reported_written_bytes_ = written_bytes_;
+    scoped_ptr<base::ListValue> eventData(new base::ListValue);
+    eventData->AppendDouble(static_cast<double>(written_bytes_));
+    DispatchEvent("bufferedamount", eventData.Pass());
+  }
+
+  if (needs_drain_ && queued_bytes_ <= low_water_mark_) {
+    needs_drain_ = false;
+    DispatchEvent("drain");
+  }
+}
+
+bool TCPSocketObject::CanWrite() const {
+  return !is_half_closed_ && socket_.get() && socket_->IsConnected();
+}
+
+void TCPSocketObject::ReleaseServerStats() {
+  if (!server_stats_.get())
+    return;
+
+  server_stats_->open_connections--;
+  server_stats_ = NULL;
+}
+
 void TCPSocketObject::OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info) {
   if (socket_.get()) {
     DoRead();
@@ -87,6 +273,20 @@ void TCPSocketObject::OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info) {
     return;
   }
 
+  if (params->options) {
+    if (params->options->receive_buffer_size) {
+      receive_buffer_size_ = *params->options->receive_buffer_size;
+      SetReadBufferSize(receive_buffer_size_);
+    }
+    if (params->options->send_buffer_size)
+      send_buffer_size_ = *params->options->send_buffer_size;
+    if (params->options->low_water_mark)
+      low_water_mark_ = std::max(0, *params->options->low_water_mark);
+    if (params->options->keep_alive_delay)
+      keep_alive_delay_ = *params->options->keep_alive_delay;
+    no_delay_ = params->options->no_delay;
+  }
+
   net::HostResolver::RequestInfo request_info(
       net::HostPortPair(params->remote_address, params->remote_port));
 
@@ -101,9 +301,14 @@ void TCPSocketObject::OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info) {
 }
 
 void TCPSocketObject::OnClose(scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  write_queue_.clear();
+  queued_bytes_ = 0;
+  needs_drain_ = false;
+  has_write_pending_ = false;
   if (socket_.get())
     socket_->Disconnect();
 
+  ReleaseServerStats();
   setReadyState(READY_STATE_CLOSED);
   DispatchEvent("close");
 }
@@ -126,10 +331,7 @@ void TCPSocketObject::OnResume(scoped_ptr<XWalkExtensionFunctionInfo> info) {
 
 void TCPSocketObject::OnSendString(
     scoped_ptr<XWalkExtensionFunctionInfo> info) {
-  if (is_half_closed_ || has_write_pending_)
-    return;
-
-  if (!socket_.get() || !socket_->IsConnected())
+  if (!CanWrite())
     return;
 
   scoped_ptr<SendDOMString::Params>
@@ -140,24 +342,40 @@ void TCPSocketObject::OnSendString(
     return;
   }
 
-  if (params->data.size() > kBufferSize) {
-    LOG(WARNING) << "Write data bigger than the write buffer.";
-    return;
-  }
+  scoped_ptr<std::string> data(new std::string);
+  data->swap(params->data);
+  const int size = data->size();
+  QueueWrite(new net::StringIOBuffer(data.Pass()), size);
+}
 
-  memcpy(write_buffer_->data(), params->data.data(), params->data.size());
+void TCPSocketObject::OnSendArrayBuffer(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  if (!CanWrite())
+    return;
 
-  int ret = socket_->Write(write_buffer_.get(),
-                           params->data.size(),
-                           base::Bind(&TCPSocketObject::OnWrite,
-                                      base::Unretained(this)));
+  // Every argument is an ArrayBuffer, written one after the other.
+  base::ListValue* arguments = info->arguments();
+  while (!arguments->empty()) {
+    scoped_ptr<base::Value> value;
+    arguments->Remove(0, &value);
+    if (!value->IsType(base::Value::TYPE_BINARY)) {
+      LOG(WARNING) << "Malformed parameters passed to " << info->name();
+      return;
+    }
+
+    scoped_ptr<base::BinaryValue> data(
+        static_cast<base::BinaryValue*>(value.release()));
+    const int size = data->GetSize();
+    QueueWrite(WrapBinaryValue(data.Pass()).get(), size);
+  }
+}
 
-  if (ret == net::ERR_IO_PENDING)
-    has_write_pending_ = true;
-  else if (ret == static_cast<int>(params->data.size()))
-    return;
-  else
-    socket_->Disconnect();
+void TCPSocketObject::OnWaitForDrain(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  // send() returned false in JavaScript because the high watermark was
+  // reached, which the application is told about by a "drain" event.
+  needs_drain_ = true;
+  ScheduleWriteReport();
 }
 
 void TCPSocketObject::OnConnect(int status) {
@@ -167,6 +385,8 @@ void TCPSocketObject::OnConnect(int status) {
     else
       setReadyState(READY_STATE_OPEN);
 
+    ApplyBufferSizes();
+    ApplyConnectionOptions();
     DispatchEvent("open");
     DoRead();
   } else {
@@ -176,30 +396,45 @@ void TCPSocketObject::OnConnect(int status) {
 }
 
 void TCPSocketObject::OnRead(int status) {
-  scoped_ptr<base::ListValue> eventData(new base::ListValue);
-
   // No data means the other side has
   // disconnected the socket.
   if (status == 0) {
+    ReleaseServerStats();
     setReadyState(READY_STATE_CLOSED);
-    DispatchEvent("close", eventData.Pass());
+    DispatchEvent("close");
     return;
   }
 
-  scoped_ptr<base::Value> data(base::BinaryValue::CreateWithCopiedBuffer(
-      static_cast<char*>(read_buffer_->data()), status));
+  if (status < 0) {
+    ReleaseServerStats();
+    setReadyState(READY_STATE_CLOSED);
+    DispatchEvent("error");
+    return;
+  }
 
-  eventData->Append(data.release());
+  if (server_stats_.get())
+    server_stats_->bytes_received += status;
 
-  if (!is_suspended_)
+  // The read buffer is reused when nobody is listening.
+  if (!is_suspended_ && IsEventActive("data")) {
+    scoped_ptr<base::ListValue> eventData(new base::ListValue);
+    eventData->Append(TakeReadData(status).release());
     DispatchEvent("data", eventData.Pass());
+  }
 
   DoRead();
 }
 
 void TCPSocketObject::OnWrite(int status) {
   has_write_pending_ = false;
-  DispatchEvent("drain");
+
+  if (status < 0) {
+    DidFailWrite();
+    return;
+  }
+
+  DidWrite(status);
+  DoWrite();
 }
 
 void TCPSocketObject::OnResolved(int status) {
@@ -5,7 +5,10 @@
 #ifndef XWALK_SYSAPPS_RAW_SOCKET_TCP_SOCKET_OBJECT_H_
 #define XWALK_SYSAPPS_RAW_SOCKET_TCP_SOCKET_OBJECT_H_
 
+#include <deque>
 #include <string>
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "net/dns/single_request_host_resolver.h"
 #include "net/base/io_buffer.h"
 #include "net/socket/tcp_client_socket.h"
@@ -14,15 +17,53 @@
 namespace xwalk {
 namespace sysapps {
 
+// Counters of a TCPServerSocketObject, updated by the TCPSocketObjects of the
+// connections it accepted, which can outlive the server.
+class TCPServerSocketStats : public base::RefCounted<TCPServerSocketStats> {
+ public:
+  TCPServerSocketStats();
+
+  int64 accepted_connections;
+  int open_connections;
+  int64 bytes_received;
+  int64 bytes_sent;
+
+ private:
+  friend class base::RefCounted<TCPServerSocketStats>;
+  ~TCPServerSocketStats();
+
+  DISALLOW_COPY_AND_ASSIGN(TCPServerSocketStats);
+};
+
 class TCPSocketObject : public RawSocketObject {
  public:
   TCPSocketObject();
-  explicit TCPSocketObject(scoped_ptr<net::StreamSocket> socket);
+  // Wraps a connection accepted by a server socket, which traffic is
+  // accounted in |server_stats|.
+  TCPSocketObject(scoped_ptr<net::StreamSocket> socket,
+                  TCPServerSocketStats* server_stats);
   virtual ~TCPSocketObject();
 
  private:
   void RegisterHandlers();
   void DoRead();
+  void DoWrite();
+  void DidWrite(int bytes);
+  // Drops the pending writes and closes the socket, the data can't be
+  // delivered anymore.
+  void DidFailWrite();
+  void QueueWrite(net::IOBuffer* buffer, int size);
+  // Merges the small buffers at the front of the write queue, so that they
+  // are written by a single call to the socket.
+  void CoalesceWrites();
+  void ApplyBufferSizes();
+  void ApplyConnectionOptions();
+
+  // Reports the number of bytes written so far to JavaScript, which keeps
+  // track of |bufferedAmount|, and fires "drain" if it was requested and
+  // the write queue is below the low watermark.
+  void ScheduleWriteReport();
+  void ReportWrites();
 
   // JavaScript function handlers.
   void OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info);
@@ -31,6 +72,8 @@ class TCPSocketObject : public RawSocketObject {
   void OnSuspend(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnResume(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnSendString(scoped_ptr<XWalkExtensionFunctionInfo> info);
+  void OnSendArrayBuffer(scoped_ptr<XWalkExtensionFunctionInfo> info);
+  void OnWaitForDrain(scoped_ptr<XWalkExtensionFunctionInfo> info);
 
   // net::TCPClientSocket callbacks.
   void OnConnect(int status);
@@ -40,17 +83,45 @@ class TCPSocketObject : public RawSocketObject {
   // net::SingleRequestHostResolver callbacks.
   void OnResolved(int status);
 
+  bool CanWrite() const;
+
+  // Stops accounting this connection in |server_stats_|.
+  void ReleaseServerStats();
+
   bool has_write_pending_;
   bool is_suspended_;
   bool is_half_closed_;
+  bool needs_drain_;
+  bool write_report_scheduled_;
+
+  // Socket buffer sizes requested by the application, 0 keeps the system
+  // defaults.
+  int receive_buffer_size_;
+  int send_buffer_size_;
+
+  bool no_delay_;
+  // Delay in seconds before the first keep-alive probe, 0 disables them.
+  int keep_alive_delay_;
 
-  scoped_refptr<net::IOBuffer> read_buffer_;
-  scoped_refptr<net::IOBuffer> write_buffer_;
+  // "drain" is fired once the write queue holds at most |low_water_mark_|
+  // bytes. The high watermark is enforced by send() in JavaScript.
+  int64 low_water_mark_;
+  int64 queued_bytes_;
+  int64 written_bytes_;
+  int64 reported_written_bytes_;
+
+  // Data sent from JavaScript, written in order. Only the buffer at the
+  // front can be partially written.
+  std::deque<scoped_refptr<net::DrainableIOBuffer> > write_queue_;
   scoped_ptr<net::StreamSocket> socket_;
 
   scoped_ptr<net::HostResolver> resolver_;
   scoped_ptr<net::SingleRequestHostResolver> single_resolver_;
   net::AddressList addresses_;
+
+  scoped_refptr<TCPServerSocketStats> server_stats_;
+
+  base::WeakPtrFactory<TCPSocketObject> weak_factory_;
 };
 
 }  // namespace sysapps
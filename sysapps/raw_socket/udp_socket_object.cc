@@ -6,31 +6,53 @@
 
 #include <string.h>
 
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/logging.h"
+#include "base/message_loop/message_loop.h"
+#include "base/values.h"
 #include "net/base/net_errors.h"
+#include "net/base/net_util.h"
 #include "xwalk/sysapps/raw_socket/udp_socket.h"
 
 using namespace xwalk::jsapi::udp_socket; // NOLINT
 using namespace xwalk::jsapi::raw_socket; // NOLINT
 
+namespace xwalk {
+namespace sysapps {
+
 namespace {
 
-const unsigned kBufferSize = 4096;
+// Upper bound for UDPOptions.receiveBatchSize.
+const int kMaxReceiveBatchSize = 1024;
 
 }  // namespace
 
-namespace xwalk {
-namespace sysapps {
+UDPSocketObject::Datagram::Datagram(net::IOBuffer* buffer,
+                                    int size,
+                                    const net::HostPortPair& destination)
+    : buffer(buffer),
+      size(size),
+      destination(destination) {}
+
+UDPSocketObject::Datagram::~Datagram() {}
 
 UDPSocketObject::UDPSocketObject()
     : has_write_pending_(false),
       is_suspended_(false),
       is_reading_(false),
-      read_buffer_(new net::IOBuffer(kBufferSize)),
-      write_buffer_(new net::IOBuffer(kBufferSize)),
-      write_buffer_size_(0),
+      buffer_sizes_applied_(false),
+      receive_buffer_size_(0),
+      send_buffer_size_(0),
+      receive_batch_size_(1),
+      received_datagrams_(new base::ListValue),
       resolver_(net::HostResolver::CreateDefaultResolver(NULL)),
-      single_resolver_(new net::SingleRequestHostResolver(resolver_.get())) {
+      single_resolver_(new net::SingleRequestHostResolver(resolver_.get())),
+      weak_factory_(this) {
+  // Datagrams received in a burst are sent to JavaScript in a single message.
+  SetDispatchPolicy("message", DISPATCH_QUEUED, base::TimeDelta());
+
   handler_.Register("init",
       base::Bind(&UDPSocketObject::OnInit, base::Unretained(this)));
   handler_.Register("_close",
@@ -45,24 +67,202 @@ UDPSocketObject::UDPSocketObject()
       base::Bind(&UDPSocketObject::OnLeaveMulticast, base::Unretained(this)));
   handler_.Register("_sendString",
       base::Bind(&UDPSocketObject::OnSendString, base::Unretained(this)));
+  handler_.Register("_sendArrayBuffer",
+      base::Bind(&UDPSocketObject::OnSendArrayBuffer, base::Unretained(this)));
 }
 
 UDPSocketObject::~UDPSocketObject() {}
 
 void UDPSocketObject::DoRead() {
-  if (!socket_->is_connected())
+  if (!socket_ || !socket_->is_connected())
     return;
 
   is_reading_ = true;
 
-  int ret = socket_->RecvFrom(read_buffer_.get(),
-                              kBufferSize,
-                              &from_,
-                              base::Bind(&UDPSocketObject::OnRead,
-                                         base::Unretained(this)));
+  // Read whatever is already queued by the system, up to one batch, before
+  // going back to the message loop.
+  for (size_t i = 0; i < receive_batch_size_; ++i) {
+    int ret = socket_->RecvFrom(GetReadBuffer(),
+                                read_buffer_size(),
+                                &from_,
+                                base::Bind(&UDPSocketObject::OnRead,
+                                           base::Unretained(this)));
+
+    if (ret == net::ERR_IO_PENDING) {
+      DispatchReceivedDatagrams();
+      return;
+    }
+
+    if (!DidRead(ret))
+      return;
+  }
+
+  // A full batch was read synchronously, give other tasks a chance to run
+  // before reading the next one.
+  DispatchReceivedDatagrams();
+  base::MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&UDPSocketObject::DoRead, weak_factory_.GetWeakPtr()));
+}
+
+bool UDPSocketObject::DidRead(int status) {
+  // No data means the other side has
+  // disconnected the socket.
+  if (status == 0) {
+    DispatchReceivedDatagrams();
+    setReadyState(READY_STATE_CLOSED);
+    DispatchEvent("close");
+    return false;
+  }
+
+  if (status < 0) {
+    DispatchReceivedDatagrams();
+    is_reading_ = false;
+    DispatchEvent("error");
+    return false;
+  }
+
+  // The read buffer is reused when nobody is listening.
+  if (is_suspended_ || !IsEventActive("message"))
+    return true;
+
+  // The event is built by hand rather than from an UDPMessageEvent, which
+  // would copy the data twice.
+  scoped_ptr<base::DictionaryValue> datagram(new base::DictionaryValue);
+  datagram->Set("data", TakeReadData(status).release());
+  datagram->SetString("remoteAddress", from_.ToStringWithoutPort());
+  datagram->SetInteger("remotePort", from_.port());
+  received_datagrams_->Append(datagram.release());
+
+  return true;
+}
+
+void UDPSocketObject::DispatchReceivedDatagrams() {
+  if (received_datagrams_->empty())
+    return;
+
+  scoped_ptr<base::ListValue> eventData(new base::ListValue);
+  if (receive_batch_size_ == 1) {
+    scoped_ptr<base::Value> datagram;
+    received_datagrams_->Remove(0, &datagram);
+    eventData->Append(datagram.release());
+  } else {
+    // In batch mode the event carries all the datagrams, in the order they
+    // were received.
+    scoped_ptr<base::DictionaryValue> event(new base::DictionaryValue);
+    event->Set("datagrams", received_datagrams_.release());
+    received_datagrams_.reset(new base::ListValue);
+    eventData->Append(event.release());
+  }
+
+  DispatchEvent("message", eventData.Pass());
+}
+
+void UDPSocketObject::DoWrite() {
+  while (!has_write_pending_ && !write_queue_.empty()) {
+    const net::HostPortPair& destination = write_queue_.front().destination;
+    if (!destination.host().empty() &&
+        !destination.Equals(resolved_destination_)) {
+      resolving_destination_ = destination;
+      net::HostResolver::RequestInfo request_info(destination);
+      int ret = single_resolver_->Resolve(
+          request_info,
+          net::DEFAULT_PRIORITY,
+          &addresses_,
+          base::Bind(&UDPSocketObject::OnResolved,
+                     base::Unretained(this)),
+          net::BoundNetLog());
+
+      if (ret == net::ERR_IO_PENDING) {
+        has_write_pending_ = true;
+        return;
+      }
+
+      if (!DidResolve(ret))
+        return;
+    }
+
+    if (!SendNextDatagram())
+      return;
+  }
+}
+
+void UDPSocketObject::QueueDatagram(net::IOBuffer* buffer,
+                                    int size,
+                                    const net::HostPortPair& destination) {
+  write_queue_.push_back(Datagram(buffer, size, destination));
+  DoWrite();
+}
+
+void UDPSocketObject::ApplyBufferSizes() {
+  if (buffer_sizes_applied_)
+    return;
+
+  buffer_sizes_applied_ = true;
+  if (receive_buffer_size_)
+    socket_->SetReceiveBufferSize(receive_buffer_size_);
+  if (send_buffer_size_)
+    socket_->SetSendBufferSize(send_buffer_size_);
+}
+
+bool UDPSocketObject::SendNextDatagram() {
+  if (addresses_.empty()) {
+    Fail();
+    return false;
+  }
+
+  if (!socket_->is_connected()) {
+    // If we are waiting for reads and the socket is not connect,
+    // it means the connection was closed.
+    if (is_reading_ || socket_->Connect(addresses_[0]) != net::OK) {
+      Fail();
+      return false;
+    }
+    ApplyBufferSizes();
+  }
+
+  const Datagram& datagram = write_queue_.front();
+  int ret = socket_->SendTo(
+      datagram.buffer.get(),
+      datagram.size,
+      addresses_[0],
+      base::Bind(&UDPSocketObject::OnWrite, base::Unretained(this)));
+
+  if (!is_reading_ && socket_->is_connected())
+    DoRead();
+
+  if (ret == net::ERR_IO_PENDING) {
+    has_write_pending_ = true;
+    return false;
+  }
 
-  if (ret > 0)
-    OnRead(ret);
+  if (ret != datagram.size) {
+    write_queue_.clear();
+    socket_->Close();
+    setReadyState(READY_STATE_CLOSED);
+    DispatchEvent("close");
+    return false;
+  }
+
+  write_queue_.pop_front();
+  return true;
+}
+
+bool UDPSocketObject::DidResolve(int status) {
+  if (status != net::OK) {
+    resolved_destination_ = net::HostPortPair();
+    Fail();
+    return false;
+  }
+
+  resolved_destination_ = resolving_destination_;
+  return true;
+}
+
+void UDPSocketObject::Fail() {
+  write_queue_.clear();
+  setReadyState(READY_STATE_CLOSED);
+  DispatchEvent("error");
 }
 
 void UDPSocketObject::OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info) {
@@ -84,6 +284,40 @@ void UDPSocketObject::OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info) {
     return;
   }
 
+  if (params->options->receive_buffer_size) {
+    receive_buffer_size_ = *params->options->receive_buffer_size;
+    SetReadBufferSize(receive_buffer_size_);
+  }
+  if (params->options->send_buffer_size)
+    send_buffer_size_ = *params->options->send_buffer_size;
+  if (params->options->receive_batch_size) {
+    receive_batch_size_ = std::max(
+        1, std::min(*params->options->receive_batch_size,
+                    kMaxReceiveBatchSize));
+  }
+
+  // The multicast options can only be set before the socket is bound or
+  // connected.
+  int ret = socket_->SetMulticastLoopbackMode(params->options->loopback);
+  if (ret == net::OK && params->options->multicast_interface) {
+    // An interface index, which the IDL long passes as a signed value.
+    int interface_index = *params->options->multicast_interface;
+    if (interface_index < 0) {
+      ret = net::ERR_INVALID_ARGUMENT;
+    } else {
+      ret = socket_->SetMulticastInterface(
+          static_cast<uint32>(interface_index));
+    }
+  }
+  if (ret == net::OK && params->options->multicast_ttl)
+    ret = socket_->SetMulticastTimeToLive(*params->options->multicast_ttl);
+  if (ret != net::OK) {
+    LOG(WARNING) << "Invalid multicast options: " << net::ErrorToString(ret);
+    setReadyState(READY_STATE_CLOSED);
+    DispatchEvent("error");
+    return;
+  }
+
   if (!params->options->local_address.empty()) {
     net::IPAddressNumber ip_number;
     if (!net::ParseIPLiteralToNumber(params->options->local_address,
@@ -105,6 +339,7 @@ void UDPSocketObject::OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info) {
       return;
     }
 
+    ApplyBufferSizes();
     DoRead();
     OnConnectionOpen(net::OK);
     return;
@@ -116,10 +351,13 @@ void UDPSocketObject::OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info) {
     return;
   }
 
-  net::HostResolver::RequestInfo request_info(net::HostPortPair(
-      params->options->remote_address, params->options->remote_port));
+  resolving_destination_ = net::HostPortPair(
+      params->options->remote_address, params->options->remote_port);
+  net::HostResolver::RequestInfo request_info(resolving_destination_);
 
-  int ret = single_resolver_->Resolve(
+  // Datagrams sent before the remote address is resolved wait for it.
+  has_write_pending_ = true;
+  ret = single_resolver_->Resolve(
       request_info,
       net::DEFAULT_PRIORITY,
       &addresses_,
@@ -132,6 +370,8 @@ void UDPSocketObject::OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info) {
 }
 
 void UDPSocketObject::OnClose(scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  write_queue_.clear();
+  received_datagrams_->Clear();
   socket_.reset();
 }
 
@@ -145,132 +385,171 @@ void UDPSocketObject::OnResume(scoped_ptr<XWalkExtensionFunctionInfo> info) {
 
 void UDPSocketObject::OnJoinMulticast(
     scoped_ptr<XWalkExtensionFunctionInfo> info) {
-}
+  if (!socket_)
+    return;
 
-void UDPSocketObject::OnLeaveMulticast(
-    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  scoped_ptr<JoinMulticast::Params>
+      params(JoinMulticast::Params::Create(*info->arguments()));
+  if (!params) {
+    LOG(WARNING) << "Malformed parameters passed to " << info->name();
+    return;
+  }
+
+  net::IPAddressNumber group;
+  if (!net::ParseIPLiteralToNumber(params->multicast_group_address, &group)) {
+    LOG(WARNING) << "Invalid IP address " << params->multicast_group_address;
+    return;
+  }
+
+  // Only a bound socket can join a group, which means that the socket must
+  // have been created with a local address.
+  int ret = socket_->JoinGroup(group);
+  if (ret != net::OK) {
+    LOG(WARNING) << "Can't join " << params->multicast_group_address << ": "
+                 << net::ErrorToString(ret);
+  }
 }
 
-void UDPSocketObject::OnSendString(
+void UDPSocketObject::OnLeaveMulticast(
     scoped_ptr<XWalkExtensionFunctionInfo> info) {
-  if (!socket_ || has_write_pending_)
+  if (!socket_)
     return;
 
-  scoped_ptr<SendDOMString::Params>
-      params(SendDOMString::Params::Create(*info->arguments()));
+  scoped_ptr<LeaveMulticast::Params>
+      params(LeaveMulticast::Params::Create(*info->arguments()));
   if (!params) {
     LOG(WARNING) << "Malformed parameters passed to " << info->name();
     return;
   }
 
-  if (params->data.size() > kBufferSize) {
-    LOG(WARNING) << "Write data bigger than the write buffer.";
+  net::IPAddressNumber group;
+  if (!net::ParseIPLiteralToNumber(params->multicast_group_address, &group)) {
+    LOG(WARNING) << "Invalid IP address " << params->multicast_group_address;
     return;
   }
 
-  write_buffer_size_ = params->data.size();
-  memcpy(write_buffer_->data(), params->data.data(), write_buffer_size_);
+  int ret = socket_->LeaveGroup(group);
+  if (ret != net::OK) {
+    LOG(WARNING) << "Can't leave " << params->multicast_group_address << ": "
+                 << net::ErrorToString(ret);
+  }
+}
 
-  if (!params->remote_address || !*params->remote_port) {
-    OnSend(net::OK);
+void UDPSocketObject::OnSendString(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  if (!socket_)
     return;
-  }
 
-  net::HostResolver::RequestInfo request_info(net::HostPortPair(
-      *params->remote_address, *params->remote_port));
+  scoped_ptr<SendDOMString::Params>
+      params(SendDOMString::Params::Create(*info->arguments()));
+  if (!params) {
+    LOG(WARNING) << "Malformed parameters passed to " << info->name();
+    return;
+  }
 
-  int ret = single_resolver_->Resolve(
-      request_info,
-      net::DEFAULT_PRIORITY,
-      &addresses_,
-      base::Bind(&UDPSocketObject::OnSend,
-                 base::Unretained(this)),
-      net::BoundNetLog());
+  net::HostPortPair destination;
+  if (params->remote_address && params->remote_port && *params->remote_port)
+    destination = net::HostPortPair(*params->remote_address,
+                                    *params->remote_port);
 
-  if (ret != net::ERR_IO_PENDING)
-    OnSend(ret);
-  else
-    has_write_pending_ = true;
+  scoped_ptr<std::string> data(new std::string);
+  data->swap(params->data);
+  const int size = data->size();
+  QueueDatagram(new net::StringIOBuffer(data.Pass()), size, destination);
 }
 
-void UDPSocketObject::OnRead(int status) {
-  // No data means the other side has
-  // disconnected the socket.
-  if (status == 0) {
-    setReadyState(READY_STATE_CLOSED);
-    DispatchEvent("close");
+void UDPSocketObject::OnSendArrayBuffer(
+    scoped_ptr<XWalkExtensionFunctionInfo> info) {
+  if (!socket_)
     return;
-  }
 
-  scoped_ptr<base::Value> data(base::BinaryValue::CreateWithCopiedBuffer(
-      static_cast<char*>(read_buffer_->data()), status));
+  // The arguments are the list of ArrayBuffers making up the datagram,
+  // followed by the optional remote address and port.
+  base::ListValue* arguments = info->arguments();
+  base::ListValue* chunks = NULL;
+  if (!arguments->GetList(0, &chunks)) {
+    LOG(WARNING) << "Malformed parameters passed to " << info->name();
+    return;
+  }
 
-  UDPMessageEvent event;
-  event.data = std::string(read_buffer_->data(), status);
-  event.remote_port = from_.port();
-  event.remote_address = from_.ToStringWithoutPort();
+  std::string remote_address;
+  int remote_port = 0;
+  net::HostPortPair destination;
+  if (arguments->GetString(1, &remote_address) &&
+      arguments->GetInteger(2, &remote_port) && remote_port)
+    destination = net::HostPortPair(remote_address, remote_port);
+
+  size_t size = 0;
+  for (size_t i = 0; i < chunks->GetSize(); ++i) {
+    base::BinaryValue* chunk = NULL;
+    if (!chunks->GetBinary(i, &chunk)) {
+      LOG(WARNING) << "Malformed parameters passed to " << info->name();
+      return;
+    }
+    size += chunk->GetSize();
+  }
 
-  scoped_ptr<base::ListValue> eventData(new base::ListValue);
-  eventData->Append(event.ToValue().release());
+  // A datagram made of a single buffer is sent as is, otherwise the chunks
+  // have to be gathered in a single buffer.
+  if (chunks->GetSize() == 1) {
+    scoped_ptr<base::Value> value;
+    chunks->Remove(0, &value);
+    QueueDatagram(WrapBinaryValue(make_scoped_ptr(
+                      static_cast<base::BinaryValue*>(value.release()))).get(),
+                  size, destination);
+    return;
+  }
 
-  if (!is_suspended_)
-    DispatchEvent("message", eventData.Pass());
+  scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(size));
+  size_t offset = 0;
+  for (size_t i = 0; i < chunks->GetSize(); ++i) {
+    base::BinaryValue* chunk = NULL;
+    chunks->GetBinary(i, &chunk);
+    memcpy(buffer->data() + offset, chunk->GetBuffer(), chunk->GetSize());
+    offset += chunk->GetSize();
+  }
+  QueueDatagram(buffer.get(), size, destination);
+}
 
-  DoRead();
+void UDPSocketObject::OnRead(int status) {
+  if (DidRead(status))
+    DoRead();
 }
 
 void UDPSocketObject::OnWrite(int status) {
   has_write_pending_ = false;
-  DispatchEvent("drain");
+  if (status < 0) {
+    Fail();
+    return;
+  }
+
+  write_queue_.pop_front();
+  DoWrite();
+
+  if (write_queue_.empty())
+    DispatchEvent("drain");
 }
 
 void UDPSocketObject::OnConnectionOpen(int status) {
+  has_write_pending_ = false;
   if (status != net::OK) {
     setReadyState(READY_STATE_CLOSED);
     DispatchEvent("error");
     return;
   }
 
+  if (!resolving_destination_.host().empty())
+    resolved_destination_ = resolving_destination_;
+
   setReadyState(READY_STATE_OPEN);
   DispatchEvent("open");
+  DoWrite();
 }
 
-void UDPSocketObject::OnSend(int status) {
-  if (status != net::OK || addresses_.empty()) {
-    setReadyState(READY_STATE_CLOSED);
-    DispatchEvent("error");
-    return;
-  }
-
-  if (!socket_->is_connected()) {
-    // If we are waiting for reads and the socket is not connect,
-    // it means the connection was closed.
-    if (is_reading_ || socket_->Connect(addresses_[0]) != net::OK) {
-      setReadyState(READY_STATE_CLOSED);
-      DispatchEvent("error");
-      return;
-    }
-  }
-
-  int ret = socket_->SendTo(
-      write_buffer_.get(),
-      write_buffer_size_,
-      addresses_[0],
-      base::Bind(&UDPSocketObject::OnWrite, base::Unretained(this)));
-
-  if (ret == net::ERR_IO_PENDING) {
-    has_write_pending_ = true;
-  } else if (ret == write_buffer_size_) {
-    has_write_pending_ = false;
-  } else {
-    socket_->Close();
-    setReadyState(READY_STATE_CLOSED);
-    DispatchEvent("close");
-    return;
-  }
-
-  if (!is_reading_ && socket_->is_connected())
-    DoRead();
+void UDPSocketObject::OnResolved(int status) {
+  has_write_pending_ = false;
+  if (DidResolve(status) && SendNextDatagram())
+    DoWrite();
 }
 
 }  // namespace sysapps
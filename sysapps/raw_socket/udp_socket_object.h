@@ -5,9 +5,12 @@
 #ifndef XWALK_SYSAPPS_RAW_SOCKET_UDP_SOCKET_OBJECT_H_
 #define XWALK_SYSAPPS_RAW_SOCKET_UDP_SOCKET_OBJECT_H_
 
+#include <deque>
 #include <string>
 
+#include "base/memory/weak_ptr.h"
 #include "net/base/address_list.h"
+#include "net/base/host_port_pair.h"
 #include "net/base/io_buffer.h"
 #include "net/dns/single_request_host_resolver.h"
 #include "net/udp/udp_socket.h"
@@ -22,7 +25,33 @@ class UDPSocketObject : public RawSocketObject {
   virtual ~UDPSocketObject();
 
  private:
+  // A datagram sent from JavaScript and waiting to be sent. An empty
+  // |destination| means the last resolved remote address.
+  struct Datagram {
+    Datagram(net::IOBuffer* buffer, int size,
+             const net::HostPortPair& destination);
+    ~Datagram();
+
+    scoped_refptr<net::IOBuffer> buffer;
+    int size;
+    net::HostPortPair destination;
+  };
+
   void DoRead();
+  void DoWrite();
+  // Handles a completed read, returns false if the socket cannot be read
+  // any further.
+  bool DidRead(int status);
+  void DispatchReceivedDatagrams();
+  void QueueDatagram(net::IOBuffer* buffer, int size,
+                     const net::HostPortPair& destination);
+  void ApplyBufferSizes();
+
+  // Sends the datagram at the front of the queue, returns false if the
+  // queue cannot be processed any further for now.
+  bool SendNextDatagram();
+  bool DidResolve(int status);
+  void Fail();
 
   // JavaScript function handlers.
   void OnInit(scoped_ptr<XWalkExtensionFunctionInfo> info);
@@ -32,6 +61,7 @@ class UDPSocketObject : public RawSocketObject {
   void OnJoinMulticast(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnLeaveMulticast(scoped_ptr<XWalkExtensionFunctionInfo> info);
   void OnSendString(scoped_ptr<XWalkExtensionFunctionInfo> info);
+  void OnSendArrayBuffer(scoped_ptr<XWalkExtensionFunctionInfo> info);
 
   // net::UDPSocket callbacks.
   void OnRead(int status);
@@ -39,22 +69,37 @@ class UDPSocketObject : public RawSocketObject {
 
   // net::SingleRequestHostResolver callbacks.
   void OnConnectionOpen(int status);
-  void OnSend(int status);
+  void OnResolved(int status);
 
   bool has_write_pending_;
   bool is_suspended_;
   bool is_reading_;
+  bool buffer_sizes_applied_;
 
-  scoped_refptr<net::IOBuffer> read_buffer_;
-  scoped_refptr<net::IOBuffer> write_buffer_;
-  scoped_ptr<net::UDPSocket> socket_;
+  // Socket buffer sizes requested by the application, 0 keeps the system
+  // defaults.
+  int receive_buffer_size_;
+  int send_buffer_size_;
 
-  unsigned write_buffer_size_;
+  // Maximum number of datagrams delivered by a single "message" event.
+  // Datagrams already queued by the system are read in a row and sent to
+  // JavaScript together, which saves one IPC message per datagram.
+  size_t receive_batch_size_;
+  scoped_ptr<base::ListValue> received_datagrams_;
+
+  std::deque<Datagram> write_queue_;
+  scoped_ptr<net::UDPSocket> socket_;
 
   scoped_ptr<net::HostResolver> resolver_;
   scoped_ptr<net::SingleRequestHostResolver> single_resolver_;
+  // |addresses_| are the result of resolving |resolved_destination_|, so
+  // that consecutive datagrams sent to the same host are resolved once.
   net::AddressList addresses_;
+  net::HostPortPair resolved_destination_;
+  net::HostPortPair resolving_destination_;
   net::IPEndPoint from_;
+
+  base::WeakPtrFactory<UDPSocketObject> weak_factory_;
 };
 
 }  // namespace sysapps
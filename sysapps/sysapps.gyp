@@ -32,6 +32,7 @@
         'common/sysapps_manager_linux.cc',
         'common/sysapps_manager_mac.cc',
         'common/sysapps_manager_win.cc',
+        'device_capabilities/av_codecs_provider.cc',
         'device_capabilities/av_codecs_provider.h',
         'device_capabilities/av_codecs_provider_android.cc',
         'device_capabilities/av_codecs_provider_android.h',
@@ -50,10 +51,14 @@
         'device_capabilities/display_info_provider.h',
         'device_capabilities/memory_info_provider.cc',
         'device_capabilities/memory_info_provider.h',
+        'device_capabilities/storage_capacity_monitor.cc',
+        'device_capabilities/storage_capacity_monitor.h',
         'device_capabilities/storage_info_provider.cc',
         'device_capabilities/storage_info_provider.h',
         'device_capabilities/storage_info_provider_android.cc',
         'device_capabilities/storage_info_provider_android.h',
+        'device_capabilities/system_sampler.cc',
+        'device_capabilities/system_sampler.h',
         'raw_socket/raw_socket.idl',
         'raw_socket/raw_socket_extension.cc',
         'raw_socket/raw_socket_extension.h',
@@ -19,7 +19,9 @@
         'device_capabilities/cpu_info_provider_unittest.cc',
         'device_capabilities/display_info_provider_unittest.cc',
         'device_capabilities/memory_info_provider_unittest.cc',
+        'device_capabilities/storage_capacity_monitor_unittest.cc',
         'device_capabilities/storage_info_provider_unittest.cc',
+        'device_capabilities/system_sampler_unittest.cc',
       ],
       'conditions': [
         ['OS=="linux"', {
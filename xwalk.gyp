@@ -144,10 +144,14 @@
         'runtime/browser/devtools/remote_debugging_server.h',
         'runtime/browser/devtools/xwalk_devtools_delegate.cc',
         'runtime/browser/devtools/xwalk_devtools_delegate.h',
+        'runtime/browser/directory_enumerator.cc',
+        'runtime/browser/directory_enumerator.h',
         'runtime/browser/geolocation/tizen/location_provider_tizen.cc',
         'runtime/browser/geolocation/tizen/location_provider_tizen.h',
         'runtime/browser/geolocation/xwalk_access_token_store.cc',
         'runtime/browser/geolocation/xwalk_access_token_store.h',
+        'runtime/browser/icon_loader.cc',
+        'runtime/browser/icon_loader.h',
         'runtime/browser/image_util.cc',
         'runtime/browser/image_util.h',
         'runtime/browser/media/media_capture_devices_dispatcher.cc',
@@ -166,6 +170,10 @@
         'runtime/browser/runtime_javascript_dialog_manager.h',
         'runtime/browser/runtime_network_delegate.cc',
         'runtime/browser/runtime_network_delegate.h',
+        'runtime/browser/runtime_network_stats.cc',
+        'runtime/browser/runtime_network_stats.h',
+        'runtime/browser/runtime_request_scheduler.cc',
+        'runtime/browser/runtime_request_scheduler.h',
         'runtime/browser/runtime_platform_util.h',
         'runtime/browser/runtime_platform_util_android.cc',
         'runtime/browser/runtime_platform_util_aura.cc',